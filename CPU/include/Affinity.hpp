@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+
+// ANY matches every core, so a machine without hybrid cores reports all of its cores as PERFORMANCE
+enum class CoreType : std::uint8_t
+{
+    ANY,
+    PERFORMANCE,
+    EFFICIENT,
+};
+
+inline constexpr std::size_t CORE_TYPE_COUNT{3};
+
+struct ArenaOptions
+{
+    int maxConcurrency{0};
+    int numaNode{-1};
+    CoreType coreType{CoreType::ANY};
+    bool isPinned{false};
+
+    [[nodiscard]] auto IsConstrained() const -> bool;
+};
+
+
+auto ParseCoreType(std::string_view name) -> CoreType;
+
+auto GetCoreTypeName(CoreType coreType) -> std::string_view;
+
+auto ParseCpuList(std::string_view list) -> std::vector<int>;
+
+// CPUs the process may run on that also match the NUMA node and core type of the options, in ascending order
+auto GetArenaCpus(ArenaOptions const & options) -> std::vector<int>;
+
+auto GetCoreType(int cpu) -> CoreType;
+
+auto GetCurrentCoreType() -> CoreType;
+
+auto IsHybrid() -> bool;
+
+auto GetArenaOptions(int argc, char const * const argv[]) -> ArenaOptions;
+
+
+// Restricts every thread that enters the arena to the given CPUs, or pins it to a single one of them, and restores its previous affinity on exit
+class ArenaPinning final : public oneapi::tbb::task_scheduler_observer
+{
+public:
+    ArenaPinning(oneapi::tbb::task_arena & arena, std::vector<int> cpus, bool isPinned);
+
+    ~ArenaPinning() override;
+
+    ArenaPinning(ArenaPinning const &) = delete;
+
+    auto operator=(ArenaPinning const &) -> ArenaPinning & = delete;
+
+    auto on_scheduler_entry(bool isWorker) -> void override;
+
+    auto on_scheduler_exit(bool isWorker) -> void override;
+
+private:
+    std::vector<int> const cpus;
+    bool const isPinned;
+};
+
+
+// Gives the arena as many threads as the options and their CPUs allow, and pins it to those CPUs when the options constrain them
+auto InitializeArena(oneapi::tbb::task_arena & arena, ArenaOptions const & options, std::optional<ArenaPinning> & pinning) -> void;
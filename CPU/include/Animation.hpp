@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+#include "BufferPool.hpp"
+#include "FractalFactory.hpp"
+#include "Utils.hpp"
+
+
+struct Keyframe
+{
+    std::size_t frame;
+    Point center;
+    float width;
+    std::size_t maxIterations;
+    Point juliaPoint;
+};
+
+enum class StreamFormat : std::uint8_t
+{
+    Y4M,
+    RGB,
+};
+
+
+auto ParseStreamFormat(std::string_view name) -> StreamFormat;
+
+auto LoadKeyframes(std::filesystem::path const & path) -> std::vector<Keyframe>;
+
+
+class Animation
+{
+public:
+    Animation(FractalType type, Size const & frameSize, std::vector<Keyframe> keyframes);
+
+    auto Stream(std::FILE * output, StreamFormat format, std::size_t framesPerSecond) const -> void;
+
+    [[nodiscard]] auto GetFrameCount() const -> std::size_t;
+
+    [[nodiscard]] auto Interpolate(std::size_t frame) const -> Keyframe;
+
+    static constexpr std::size_t MAX_FRAMES_IN_FLIGHT{3};
+
+private:
+    // The frame buffers come from the pool, so a long stream only ever maps the buffers of the frames in flight
+    struct Frame
+    {
+        std::size_t index;
+        PooledBuffer indices{};
+        PooledBuffer pixels{};
+        std::chrono::steady_clock::time_point queued{std::chrono::steady_clock::now()};
+    };
+
+    using FramePointer = std::shared_ptr<Frame>;
+
+    auto RenderFrame(Frame & frame) const -> void;
+
+    auto ColorizeFrame(Frame & frame, StreamFormat format) const -> void;
+
+    FractalType const type;
+    Size const frameSize;
+    Size const grainSize;
+
+    std::vector<Keyframe> const keyframes;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+struct Statistics
+{
+    double median;
+    double mean;
+    double standardDeviation;
+    double medianAbsoluteDeviation;
+    double minimum;
+    double maximum;
+    std::size_t repetitions;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> parameters;
+    Statistics milliseconds;
+    std::uint64_t iterations;
+    std::uint64_t pixels;
+    std::vector<std::pair<std::string, double>> metrics{};
+};
+
+
+auto Summarize(std::vector<double> samples) -> Statistics;
+
+auto Measure(std::function<void()> const & function, std::size_t warmups, std::size_t repetitions) -> Statistics;
+
+auto GetIterationsPerSecond(BenchmarkResult const & result) -> double;
+
+auto GetPixelsPerSecond(BenchmarkResult const & result) -> double;
+
+auto WriteBenchmarkJSON(std::vector<BenchmarkResult> const & results, std::filesystem::path const & path) -> void;
+
+auto LoadBenchmarkMedians(std::filesystem::path const & path) -> std::map<std::string, double>;
+
+auto CompareWithBaseline(std::vector<BenchmarkResult> const & results, std::map<std::string, double> const & baseline, double thresholdPercent) -> bool;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "PageBuffer.hpp"
+
+
+struct PoolStatistics
+{
+    std::size_t residentBytes;
+    std::size_t peakResidentBytes;
+    std::size_t inUseBytes;
+    std::size_t peakInUseBytes;
+    std::uint64_t hits;
+    std::uint64_t misses;
+};
+
+class BufferPool;
+
+
+// Lease on a buffer of a pool, which takes the memory back when the lease is destroyed
+class PooledBuffer
+{
+public:
+    PooledBuffer() = default;
+
+    ~PooledBuffer();
+
+    PooledBuffer(PooledBuffer && other) noexcept;
+
+    auto operator=(PooledBuffer && other) noexcept -> PooledBuffer &;
+
+    [[nodiscard]] auto GetData() const -> std::uint8_t *;
+
+    [[nodiscard]] auto GetSize() const -> std::size_t;
+
+    [[nodiscard]] auto IsEmpty() const -> bool;
+
+    // Recycled memory was already written to, so its pages are resident and need no first touch
+    [[nodiscard]] auto IsRecycled() const -> bool;
+
+private:
+    friend class BufferPool;
+
+    PooledBuffer(BufferPool * pool, PageBuffer buffer, std::size_t size, bool isRecycled);
+
+    auto Release() -> void;
+
+    BufferPool * pool{nullptr};
+    PageBuffer buffer;
+    std::size_t size{0};
+    bool isRecycled{false};
+};
+
+
+// Keeps released buffers by size class and huge page mode, so that repeated renders of the same size neither map nor fault in new memory
+class BufferPool
+{
+public:
+    explicit BufferPool(std::size_t maxIdleBytes = DEFAULT_MAX_IDLE_BYTES);
+
+    BufferPool(BufferPool const &) = delete;
+
+    auto operator=(BufferPool const &) -> BufferPool & = delete;
+
+    [[nodiscard]] auto Acquire(std::size_t size, HugePages hugePages = HugePages::NONE) -> PooledBuffer;
+
+    // Unmaps every idle buffer
+    auto Trim() -> void;
+
+    [[nodiscard]] auto GetStatistics() const -> PoolStatistics;
+
+    [[nodiscard]] static auto GetSizeClass(std::size_t size) -> std::size_t;
+
+    // Never destroyed, so that leases held by static objects can still be returned at exit
+    [[nodiscard]] static auto GetDefault() -> BufferPool &;
+
+    static constexpr std::size_t DEFAULT_MAX_IDLE_BYTES{1UZ << 30U};
+
+private:
+    friend class PooledBuffer;
+
+    auto Return(PageBuffer buffer) -> void;
+
+    std::size_t const maxIdleBytes;
+
+    mutable std::mutex mutex;
+    std::map<std::pair<std::size_t, HugePages>, std::vector<PageBuffer>> idle;
+    std::size_t idleBytes{0};
+    PoolStatistics statistics{};
+};
+
+
+auto PrintPoolStatistics(PoolStatistics const & statistics, std::FILE * stream) -> void;
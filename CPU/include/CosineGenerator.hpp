@@ -8,13 +8,17 @@
 class CosineGenerator final : public FractalGenerator
 {
 public:
-    CosineGenerator(Size const & imageSize, Size const & grainSize, std::size_t maxIterations);
+    CosineGenerator(Size const & imageSize, Size const & grainSize, std::size_t maxIterations, PixelLayout layout = PixelLayout::RGB);
 
-private:
-    [[nodiscard]] auto Generate(Point const & startPoint) const -> std::uint8_t override;
+    CosineGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t maxIterations, PixelLayout layout = PixelLayout::RGB);
 
     static constexpr Point TOP_LEFT{-2.0, 2.0};
     static constexpr Point BOTTOM_RIGHT{5.0, -2.0};
 
+    [[nodiscard]] auto GetName() const -> std::string_view override;
+
+private:
+    [[nodiscard]] auto Iterate(Point const & startPoint) const -> std::size_t override;
+
     static constexpr float RADIUS{10.0 * std::numbers::pi};
 };
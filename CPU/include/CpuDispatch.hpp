@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+// Ordered from the oldest to the newest, so that a build can fall back to anything below what the processor supports
+enum class InstructionSet : std::uint8_t
+{
+    BASELINE,
+    SSE42,
+    AVX2,
+    AVX512,
+};
+
+
+auto DetectInstructionSet() -> InstructionSet;
+
+auto GetActiveInstructionSet() -> InstructionSet;
+
+auto SetInstructionSet(InstructionSet instructionSet) -> void;
+
+// Single-precision lanes in a vector register of the instruction set, the baseline counting the 128-bit registers every 64-bit target has
+auto GetLaneWidth(InstructionSet instructionSet) -> std::size_t;
+
+auto ParseInstructionSet(std::string_view name) -> InstructionSet;
+
+auto GetInstructionSetName(InstructionSet instructionSet) -> std::string_view;
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+#include "Affinity.hpp"
+#include "FractalFactory.hpp"
+#include "SocketListener.hpp"
+#include "TileStream.hpp"
+#include "Utils.hpp"
+
+
+inline constexpr std::uint32_t TILE_PROTOCOL_MAGIC{0x32544946}; // "FIT2" in little endian
+
+// Every message starts with the magic, and the fields go out in host order, so coordinator and workers must share the byte order.
+// A job is complete on its own, so that any worker can render any tile and a lost one can simply be sent elsewhere.
+struct TileJobMessage
+{
+    std::uint32_t magic;
+    std::uint32_t tile;
+    std::uint32_t type;
+    std::uint32_t layout;
+    std::uint32_t x;
+    std::uint32_t y;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t frameWidth;
+    std::uint32_t frameHeight;
+    std::uint32_t maxIterations;
+    // The viewport of the whole frame, which the worker maps the tile pixels through like a single render would
+    float left;
+    float top;
+    float right;
+    float bottom;
+    float juliaReal;
+    float juliaImaginary;
+};
+
+// Followed by byteCount bytes of tightly packed pixel rows, or of the error message when the status is not zero
+struct TileResultMessage
+{
+    std::uint32_t magic;
+    std::uint32_t tile;
+    std::uint32_t status;
+    std::uint32_t byteCount;
+    std::uint64_t iterations;
+};
+
+static_assert(sizeof(TileJobMessage) == 68U && sizeof(TileResultMessage) == 24U);
+
+
+// Without a bind address the worker only listens on the loopback interface
+struct WorkerOptions
+{
+    std::string address{"127.0.0.1"};
+    int port{0};
+    ArenaOptions arenaOptions{};
+};
+
+struct DistributedJob
+{
+    FractalType type{FractalType::MANDELBROT};
+    Size imageSize{1024, 768};
+    Viewport viewport{};
+    std::size_t maxIterations{256};
+    PixelLayout layout{PixelLayout::RGB};
+    Point juliaPoint{JuliaGenerator::C_POINT};
+    Size tileSize{256, 256};
+};
+
+struct WorkerStatistics
+{
+    std::string address;
+    std::size_t tiles;
+    std::size_t discarded;
+    bool isLost;
+};
+
+struct DistributedStatistics
+{
+    std::vector<WorkerStatistics> workers;
+    std::size_t retries;
+    std::size_t steals;
+    std::uint64_t iterations;
+};
+
+
+auto GetWorkerOptions(int argc, char const * const argv[]) -> WorkerOptions;
+
+
+// Serves every coordinator connection on a thread of its own and answers its jobs in order. All connections render in one shared arena.
+class RenderWorker
+{
+public:
+    explicit RenderWorker(WorkerOptions options);
+
+    RenderWorker(RenderWorker const &) = delete;
+
+    auto operator=(RenderWorker const &) -> RenderWorker & = delete;
+
+    // Blocks until Stop is called
+    auto Run() -> void;
+
+    // May be called from a signal handler
+    auto Stop() -> void;
+
+    [[nodiscard]] auto GetAddress() const -> std::string;
+
+    [[nodiscard]] auto GetConcurrency() const -> int;
+
+private:
+    auto Serve(int connection) -> void;
+
+    auto RenderJob(TileJobMessage const & job, std::vector<std::uint8_t> & pixels) -> std::uint64_t;
+
+    WorkerOptions const options;
+
+    oneapi::tbb::task_arena arena;
+    std::optional<ArenaPinning> arenaPinning;
+
+    SocketListener listener;
+
+    std::mutex connectionsMutex;
+    std::condition_variable connectionsClosed;
+    std::vector<int> connections;
+};
+
+
+// Splits a render into tiles and hands them to the workers, each connection keeping a couple of jobs in flight so that a worker never waits on the network.
+// Fast workers simply come back for more, and once nothing is left to hand out an idle worker steals the oldest tile still in flight elsewhere and the first result wins,
+// so a slow worker does not hold up the end of the render. The tiles of a worker that fails or stops answering go back to the queue for the others.
+class RenderCoordinator
+{
+public:
+    // Workers are given as host:port, and every tile has to arrive within a timeout of at least one second
+    explicit RenderCoordinator(std::vector<std::string> workers, std::chrono::milliseconds tileTimeout = DEFAULT_TILE_TIMEOUT);
+
+    // Calls the sink once per tile as the results arrive, one call at a time, with the view valid for the duration of the call
+    auto Render(DistributedJob const & job, std::function<void(CompletedTile const &)> const & sink) -> DistributedStatistics;
+
+    [[nodiscard]] auto GetWorkerCount() const -> std::size_t;
+
+    static constexpr std::chrono::milliseconds DEFAULT_TILE_TIMEOUT{60000};
+
+private:
+    std::vector<std::string> const workers;
+    std::chrono::milliseconds const tileTimeout;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+
+enum class ExecutorType : std::uint8_t
+{
+    TBB,
+    OPENMP_DYNAMIC,
+    OPENMP_GUIDED,
+    STD_PARALLEL,
+    THREAD_POOL,
+};
+
+// Receives a half-open range of loop indices
+using ChunkFunction = std::function<void(std::size_t begin, std::size_t end)>;
+
+
+// Runs a flat parallel loop in chunks of at most grainSize indices and returns once every chunk has finished
+class Executor
+{
+public:
+    virtual ~Executor() = default;
+
+    virtual auto ParallelFor(std::size_t count, std::size_t grainSize, ChunkFunction const & function) -> void = 0;
+
+    [[nodiscard]] virtual auto GetType() const -> ExecutorType = 0;
+
+    [[nodiscard]] virtual auto GetConcurrency() const -> int = 0;
+
+    // Small index of the calling worker, as used in the tile profiles
+    [[nodiscard]] virtual auto GetThreadIndex() const -> int = 0;
+};
+
+
+auto ParseExecutorType(std::string_view name) -> ExecutorType;
+
+auto GetExecutorName(ExecutorType type) -> std::string_view;
+
+auto IsExecutorAvailable(ExecutorType type) -> bool;
+
+// A thread count of zero uses every hardware thread
+auto MakeExecutor(ExecutorType type, int threads = 0) -> std::unique_ptr<Executor>;
@@ -0,0 +1,105 @@
+#ifndef FRACTAL_API_H
+#define FRACTAL_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// FRACTAL_BUILDING is only defined while the library itself is compiled, so that programs using it import the functions instead
+#if defined(_WIN32) && defined(FRACTAL_BUILDING)
+#define FRACTAL_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define FRACTAL_API __declspec(dllimport)
+#else
+#define FRACTAL_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define FRACTAL_API_VERSION 1
+
+typedef struct fractal_generator fractal_generator;
+
+typedef enum fractal_type
+{
+    FRACTAL_MANDELBROT = 0,
+    FRACTAL_JULIA = 1,
+    FRACTAL_COSINE = 2,
+    FRACTAL_TRICORN = 3,
+} fractal_type;
+
+typedef enum fractal_layout
+{
+    FRACTAL_LAYOUT_RGB = 0,
+    FRACTAL_LAYOUT_BGR = 1,
+    FRACTAL_LAYOUT_RGBA = 2,
+    FRACTAL_LAYOUT_BGRA = 3,
+    FRACTAL_LAYOUT_INDEXED = 4,
+} fractal_layout;
+
+typedef enum fractal_status
+{
+    FRACTAL_OK = 0,
+    FRACTAL_INVALID_ARGUMENT = 1,
+    FRACTAL_CANCELLED = 2,
+    FRACTAL_OUT_OF_MEMORY = 3,
+    FRACTAL_ERROR = 4,
+    // The generator is still busy with a render started on another thread
+    FRACTAL_BUSY = 5,
+} fractal_status;
+
+// Fill with fractal_default_params, which sets size to the version the caller was built against, so that later versions can append fields
+typedef struct fractal_params
+{
+    uint32_t size;
+    fractal_type type;
+    uint32_t width;
+    uint32_t height;
+    uint32_t max_iterations;
+    fractal_layout layout;
+    double left;
+    double top;
+    double right;
+    double bottom;
+    double julia_real;
+    double julia_imaginary;
+    // Zero uses every hardware thread
+    uint32_t threads;
+} fractal_params;
+
+
+FRACTAL_API uint32_t fractal_api_version(void);
+
+// Fills in the default viewport of the fractal, a 1024×768 RGB image and 256 iterations, or returns FRACTAL_INVALID_ARGUMENT and leaves params untouched
+FRACTAL_API fractal_status fractal_default_params(fractal_type type, fractal_params * params);
+
+FRACTAL_API fractal_status fractal_create(fractal_params const * params, fractal_generator ** generator);
+
+FRACTAL_API void fractal_destroy(fractal_generator * generator);
+
+// Blocks until the image is in the buffer, whose rows start stride bytes apart. A generator renders one image at a time. Returns FRACTAL_CANCELLED when fractal_cancel stopped it,
+// in which case the tiles it did not get to are cleared, and FRACTAL_BUSY without touching the buffer while another thread renders with the same generator.
+FRACTAL_API fractal_status fractal_render(fractal_generator * generator, uint8_t * buffer, size_t stride);
+
+// May be called from any thread while fractal_render runs, between 0 and 1
+FRACTAL_API double fractal_get_progress(fractal_generator const * generator);
+
+// May be called from any thread while fractal_render runs and stops that render. A cancel while no render runs is ignored.
+FRACTAL_API void fractal_cancel(fractal_generator * generator);
+
+// The 256 RGB colors that indexed images refer to
+FRACTAL_API void fractal_default_palette(uint8_t rgb[768]);
+
+FRACTAL_API size_t fractal_bytes_per_pixel(fractal_layout layout);
+
+// Message of the last call on the calling thread that did not return FRACTAL_OK
+FRACTAL_API char const * fractal_last_error(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "FractalGenerator.hpp"
+
+
+// Applies the RENDER_OPTIONS of the fractal executables to a generator built from their positional arguments. Anything left unset is taken from the tuning cache
+// on the first render.
+auto ConfigureFromArguments(FractalGenerator & generator, int argc, char const * const argv[]) -> void;
+
+// Times one render, with the hardware counters around it when asked for, then saves the image and writes the tile profile
+auto RenderFromArguments(FractalGenerator & generator, int argc, char const * const argv[]) -> void;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "FractalGenerator.hpp"
+#include "JuliaGenerator.hpp"
+#include "Utils.hpp"
+
+
+enum class FractalType : std::uint8_t
+{
+    MANDELBROT,
+    JULIA,
+    COSINE,
+    TRICORN,
+};
+
+
+auto ParseFractalType(std::string_view name) -> FractalType;
+
+auto GetFractalName(FractalType type) -> std::string_view;
+
+auto GetDefaultViewport(FractalType type) -> Viewport;
+
+auto MakeFractalGenerator(FractalType type, Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t maxIterations,
+    PixelLayout layout = PixelLayout::RGB, Point const & juliaPoint = JuliaGenerator::C_POINT) -> std::unique_ptr<FractalGenerator>;
@@ -1,45 +1,278 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <vector>
 
 #include <oneapi/tbb.h>
 
+#include "Affinity.hpp"
+#include "BufferPool.hpp"
+#include "Executor.hpp"
+#include "ImageWriter.hpp"
+#include "PageBuffer.hpp"
+#include "Palette.hpp"
+#include "Partitioning.hpp"
+#include "TileProfile.hpp"
+#include "TileStream.hpp"
+#include "Tuning.hpp"
 #include "Utils.hpp"
 
 
+// One flag per 64×64 cell of the image, row by row, set when the last render wrote every pixel of the cell
+struct TileMask
+{
+    Size cellSize;
+    Size cells;
+    std::vector<std::uint8_t> completed;
+};
+
+
 class FractalGenerator
 {
 public:
-    FractalGenerator(Size const & imageSize, Size const & grainSize, Point const & topLeft, Point const & bottomRight, std::size_t maxIterations);
+    FractalGenerator(Size const & imageSize, Size const & grainSize, Point const & topLeft, Point const & bottomRight, std::size_t maxIterations,
+        PixelLayout layout = PixelLayout::RGB);
 
     virtual ~FractalGenerator() = default;
 
     auto Render() -> void;
 
+    // Renders on a thread of its own, in the given arena or else the one Render would use, and publishes every 64×64 cell to the stream as soon as its last pixel is done,
+    // so that encoders or senders can start on the first cells while the others are still computing. The generator must not be touched until the future is ready.
+    auto RenderAsync(oneapi::tbb::task_arena * arena = nullptr) -> AsyncRender;
+
+    // The arena of its own that Render enters, or null when it renders in the caller's arena. The cached tuning is applied first, since a tuned thread count
+    // brings an arena along.
+    [[nodiscard]] auto GetRenderArena() -> oneapi::tbb::task_arena *;
+
+    // May be called from any thread, the render in progress skips the tiles it has not started yet and leaves the image incomplete. A cancel while no render is
+    // in flight is dropped, and a render started with RenderAsync is in flight as soon as the call returns.
+    auto Cancel() -> void;
+
+    // Whether the render in progress, or the last one, was cancelled
+    [[nodiscard]] auto IsCancelled() const -> bool;
+
+    // Share of the pixels of the render in progress, or of the last one, that are done
+    [[nodiscard]] auto GetProgress() const -> double;
+
+    // Zero renders without a limit. A render that spends its budget starts no more tiles and keeps the partial image, whose missing cells are filled from one sample per 8×8 block
+    // with coarse fill
+    auto SetTimeBudget(std::chrono::milliseconds budget, bool coarseFill = false) -> void;
+
+    // Whether the last render ran out of its time budget, which still leaves it saveable unlike a cancelled one
+    [[nodiscard]] auto IsExpired() const -> bool;
+
+    [[nodiscard]] auto GetCompletedTiles() const -> TileMask;
+
     auto Save(std::string_view const & filename) -> void;
 
+    auto SetPalette(Palette const & newPalette) -> void;
+
+    auto SetStride(std::size_t newStride) -> void;
+
+    auto UseBuffer(std::uint8_t * buffer, std::size_t bufferStride) -> void;
+
+    auto SetMemoryLayout(MemoryLayout newMemoryLayout) -> void;
+
+    // Renders the image as the part at origin of a frame of frameSize pixels over the viewport, so that tiles rendered apart match the whole frame pixel for pixel
+    auto SetFrame(Size const & newFrameSize, Pixel const & newOrigin) -> void;
+
+    auto Detile() -> void;
+
+    [[nodiscard]] auto GetView() const -> ImageView;
+
+    [[nodiscard]] auto GetImageSize() const -> Size const &;
+
+    [[nodiscard]] auto GetPixelLayout() const -> PixelLayout;
+
+    [[nodiscard]] auto CountIterations() const -> std::uint64_t;
+
+    // Summed from the tiles of the last render, unlike CountIterations which iterates every pixel again
+    [[nodiscard]] auto GetRenderedIterations() const -> std::uint64_t;
+
+    // Iterates a batch of points in groups of the SIMD width like a render does, so that the kernels can be timed without the tiles and pixels around them
+    auto IteratePoints(std::span<Point const> startPoints, std::span<std::size_t> iterations) const -> void;
+
+    auto SetPartitioning(Partitioning newPartitioning, std::size_t newProbeStep = DEFAULT_PROBE_STEP) -> void;
+
+    auto SetGrainSize(Size const & newGrainSize) -> void;
+
+    // One iterates every pixel on its own and opts out of the lane kernels
+    auto SetSimdWidth(std::size_t newSimdWidth) -> void;
+
+    // The width set or tuned, or else the lane width of the active instruction set for generators with a lane kernel
+    [[nodiscard]] auto GetSimdWidth() const -> std::size_t;
+
+    [[nodiscard]] virtual auto HasLaneKernel() const -> bool;
+
+    auto SetThreads(int threads) -> void;
+
+    auto SetExecutor(ExecutorType type) -> void;
+
+    auto SetBufferPool(BufferPool & pool) -> void;
+
+    auto SetAllocation(Allocation newAllocation, HugePages newHugePages = HugePages::NONE) -> void;
+
+    auto SetArenaOptions(ArenaOptions const & options) -> void;
+
+    auto SetCoreWeight(CoreType coreType, double weight) -> void;
+
+    auto ApplyTuning(TuningConfig const & config) -> void;
+
+    [[nodiscard]] auto GetTuningKey() const -> TuningKey;
+
+    [[nodiscard]] virtual auto GetName() const -> std::string_view = 0;
+
+    auto EnableProfiling(bool enabled) -> void;
+
+    [[nodiscard]] auto GetTileRecords() const -> std::vector<TileRecord>;
+
 protected:
-    virtual auto Generate(Point const & startPoint) const -> std::uint8_t = 0;
+    virtual auto Iterate(Point const & startPoint) const -> std::size_t = 0;
+
+    virtual auto IterateLanes(std::span<Point const> startPoints, std::span<std::size_t> iterations) const -> void;
+
+    auto RenderInArena() -> void;
+
+    template <typename Visitor>
+    auto ForEachTile(Visitor const & visitor) -> void;
+
+    template <typename Partitioner, typename Visitor>
+    auto ForEachRange(Partitioner && partitioner, Visitor const & visitor) -> void;
+
+    template <typename Visitor>
+    auto ForEachTileWithExecutor(Visitor const & visitor) -> void;
+
+    template <typename Visitor>
+    auto ForEachWeightedBand(std::atomic<std::size_t> & nextRow, Visitor const & visitor) -> void;
+
+    auto RenderTile(Tile const & range) -> std::uint64_t;
+
+    auto TouchTile(Tile const & tile) const -> void;
+
+    auto AllocateImage() -> void;
+
+    auto ResetArena() -> void;
+
+    auto BeginRender() -> void;
+
+    auto FinishRender() -> void;
+
+    auto EndRender() -> void;
+
+    auto ApplyCachedTuning() -> void;
+
+    auto ProcessTile(Tile const & tile) -> void;
+
+    auto IsStopping() -> bool;
+
+    auto MarkCompleted(Tile const & tile) -> void;
+
+    auto FillCoarse() -> void;
+
+    auto ClearUnfinished() -> void;
+
+    [[nodiscard]] auto GetCell(std::size_t cell) const -> Tile;
+
+    [[nodiscard]] auto GetCellView(Tile const & cell) const -> ImageView;
+
+    auto Probe() -> void;
+
+    auto GetScheduledTiles() -> std::vector<Tile> const &;
+
+    [[gnu::always_inline]] inline auto GetRowPointer(std::size_t row, std::size_t col) const -> std::uint8_t *;
+
+    [[gnu::always_inline]] inline auto GetColorIndex(std::size_t iterations) const -> std::uint8_t;
 
     [[gnu::always_inline]] inline auto PixelToPoint(Pixel const & pixel) const -> Point;
 
-    [[gnu::always_inline]] inline static auto Colorize(std::uint8_t & red, std::uint8_t & green, std::uint8_t & blue, std::size_t value) -> void;
+    [[gnu::always_inline]] inline auto Colorize(std::uint8_t * pixel, std::uint8_t value) const -> void;
+
+    [[gnu::always_inline]] inline auto StorePixel(std::uint8_t * pixel, std::size_t iterations) const -> void;
 
     bool isRendered{false};
+    std::atomic<std::uint64_t> renderedIterations{0};
+    std::atomic<std::size_t> renderedPixels{0};
+    std::atomic<bool> isCancelled{false};
+    std::atomic<bool> isExpired{false};
+    // Guards isRendering, which Cancel checks, the stream, which is closed before the flag drops, and the context, which is only reset between renders and never
+    // while Cancel cancels it
+    std::mutex renderMutex;
+    bool isRendering{false};
+    oneapi::tbb::task_group_context renderContext;
+
+    std::chrono::milliseconds timeBudget{0};
+    bool isCoarseFilled{false};
+    std::chrono::steady_clock::time_point deadline;
 
     Size const imageSize;
-    Size const grainSize;
+    Size grainSize;
 
     Point const topLeft;
     Point const bottomRight;
+    float const viewportWidth;
+    float const viewportHeight;
+    Size frameSize;
+    Pixel origin{0, 0};
 
     std::size_t const maxIterations;
     float const logMaxIterations;
 
-    std::vector<std::uint8_t, oneapi::tbb::cache_aligned_allocator<std::uint8_t>> image;
+    PixelLayout const layout;
+    std::size_t const channels;
+    ChannelOrder const channelOrder;
+
+    std::size_t stride;
+    std::uint8_t * pixels{nullptr};
+
+    Palette palette{DEFAULT_PALETTE};
+
+    BufferPool * bufferPool{&BufferPool::GetDefault()};
+    PooledBuffer image;
+    Allocation allocation{Allocation::ZEROED};
+    HugePages hugePages{HugePages::NONE};
+
+    oneapi::tbb::affinity_partitioner affinityPartitioner;
+
+    MemoryLayout memoryLayout{MemoryLayout::ROW_MAJOR};
+    Size const storageTiles;
+    bool isDetiled{false};
+    PooledBuffer detiledImage;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> cellPixels;
+    std::shared_ptr<TileStream> tileStream;
+
+    Partitioning partitioning{Partitioning::AFFINITY};
+    std::size_t probeStep{DEFAULT_PROBE_STEP};
+    CostGrid costGrid{};
+
+    std::vector<Tile> scheduledTiles;
+    Partitioning scheduledPartitioning{Partitioning::AFFINITY};
+    std::size_t scheduledTileCount{0};
+
+    std::size_t simdWidth{0};
+    ArenaOptions arenaOptions{};
+    std::optional<oneapi::tbb::task_arena> renderArena;
+    std::optional<ArenaPinning> arenaPinning;
+    std::array<double, CORE_TYPE_COUNT> coreWeights{1.0, 1.0, DEFAULT_EFFICIENT_WEIGHT};
+    std::unique_ptr<Executor> executor{MakeExecutor(ExecutorType::TBB)};
+    bool isConfigured{false};
+    bool isTuningChecked{false};
+
+    bool isProfiling{false};
+    std::chrono::steady_clock::time_point renderStart;
+    oneapi::tbb::concurrent_vector<TileRecord> tileRecords;
 
-    static constexpr std::size_t CHANNELS{3};
     static constexpr std::size_t MAX_COLOR{255};
+    static constexpr std::size_t TILES_PER_THREAD{8};
+    static constexpr std::size_t STORAGE_TILE_SIZE{64};
+    static constexpr std::size_t COARSE_BLOCK_SIZE{8};
+    static constexpr double DEFAULT_EFFICIENT_WEIGHT{0.5};
 };
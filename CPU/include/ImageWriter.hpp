@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+#include "Palette.hpp"
+#include "Utils.hpp"
+
+
+enum class PixelLayout : std::uint8_t
+{
+    RGB,
+    BGR,
+    RGBA,
+    BGRA,
+    INDEXED,
+};
+
+// Formats that can be encoded straight into a stream, without going through a file name
+enum class ImageFormat : std::uint8_t
+{
+    PNG,
+    QOI,
+    BMP,
+    PPM,
+};
+
+struct ChannelOrder
+{
+    std::size_t red;
+    std::size_t green;
+    std::size_t blue;
+};
+
+struct ImageView
+{
+    std::uint8_t const * data;
+    Size size;
+    std::size_t stride;
+    PixelLayout layout;
+    Palette const * palette;
+};
+
+
+auto GetChannels(PixelLayout layout) -> std::size_t;
+
+auto GetChannelOrder(PixelLayout layout) -> ChannelOrder;
+
+auto ParsePixelLayout(std::string_view name) -> PixelLayout;
+
+auto GetPixelLayoutName(PixelLayout layout) -> std::string_view;
+
+auto ParseImageFormat(std::string_view name) -> ImageFormat;
+
+auto GetImageFormatName(ImageFormat format) -> std::string_view;
+
+auto GetMimeType(ImageFormat format) -> std::string_view;
+
+auto WriteImage(ImageView const & image, std::string_view filename) -> void;
+
+// Returns the number of bytes written
+auto WriteImage(ImageView const & image, ImageFormat format, std::FILE * file) -> std::size_t;
+
+auto WriteQOI(ImageView const & image, std::FILE * file) -> void;
+
+auto WriteBMP(ImageView const & image, std::FILE * file) -> void;
+
+auto WritePPM(ImageView const & image, std::FILE * file) -> void;
+
+auto WritePNG(ImageView const & image, std::FILE * file) -> void;
+
+auto RewritePalette(std::string_view filename, Palette const & palette) -> void;
@@ -6,15 +6,27 @@
 class JuliaGenerator final : public FractalGenerator
 {
 public:
-    JuliaGenerator(Size const & imageSize, Size const & grainSize, std::size_t maxIterations);
+    JuliaGenerator(Size const & imageSize, Size const & grainSize, std::size_t maxIterations, PixelLayout layout = PixelLayout::RGB);
 
-private:
-    [[nodiscard]] auto Generate(Point const & startPoint) const -> std::uint8_t override;
+    JuliaGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t maxIterations, PixelLayout layout = PixelLayout::RGB);
+
+    JuliaGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t maxIterations, Point const & cPoint, PixelLayout layout = PixelLayout::RGB);
 
     static constexpr Point TOP_LEFT{-1.6, 1.2};
     static constexpr Point BOTTOM_RIGHT{1.6, -1.2};
 
     static constexpr Point C_POINT{-0.7, 0.27015};
 
+    [[nodiscard]] auto GetName() const -> std::string_view override;
+
+    [[nodiscard]] auto HasLaneKernel() const -> bool override;
+
+private:
+    [[nodiscard]] auto Iterate(Point const & startPoint) const -> std::size_t override;
+
+    auto IterateLanes(std::span<Point const> startPoints, std::span<std::size_t> iterations) const -> void override;
+
+    Point const cPoint;
+
     static constexpr float RADIUS{2.0};
 };
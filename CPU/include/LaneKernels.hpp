@@ -0,0 +1,17 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "Utils.hpp"
+
+
+inline constexpr std::array<std::size_t, 4> SIMD_WIDTHS{1U, 4U, 8U, 16U};
+inline constexpr std::size_t MAX_SIMD_WIDTH{16};
+
+
+// Escape-time loop of z ← z² + c, or of z ← conj(z)² + c, for a batch of points. Julia sets start from the points and add juliaPoint,
+// the others start from zero and add the points. The kernel for the active instruction set is picked at runtime.
+auto IterateQuadraticLanes(std::span<Point const> startPoints, std::span<std::size_t> iterations, std::size_t maxIterations, float radius, bool conjugate,
+    Point const * juliaPoint = nullptr) -> void;
@@ -6,13 +6,21 @@
 class MandelbrotGenerator final : public FractalGenerator
 {
 public:
-    MandelbrotGenerator(Size const & imageSize, Size const & grainSize, std::size_t maxIterations);
+    MandelbrotGenerator(Size const & imageSize, Size const & grainSize, std::size_t maxIterations, PixelLayout layout = PixelLayout::RGB);
 
-private:
-    [[nodiscard]] auto Generate(Point const & startPoint) const -> std::uint8_t override;
+    MandelbrotGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t maxIterations, PixelLayout layout = PixelLayout::RGB);
 
     static constexpr Point TOP_LEFT{-2.0, 1.2};
     static constexpr Point BOTTOM_RIGHT{1.0, -1.2};
 
+    [[nodiscard]] auto GetName() const -> std::string_view override;
+
+    [[nodiscard]] auto HasLaneKernel() const -> bool override;
+
+private:
+    [[nodiscard]] auto Iterate(Point const & startPoint) const -> std::size_t override;
+
+    auto IterateLanes(std::span<Point const> startPoints, std::span<std::size_t> iterations) const -> void override;
+
     static constexpr float RADIUS{2.0};
 };
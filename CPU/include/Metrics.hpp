@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+
+enum class Stage : std::uint8_t
+{
+    QUEUE,
+    RENDER,
+    COLORIZE,
+    ENCODE,
+};
+
+inline constexpr std::size_t STAGE_COUNT{4};
+
+
+auto GetStageName(Stage stage) -> std::string_view;
+
+
+// Buckets a quarter octave wide from 10 µs up, so that recording is a few relaxed atomic adds and quantiles are interpolated to within about 10 %
+class LatencyHistogram
+{
+public:
+    auto Record(std::chrono::nanoseconds duration) -> void;
+
+    // In seconds, over everything recorded since the start
+    [[nodiscard]] auto GetQuantile(double quantile) const -> double;
+
+    [[nodiscard]] auto GetCount() const -> std::uint64_t;
+
+    [[nodiscard]] auto GetSeconds() const -> double;
+
+    [[nodiscard]] static auto GetUpperBound(std::size_t bucket) -> double;
+
+    static constexpr std::size_t BUCKET_COUNT{112};
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> nanoseconds{0};
+};
+
+
+class Metrics
+{
+public:
+    // Records the lifetime of the scope as a stage and counts it as active meanwhile
+    class StageTimer
+    {
+    public:
+        StageTimer(Metrics & metrics, Stage stage);
+
+        ~StageTimer();
+
+        StageTimer(StageTimer const &) = delete;
+
+        auto operator=(StageTimer const &) -> StageTimer & = delete;
+
+    private:
+        Metrics & metrics;
+        Stage const stage;
+        std::chrono::steady_clock::time_point const start;
+    };
+
+    auto RecordStage(Stage stage, std::chrono::nanoseconds duration) -> void;
+
+    auto AddIterations(std::uint64_t count) -> void;
+
+    auto AddBytesWritten(std::uint64_t count) -> void;
+
+    auto AddRequest(bool isFailed) -> void;
+
+    [[nodiscard]] auto GetHistogram(Stage stage) const -> LatencyHistogram const &;
+
+    // Prometheus text exposition format, including the statistics of the default buffer pool
+    auto WritePrometheus(std::FILE * stream) const -> void;
+
+    [[nodiscard]] static auto GetDefault() -> Metrics &;
+
+private:
+    std::array<LatencyHistogram, STAGE_COUNT> histograms;
+    std::array<std::atomic<std::int64_t>, STAGE_COUNT> active{};
+    std::atomic<std::uint64_t> iterations{0};
+    std::atomic<std::uint64_t> bytesWritten{0};
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> failedRequests{0};
+};
+
+
+// Rewrites a file with the metrics every interval and once more on destruction, through a rename so that readers never see a partial dump
+class MetricsDump
+{
+public:
+    MetricsDump(Metrics const & metrics, std::filesystem::path path, std::chrono::milliseconds interval);
+
+    ~MetricsDump();
+
+    MetricsDump(MetricsDump const &) = delete;
+
+    auto operator=(MetricsDump const &) -> MetricsDump & = delete;
+
+private:
+    auto Write() const -> void;
+
+    Metrics const & metrics;
+    std::filesystem::path const path;
+    std::chrono::milliseconds const interval;
+
+    std::mutex mutex;
+    std::condition_variable_any wakeUp;
+    std::jthread thread;
+};
+
+
+// Null unless --metrics-file is given, the interval comes from --metrics-interval in seconds
+auto StartMetricsDump(int argc, char const * const argv[]) -> std::unique_ptr<MetricsDump>;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+
+enum class HugePages : std::uint8_t
+{
+    NONE,
+    TRANSPARENT,
+    EXPLICIT,
+};
+
+// ZEROED fills the buffer on the allocating thread, FIRST_TOUCH leaves every page untouched so that the render threads place them
+enum class Allocation : std::uint8_t
+{
+    ZEROED,
+    FIRST_TOUCH,
+};
+
+
+auto ParseHugePages(std::string_view name) -> HugePages;
+
+auto GetHugePagesName(HugePages hugePages) -> std::string_view;
+
+auto ParseAllocation(std::string_view name) -> Allocation;
+
+auto GetAllocationName(Allocation allocation) -> std::string_view;
+
+auto GetPageSize(HugePages hugePages) -> std::size_t;
+
+
+// Uninitialised memory mapped directly from the operating system, optionally backed by huge pages
+class PageBuffer
+{
+public:
+    PageBuffer() = default;
+
+    PageBuffer(std::size_t size, HugePages hugePages);
+
+    ~PageBuffer();
+
+    PageBuffer(PageBuffer && other) noexcept;
+
+    auto operator=(PageBuffer && other) noexcept -> PageBuffer &;
+
+    [[nodiscard]] auto GetData() const -> std::uint8_t *;
+
+    [[nodiscard]] auto GetSize() const -> std::size_t;
+
+    [[nodiscard]] auto GetHugePages() const -> HugePages;
+
+    [[nodiscard]] auto IsEmpty() const -> bool;
+
+private:
+    auto Release() -> void;
+
+    std::uint8_t * data{nullptr};
+    std::size_t size{0};
+    std::size_t mappedSize{0};
+    HugePages hugePages{HugePages::NONE};
+};
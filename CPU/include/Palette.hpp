@@ -0,0 +1,17 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+
+struct Color
+{
+    std::uint8_t red;
+    std::uint8_t green;
+    std::uint8_t blue;
+};
+
+using Palette = std::array<Color, 256>;
+
+
+extern Palette const DEFAULT_PALETTE;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+#include "Utils.hpp"
+
+
+using Tile = oneapi::tbb::blocked_range2d<std::size_t>;
+
+enum class Partitioning : std::uint8_t
+{
+    AFFINITY,
+    AUTO,
+    STATIC,
+    BALANCED,
+    LONGEST_FIRST,
+    MORTON,
+    HILBERT,
+    WEIGHTED,
+};
+
+enum class MemoryLayout : std::uint8_t
+{
+    ROW_MAJOR,
+    TILED,
+};
+
+inline constexpr std::size_t DEFAULT_PROBE_STEP{8};
+
+// Estimated cost of every probeStep×probeStep cell of the image, taken from one sample per cell
+struct CostGrid
+{
+    Size cells;
+    std::size_t probeStep;
+    std::vector<double> costs;
+};
+
+
+auto ParsePartitioning(std::string_view name) -> Partitioning;
+
+auto GetPartitioningName(Partitioning partitioning) -> std::string_view;
+
+auto ParseMemoryLayout(std::string_view name) -> MemoryLayout;
+
+auto GetMemoryLayoutName(MemoryLayout memoryLayout) -> std::string_view;
+
+auto SplitByCost(CostGrid const & grid, Size const & imageSize, std::size_t tileCount) -> std::vector<Tile>;
+
+auto SortByCost(CostGrid const & grid, Size const & imageSize, std::size_t tileCount) -> std::vector<Tile>;
+
+auto MakeCurveTiles(Size const & imageSize, std::size_t tileSize, Partitioning curve) -> std::vector<Tile>;
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+
+enum class Counter : std::uint8_t
+{
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    L1D_MISSES,
+    LLC_MISSES,
+    SCALAR_FP_INSTRUCTIONS,
+    VECTOR_FP_INSTRUCTIONS,
+};
+
+inline constexpr std::size_t COUNTER_COUNT{7};
+
+struct CounterSample
+{
+    int thread;
+    std::array<std::optional<double>, COUNTER_COUNT> values;
+
+    [[nodiscard]] auto Get(Counter counter) const -> std::optional<double>;
+};
+
+
+auto GetCounterName(Counter counter) -> std::string_view;
+
+auto GetInstructionsPerCycle(CounterSample const & sample) -> std::optional<double>;
+
+auto GetVectorUtilisation(CounterSample const & sample) -> std::optional<double>;
+
+
+// Counts hardware events on every thread that enters the arena between Start and Stop, using one perf_event_open descriptor per event and thread
+class PerfCounters final : public oneapi::tbb::task_scheduler_observer
+{
+public:
+    // Observes the caller's arena, and also the given one where a generator renders in an arena of its own, which must outlive the counters
+    explicit PerfCounters(oneapi::tbb::task_arena * renderArena = nullptr);
+
+    ~PerfCounters() override;
+
+    PerfCounters(PerfCounters const &) = delete;
+
+    auto operator=(PerfCounters const &) -> PerfCounters & = delete;
+
+    auto Start() -> void;
+
+    auto Stop() -> void;
+
+    [[nodiscard]] auto IsAvailable() const -> bool;
+
+    [[nodiscard]] auto GetThreadSamples() const -> std::vector<CounterSample> const &;
+
+    [[nodiscard]] auto GetTotal() const -> CounterSample;
+
+    auto on_scheduler_entry(bool isWorker) -> void override;
+
+private:
+    struct ThreadCounters
+    {
+        int thread;
+        int systemThread;
+        std::array<int, COUNTER_COUNT> descriptors;
+    };
+
+    // An observer only watches a single arena, so the threads of the render arena come in through one of their own
+    class ArenaObserver final : public oneapi::tbb::task_scheduler_observer
+    {
+    public:
+        ArenaObserver(oneapi::tbb::task_arena & arena, PerfCounters & counters);
+
+        ~ArenaObserver() override;
+
+        ArenaObserver(ArenaObserver const &) = delete;
+
+        auto operator=(ArenaObserver const &) -> ArenaObserver & = delete;
+
+        auto on_scheduler_entry(bool isWorker) -> void override;
+
+    private:
+        PerfCounters & counters;
+    };
+
+    auto RegisterCurrentThread() -> void;
+
+    std::mutex mutex;
+    bool isRunning{false};
+    bool isAvailable{false};
+
+    std::vector<ThreadCounters> threads;
+    std::vector<CounterSample> samples;
+
+    std::optional<ArenaObserver> arenaObserver;
+};
+
+
+auto PrintCounters(PerfCounters const & counters, std::FILE * stream) -> void;
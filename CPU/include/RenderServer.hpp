@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <oneapi/tbb.h>
+
+#include "Affinity.hpp"
+#include "FractalFactory.hpp"
+#include "ImageWriter.hpp"
+#include "Metrics.hpp"
+#include "SocketListener.hpp"
+#include "Utils.hpp"
+
+
+struct RenderRequest
+{
+    FractalType type{FractalType::MANDELBROT};
+    Size imageSize{1024, 768};
+    std::optional<Viewport> viewport;
+    std::size_t maxIterations{256};
+    PixelLayout layout{PixelLayout::RGB};
+    ImageFormat format{ImageFormat::PNG};
+    Point juliaPoint{JuliaGenerator::C_POINT};
+    std::chrono::milliseconds timeBudget{0};
+    bool isCoarseFilled{false};
+};
+
+// Without a port the server listens on the Unix domain socket
+struct ServerOptions
+{
+    std::string socketPath;
+    int port{0};
+    std::size_t maxRequests{0};
+    ArenaOptions arenaOptions{};
+};
+
+
+// Parses the query of a render URL, e.g. fractal=julia&size=800x600&iterations=500&format=qoi&viewport=-1.6,1.2,1.6,-1.2&c=-0.7,0.27&budget=50&fill=coarse
+auto ParseRenderRequest(std::string_view query) -> RenderRequest;
+
+auto GetServerOptions(int argc, char const * const argv[]) -> ServerOptions;
+
+
+// Answers GET /render requests over HTTP and streams the encoded image back, and GET /metrics with the Prometheus text of the default metrics. All requests render in one arena that is created and warmed up once,
+// so concurrent requests split its threads by work stealing instead of oversubscribing the machine, and their images are recycled through the buffer pool.
+// A render with a time budget answers with whatever it finished in time, and the X-Render-Complete and X-Render-Tiles headers tell how much that was.
+// GET /tiles takes the same query and streams the raw pixels of every 64×64 cell as soon as it is done, each after its x, y, width and height as 32-bit little endian integers.
+class RenderServer
+{
+public:
+    explicit RenderServer(ServerOptions options);
+
+    RenderServer(RenderServer const &) = delete;
+
+    auto operator=(RenderServer const &) -> RenderServer & = delete;
+
+    // Blocks until Stop is called
+    auto Run() -> void;
+
+    // May be called from a signal handler
+    auto Stop() -> void;
+
+    // The returned generator holds the rendered and detiled image
+    auto Render(RenderRequest const & request) -> std::unique_ptr<FractalGenerator>;
+
+    [[nodiscard]] auto GetAddress() const -> std::string;
+
+    [[nodiscard]] auto GetConcurrency() const -> int;
+
+private:
+    struct Connection
+    {
+        int socket;
+        std::chrono::steady_clock::time_point accepted;
+    };
+
+    auto Serve(Connection const & connection) -> void;
+
+    auto MakeGenerator(RenderRequest const & request) const -> std::unique_ptr<FractalGenerator>;
+
+    auto StreamTiles(FractalGenerator & generator, std::FILE * output) -> void;
+
+    ServerOptions const options;
+
+    oneapi::tbb::task_arena arena;
+    std::optional<ArenaPinning> arenaPinning;
+
+    oneapi::tbb::concurrent_bounded_queue<Connection> connections;
+    SocketListener listener;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <oneapi/tbb.h>
+
+#include "FractalGenerator.hpp"
+#include "ImageWriter.hpp"
+#include "Palette.hpp"
+#include "Utils.hpp"
+
+
+inline constexpr std::uint32_t SHARED_FRAME_MAGIC{0x43415246}; // "FRAC" in little endian
+inline constexpr std::uint32_t SHARED_FRAME_VERSION{2};
+
+// Start of the segment, plain enough to be mapped from C. The pixels are row-major at pixelOffset, and the ready bitmap at bitmapOffset holds one bit per
+// tileSize×tileSize cell, row by row, in 64-bit words.
+struct SharedFrameHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t layout;
+    std::uint32_t tileSize;
+    std::uint32_t tilesWide;
+    std::uint32_t tilesHigh;
+    std::uint64_t stride;
+    std::uint64_t bitmapOffset;
+    std::uint64_t pixelOffset;
+    // Odd while a frame renders and even once its render ends, finished or not. A reader that sees the same even value before and after copying has a
+    // consistent frame, which is whole only when complete is set.
+    std::atomic<std::uint32_t> sequence;
+    // One when the frame of the last even sequence has every tile ready, zero while a frame renders and when a render was cancelled, ran out of its budget
+    // or failed. Written before the sequence turns even.
+    std::atomic<std::uint32_t> complete;
+    // Futex word, bumped whenever a tile becomes ready or the sequence changes
+    std::atomic<std::uint32_t> events;
+    Palette palette;
+};
+
+// Other processes read the header and the bitmap through plain memory, and the palette as 256 RGB triples
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free && sizeof(Palette) == 768U);
+
+
+// A frame in a named POSIX shared memory segment that other local processes map directly, without any encoding, file or copy in between.
+// The renderer marks every cell ready as soon as it is done, and readers sleep on a futex until something changes.
+class SharedFrame
+{
+public:
+    // Replaces a segment of the same name, which readers that still map it keep until they unmap it. The segment is removed again on destruction.
+    static auto Create(std::string const & name, Size const & imageSize, PixelLayout layout) -> SharedFrame;
+
+    // Maps a segment read-only
+    static auto Open(std::string const & name) -> SharedFrame;
+
+    SharedFrame(SharedFrame && other) noexcept;
+
+    ~SharedFrame();
+
+    SharedFrame(SharedFrame const &) = delete;
+
+    auto operator=(SharedFrame const &) -> SharedFrame & = delete;
+
+    auto operator=(SharedFrame &&) -> SharedFrame & = delete;
+
+    // The generator renders straight into the segment and keeps pointing there afterwards, it must use the row-major layout and match the frame
+    auto Render(FractalGenerator & generator, oneapi::tbb::task_arena * arena = nullptr) -> void;
+
+    // Blocks until the event count differs from the one given or the timeout passes, and returns the current count
+    auto WaitForEvents(std::uint32_t seen, std::chrono::milliseconds timeout) const -> std::uint32_t;
+
+    [[nodiscard]] auto IsTileReady(std::size_t tile) const -> bool;
+
+    [[nodiscard]] auto CountReadyTiles() const -> std::size_t;
+
+    // Whether the last frame that finished rendering is whole, to be checked together with an even sequence
+    [[nodiscard]] auto IsComplete() const -> bool;
+
+    [[nodiscard]] auto GetTileCount() const -> std::size_t;
+
+    [[nodiscard]] auto GetHeader() const -> SharedFrameHeader const &;
+
+    [[nodiscard]] auto GetView() const -> ImageView;
+
+    [[nodiscard]] auto GetName() const -> std::string const &;
+
+private:
+    SharedFrame(std::string name, void * mapping, std::size_t mappingSize, bool isOwner);
+
+    auto GetBitmap() const -> std::atomic<std::uint64_t> *;
+
+    auto Notify() -> void;
+
+    std::string const name;
+    void * mapping;
+    std::size_t const mappingSize;
+    bool isOwner;
+    SharedFrameHeader * const header;
+};
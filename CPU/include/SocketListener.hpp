@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+
+// Listening socket and accept loop of the long-running render services
+class SocketListener
+{
+public:
+    // Listens on the TCP port of the IPv4 host, or on the Unix domain socket at the path when the port is not positive, replacing a socket file that is left over
+    SocketListener(std::string host, int port, std::string socketPath = {});
+
+    ~SocketListener();
+
+    SocketListener(SocketListener const &) = delete;
+
+    auto operator=(SocketListener const &) -> SocketListener & = delete;
+
+    // Hands every accepted connection to the handler until Stop is called, or until accepting fails for another reason than a signal or an aborted connection
+    auto Run(std::function<void(int connection)> const & handler) -> void;
+
+    // Only touches an atomic and the socket, so it may be called from a signal handler
+    auto Stop() -> void;
+
+    // host:port, or unix:path for the domain socket
+    [[nodiscard]] auto GetAddress() const -> std::string;
+
+private:
+    std::string const host;
+    int const port;
+    std::string const socketPath;
+
+    std::atomic<int> listener{-1};
+    std::atomic<bool> isStopping{false};
+};
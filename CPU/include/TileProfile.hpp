@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include "Utils.hpp"
+
+
+struct TileRecord
+{
+    Pixel origin;
+    Size size;
+    double startMilliseconds;
+    double endMilliseconds;
+    std::uint64_t iterations;
+    int thread;
+};
+
+struct ThreadLoad
+{
+    int thread;
+    std::size_t tiles;
+    std::uint64_t iterations;
+    double busyMilliseconds;
+    double lastEndMilliseconds;
+};
+
+
+auto SummarizeThreadLoads(std::vector<TileRecord> const & records) -> std::vector<ThreadLoad>;
+
+auto WriteTileRecordsCSV(std::vector<TileRecord> const & records, std::filesystem::path const & path) -> void;
+
+auto WriteTileHeatmap(std::vector<TileRecord> const & records, Size const & imageSize, std::filesystem::path const & path) -> void;
+
+auto PrintLoadImbalance(std::vector<TileRecord> const & records, std::FILE * stream) -> void;
+
+auto WriteTileProfile(std::vector<TileRecord> const & records, Size const & imageSize, std::string_view prefix) -> void;
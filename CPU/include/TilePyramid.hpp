@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+#include "FractalFactory.hpp"
+#include "ImageWriter.hpp"
+#include "Utils.hpp"
+
+
+enum class PyramidScheme : std::uint8_t
+{
+    XYZ,
+    DZI,
+};
+
+
+auto ParsePyramidScheme(std::string_view name) -> PyramidScheme;
+
+
+class TilePyramid
+{
+public:
+    TilePyramid(FractalType type, std::size_t maxLevel, std::size_t maxIterations, PixelLayout layout = PixelLayout::RGB);
+
+    auto Generate(std::filesystem::path const & directory, PyramidScheme scheme, std::string_view format) -> void;
+
+    static constexpr std::size_t TILE_SIZE{256};
+
+private:
+    using Tile = std::vector<std::uint8_t, oneapi::tbb::cache_aligned_allocator<std::uint8_t>>;
+
+    [[nodiscard]] auto BuildTile(std::size_t level, std::size_t x, std::size_t y) const -> Tile;
+
+    [[nodiscard]] auto RenderTile(std::size_t level, std::size_t x, std::size_t y) const -> Tile;
+
+    [[nodiscard]] auto AssembleTile(std::array<Tile, 4> const & children) const -> Tile;
+
+    auto WriteTile(Tile const & tile, Size const & size, std::size_t level, std::size_t x, std::size_t y) const -> void;
+
+    auto WriteOverviewLevels(Tile const & root) const -> void;
+
+    auto CreateDirectories() const -> void;
+
+    [[nodiscard]] auto GetTilePath(std::size_t level, std::size_t x, std::size_t y) const -> std::filesystem::path;
+
+    FractalType const type;
+    std::size_t const maxLevel;
+    std::size_t const maxIterations;
+
+    PixelLayout const layout;
+    std::size_t const channels;
+
+    Viewport const world;
+
+    std::filesystem::path directory;
+    PyramidScheme scheme{PyramidScheme::XYZ};
+    std::string format;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+
+#include <oneapi/tbb/concurrent_queue.h>
+
+#include "ImageWriter.hpp"
+#include "Utils.hpp"
+
+
+// A finished 64×64 cell of an asynchronous render, whose view points into the image of the generator until it renders again
+struct CompletedTile
+{
+    std::size_t cell;
+    Pixel position;
+    ImageView view;
+};
+
+
+// Finished tiles of one render in completion order. The render threads publish through a TBB concurrent_queue, which is not lock-free but only spins briefly on one of
+// its micro-queues, and never wait for the consumer, which sleeps on an atomic until there is more.
+class TileStream
+{
+public:
+    explicit TileStream(std::size_t tileCount);
+
+    TileStream(TileStream const &) = delete;
+
+    auto operator=(TileStream const &) -> TileStream & = delete;
+
+    auto Publish(CompletedTile const & tile) -> void;
+
+    // Called once the render is over, every tile published before is still handed out
+    auto Close() -> void;
+
+    // Blocks until the next tile is done. Empty once the stream is closed and drained, which is before every tile arrived when the render was cancelled or ran out of time.
+    [[nodiscard]] auto Next() -> std::optional<CompletedTile>;
+
+    [[nodiscard]] auto GetTileCount() const -> std::size_t;
+
+private:
+    std::size_t const tileCount;
+
+    oneapi::tbb::concurrent_queue<CompletedTile> tiles;
+    std::atomic<std::uint64_t> version{0};
+    std::atomic<bool> isClosed{false};
+};
+
+
+// The future ends with the render and carries its exception, and destroying it waits for the render
+struct AsyncRender
+{
+    std::future<void> done;
+    std::shared_ptr<TileStream> tiles;
+};
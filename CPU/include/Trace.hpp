@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+
+#ifdef FRACTAL_TRACING
+    #define TRACE_CONCAT_IMPL(a, b) a##b
+    #define TRACE_CONCAT(a, b)      TRACE_CONCAT_IMPL(a, b)
+    #define TRACE_SCOPE(name)       TraceScope const TRACE_CONCAT(traceScope, __LINE__){name}
+#else
+    #define TRACE_SCOPE(name)       static_cast<void>(0)
+#endif
+
+
+class TraceScope
+{
+public:
+    explicit TraceScope(char const * name);
+
+    ~TraceScope();
+
+    TraceScope(TraceScope const &) = delete;
+
+    auto operator=(TraceScope const &) -> TraceScope & = delete;
+
+private:
+    char const * const name;
+    std::int64_t const start;
+};
+
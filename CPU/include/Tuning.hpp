@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "ImageWriter.hpp"
+#include "Partitioning.hpp"
+#include "Utils.hpp"
+
+
+struct TuningKey
+{
+    std::string fractal;
+    Size imageSize;
+    std::size_t maxIterations;
+    PixelLayout layout;
+    int concurrency;
+};
+
+struct TuningConfig
+{
+    Size grainSize;
+    Partitioning partitioning;
+    std::size_t simdWidth;
+    int threads;
+};
+
+struct TuningEntry
+{
+    TuningKey key;
+    TuningConfig config;
+    double milliseconds;
+};
+
+
+auto GetTuningCachePath() -> std::filesystem::path;
+
+auto LoadTuningCache(std::filesystem::path const & path) -> std::vector<TuningEntry>;
+
+auto SaveTuningEntry(std::filesystem::path const & path, TuningEntry const & entry) -> void;
+
+auto FindTuning(std::vector<TuningEntry> const & entries, TuningKey const & key) -> std::optional<TuningConfig>;
+
+auto LookupTuning(TuningKey const & key) -> std::optional<TuningConfig>;
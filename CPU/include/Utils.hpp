@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
 #include <complex>
 #include <cstdint>
 #include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
 
 
 #define ARGS_COUNT    ( 4U )
@@ -30,8 +34,41 @@ struct Size
     std::size_t height;
 };
 
+struct Viewport
+{
+    Point topLeft;
+    Point bottomRight;
+};
+
+
+// The options that the fractal executables accept, given without their leading dashes
+inline constexpr std::array<std::string_view, 17> RENDER_OPTIONS{
+    "output", "layout", "partitioning", "simd", "memory", "executor", "allocation", "huge-pages", "threads", "numa-node", "core-type", "pin", "efficient-weight", "budget",
+    "coarse-fill", "profile", "counters",
+};
+
+
+// The usage of the fractal executables, listing the RENDER_OPTIONS
+inline constexpr std::string_view RENDER_USAGE{
+    "<width> <height> <max_iterations> [--output=<file.png|.qoi|.bmp|.ppm>] [--layout=rgb|bgr|rgba|bgra|indexed] "
+    "[--partitioning=affinity|auto|static|balanced|longest|morton|hilbert|weighted] [--simd=1|4|8|16] [--memory=row|tiled] [--executor=tbb|omp-dynamic|omp-guided|std|pool] "
+    "[--allocation=zeroed|first-touch] [--huge-pages=none|thp|explicit] [--threads=<count>] [--numa-node=<id>] [--core-type=any|performance|efficient] [--pin] "
+    "[--efficient-weight=<weight>] [--budget=<ms>] [--coarse-fill] [--profile=<prefix>] [--counters]"
+};
+
+
+// Exits with the usage on too few arguments or on any option that is not one of the given names, with or without a value
+auto CheckParameters(
+    int argc, char const * const argv[], std::span<std::string_view const> options = RENDER_OPTIONS, std::string_view usage = RENDER_USAGE, std::size_t argumentsCount = ARGS_COUNT
+) -> void;
+
+auto GetOption(int argc, char const * const argv[], std::string_view name, std::string_view fallback) -> std::string_view;
+
+auto HasFlag(int argc, char const * const argv[], std::string_view name) -> bool;
+
+auto SplitList(std::string_view list, char separator = ',') -> std::vector<std::string_view>;
 
-auto CheckParameters(int argc, char const * const argv[]) -> void;
+auto ParseSize(std::string_view size) -> Size;
 
 auto GetGrainSize(Size const & imageSize, int numberOfThreads) -> Size;
 
@@ -0,0 +1,134 @@
+#!/usr/bin/env bash
+# Renders an image on three loopback workers, kills one of them while it holds tiles and checks that the result still matches a single-process render byte
+# for byte. Then renders next to a stopped worker and checks that the render returns long before the tile timeout, without counting that worker as lost.
+# Usage: check_distributed.sh [<directory with Server, Distribute and Mandelbrot>]
+set -euo pipefail
+
+BIN="${1:-.}"
+WIDTH=640
+HEIGHT=480
+ITERATIONS=1000
+WORK="$(mktemp -d)"
+PIDS=()
+WORKERS=()
+
+cleanup()
+{
+    for pid in "${PIDS[@]}"; do
+        kill -KILL "$pid" 2>/dev/null || true
+    done
+
+    wait 2>/dev/null || true
+    rm -rf "$WORK"
+}
+
+trap cleanup EXIT
+
+# Tries random ports until a worker binds one, so that runs in parallel never share a port. A port that answers before the worker starts belongs to someone else.
+start_worker()
+{
+    while true; do
+        local port=$((20000 + RANDOM % 40000))
+
+        if (exec 3<>"/dev/tcp/127.0.0.1/$port") 2>/dev/null; then
+            continue
+        fi
+
+        "$BIN/Server" --worker --bind=127.0.0.1 --port="$port" --threads=1 > "$WORK/worker${#PIDS[@]}.log" 2>&1 &
+        local pid=$!
+
+        for _ in $(seq 100); do
+            if ! kill -0 "$pid" 2>/dev/null; then
+                break
+            fi
+
+            if (exec 3<>"/dev/tcp/127.0.0.1/$port") 2>/dev/null; then
+                PIDS+=("$pid")
+                WORKERS+=("127.0.0.1:$port")
+                return
+            fi
+
+            sleep 0.1
+        done
+
+        kill -KILL "$pid" 2>/dev/null || true
+        wait "$pid" 2>/dev/null || true
+    done
+}
+
+for _ in 0 1 2 3; do
+    start_worker
+done
+
+# The fourth worker only takes part in the slow-worker case
+SLOW_WORKER="${WORKERS[3]}"
+WORKERS=("${WORKERS[@]:0:3}")
+
+LIST="$(IFS=,; echo "${WORKERS[*]}")"
+
+# Every worker is stopped while the coordinator hands out the first tiles, so the render cannot end before the kill however fast the machine is
+kill -STOP "${PIDS[0]}" "${PIDS[1]}" "${PIDS[2]}"
+
+"$BIN/Distribute" "$WIDTH" "$HEIGHT" "$ITERATIONS" --workers="$LIST" --tile=64x64 --tile-timeout=10 --output="$WORK/distributed.ppm" > "$WORK/distribute.log" 2>&1 &
+COORDINATOR=$!
+
+sleep 0.5
+kill -KILL "${PIDS[1]}"
+wait "${PIDS[1]}" 2>/dev/null || true
+kill -CONT "${PIDS[0]}" "${PIDS[2]}"
+
+if ! wait "$COORDINATOR"; then
+    cat "$WORK/distribute.log"
+    echo "FAIL: the distributed render did not finish"
+    exit 1
+fi
+
+cat "$WORK/distribute.log"
+
+if ! grep -q "${WORKERS[1]}: .*, lost" "$WORK/distribute.log"; then
+    echo "FAIL: the killed worker was not counted as lost"
+    exit 1
+fi
+
+"$BIN/Mandelbrot" "$WIDTH" "$HEIGHT" "$ITERATIONS" --output="$WORK/single.ppm" > /dev/null
+
+if ! cmp "$WORK/distributed.ppm" "$WORK/single.ppm"; then
+    echo "FAIL: the distributed render differs from the single-process one"
+    exit 1
+fi
+
+echo "PASS: the distributed render matches the single-process one after losing ${WORKERS[1]}"
+
+# A stopped worker still accepts connections through the kernel but never answers, so its tiles can only finish through stealing
+kill -STOP "${PIDS[3]}"
+
+SLOW_TIMEOUT=60
+START=$SECONDS
+
+if ! "$BIN/Distribute" "$WIDTH" "$HEIGHT" "$ITERATIONS" --workers="${WORKERS[0]},$SLOW_WORKER" --tile=64x64 --tile-timeout="$SLOW_TIMEOUT" --output="$WORK/slow.ppm" > "$WORK/slow.log" 2>&1; then
+    cat "$WORK/slow.log"
+    echo "FAIL: the render next to a stopped worker did not finish"
+    exit 1
+fi
+
+ELAPSED=$((SECONDS - START))
+cat "$WORK/slow.log"
+
+if ((ELAPSED * 4 >= SLOW_TIMEOUT)); then
+    echo "FAIL: the render took ${ELAPSED} s next to a stopped worker, it waited for the ${SLOW_TIMEOUT} s tile timeout"
+    exit 1
+fi
+
+if grep -q "${SLOW_WORKER}: .*, lost" "$WORK/slow.log"; then
+    echo "FAIL: the stopped worker was counted as lost after the render had finished"
+    exit 1
+fi
+
+"$BIN/Mandelbrot" "$WIDTH" "$HEIGHT" "$ITERATIONS" --output="$WORK/slow-single.ppm" > /dev/null
+
+if ! cmp "$WORK/slow.ppm" "$WORK/slow-single.ppm"; then
+    echo "FAIL: the render next to a stopped worker differs from the single-process one"
+    exit 1
+fi
+
+echo "PASS: the render returned after ${ELAPSED} s next to the stopped worker ${SLOW_WORKER}"
@@ -0,0 +1,72 @@
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <print>
+#include <string>
+
+#include "Animation.hpp"
+#include "BufferPool.hpp"
+#include "Metrics.hpp"
+#include "Utils.hpp"
+
+
+enum AnimateArguments : std::uint8_t
+{
+    PARAM_KEYFRAMES = 0x03,
+};
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 7> OPTIONS{"fractal", "format", "output", "fps", "pool-stats", "metrics-file", "metrics-interval"};
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    CheckParameters(argc, argv, OPTIONS, "<width> <height> <keyframes_file> [--fractal=mandelbrot|julia|cosine|tricorn] [--format=y4m|rgb] [--output=-|<file or FIFO>] [--fps=<rate>] [--pool-stats] [--metrics-file=<path>] [--metrics-interval=<seconds>]");
+
+    std::size_t const imageWidth{std::stoul(argv[PARAM_WIDTH])};
+    std::size_t const imageHeight{std::stoul(argv[PARAM_HEIGHT])};
+    Size const imageSize{imageWidth, imageHeight};
+
+    auto const type{ParseFractalType(GetOption(argc, argv, "fractal", "mandelbrot"))};
+    auto const format{ParseStreamFormat(GetOption(argc, argv, "format", "y4m"))};
+    std::string const outputName{GetOption(argc, argv, "output", "-")};
+    std::size_t const framesPerSecond{std::stoul(std::string{GetOption(argc, argv, "fps", "30")})};
+
+    Animation const animation{type, imageSize, LoadKeyframes(argv[PARAM_KEYFRAMES])};
+    auto const metricsDump{StartMetricsDump(argc, argv)};
+
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file{nullptr, &std::fclose};
+
+    if (outputName != "-")
+    {
+        file.reset(std::fopen(outputName.c_str(), "wb"));
+
+        if (!file)
+        {
+            std::println(stderr, "Could not open {}", outputName);
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto * const output{file ? file.get() : stdout};
+
+    // Progress goes to stderr, since stdout may be the video stream
+    std::println(stderr, "Streaming {} frames of the {} fractal with size {}×{} to {}", animation.GetFrameCount(), GetFractalName(type), imageWidth, imageHeight, outputName);
+
+    auto const start{std::chrono::steady_clock::now()};
+    animation.Stream(output, format, framesPerSecond);
+    auto const elapsed{std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)};
+
+    std::println(stderr, "Time taken for animation rendering : {} ms ({:.2f} frames/s)", elapsed.count(), 1000.0 * animation.GetFrameCount() / std::max<double>(1.0, elapsed.count()));
+
+    if (HasFlag(argc, argv, "pool-stats"))
+    {
+        PrintPoolStatistics(BufferPool::GetDefault().GetStatistics(), stderr);
+    }
+
+    return EXIT_SUCCESS;
+}
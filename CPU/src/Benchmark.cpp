@@ -0,0 +1,386 @@
+#include <array>
+#include <format>
+#include <numeric>
+#include <print>
+#include <string>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+#include "Affinity.hpp"
+#include "BenchmarkTools.hpp"
+#include "CpuDispatch.hpp"
+#include "Executor.hpp"
+#include "FractalFactory.hpp"
+#include "LaneKernels.hpp"
+#include "PerfCounters.hpp"
+#include "Utils.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 20> OPTIONS{"fractals", "sizes", "iterations", "viewports", "layouts", "partitionings", "memory-layouts", "executors", "simd-widths", "threads", "numa-node", "core-type", "pin", "warmups", "repetitions", "json", "baseline", "threshold", "counters", "kernels"};
+
+    // Side of the square grid of points the kernel cases iterate
+    constexpr std::size_t KERNEL_GRID_SIZE{256};
+
+    auto GetBenchmarkViewport(FractalType const type, std::string_view const name) -> Viewport
+    {
+        auto const viewport{GetDefaultViewport(type)};
+
+        if (name == "full")
+        {
+            return viewport;
+        }
+
+        if (name == "center")
+        {
+            auto const center{(viewport.topLeft + viewport.bottomRight) / 2.0F};
+            auto const quarter{(viewport.bottomRight - viewport.topLeft) / 8.0F};
+
+            return {center - quarter, center + quarter};
+        }
+
+        throw std::invalid_argument(std::format("Unknown benchmark viewport {}.", name));
+    }
+
+    struct BenchmarkCase
+    {
+        FractalType type;
+        std::string_view size;
+        std::size_t maxIterations;
+        std::string_view viewport;
+        std::string_view layout;
+        Partitioning partitioning;
+        MemoryLayout memoryLayout;
+        ExecutorType executor;
+        // Zero leaves the generator at its default width
+        std::size_t simdWidth;
+    };
+
+    // The defaults leave the case names unchanged so that older baselines still match
+    auto GetCaseName(BenchmarkCase const & benchmarkCase) -> std::string
+    {
+        auto name{std::format("{}/{}/{}/{}/{}", GetFractalName(benchmarkCase.type), benchmarkCase.size, benchmarkCase.maxIterations, benchmarkCase.viewport, benchmarkCase.layout)};
+
+        if (benchmarkCase.partitioning != Partitioning::AFFINITY)
+        {
+            name += std::format("/{}", GetPartitioningName(benchmarkCase.partitioning));
+        }
+
+        if (benchmarkCase.memoryLayout != MemoryLayout::ROW_MAJOR)
+        {
+            name += std::format("/{}", GetMemoryLayoutName(benchmarkCase.memoryLayout));
+        }
+
+        if (benchmarkCase.executor != ExecutorType::TBB)
+        {
+            name += std::format("/{}", GetExecutorName(benchmarkCase.executor));
+        }
+
+        if (benchmarkCase.simdWidth != 0U)
+        {
+            name += std::format("/simd{}", benchmarkCase.simdWidth);
+        }
+
+        return name;
+    }
+
+    // The counters are collected on a separate run so that they do not perturb the timed ones, and watch the arena the case renders in
+    auto AddCounterMetrics(FractalGenerator & generator, BenchmarkResult & result) -> void
+    {
+        PerfCounters counters{generator.GetRenderArena()};
+
+        counters.Start();
+        generator.Render();
+        counters.Stop();
+
+        auto const total{counters.GetTotal()};
+
+        for (std::size_t counter{0}; counter < COUNTER_COUNT; ++counter)
+        {
+            if (total.values[counter])
+            {
+                result.metrics.emplace_back(GetCounterName(static_cast<Counter>(counter)), *total.values[counter]);
+            }
+        }
+
+        if (auto const ipc{GetInstructionsPerCycle(total)})
+        {
+            result.metrics.emplace_back("ipc", *ipc);
+        }
+
+        if (auto const vector{GetVectorUtilisation(total)})
+        {
+            result.metrics.emplace_back("vector_utilisation", *vector);
+        }
+    }
+
+    auto RunCase(BenchmarkCase const & benchmarkCase, ArenaOptions const & arenaOptions, std::size_t const warmups, std::size_t const repetitions, bool const isCounting)
+        -> BenchmarkResult
+    {
+        auto const imageSize{ParseSize(benchmarkCase.size)};
+        auto const grainSize{GetGrainSize(imageSize, oneapi::tbb::info::default_concurrency())};
+        auto const viewport{GetBenchmarkViewport(benchmarkCase.type, benchmarkCase.viewport)};
+
+        auto const generator{MakeFractalGenerator(benchmarkCase.type, imageSize, grainSize, viewport, benchmarkCase.maxIterations, ParsePixelLayout(benchmarkCase.layout))};
+        generator->SetMemoryLayout(benchmarkCase.memoryLayout);
+        generator->SetPartitioning(benchmarkCase.partitioning);
+        generator->SetExecutor(benchmarkCase.executor);
+
+        if (benchmarkCase.simdWidth != 0U)
+        {
+            generator->SetSimdWidth(benchmarkCase.simdWidth);
+        }
+
+        generator->SetArenaOptions(arenaOptions);
+
+        BenchmarkResult result{
+            GetCaseName(benchmarkCase),
+            {
+                {"fractal", std::string{GetFractalName(benchmarkCase.type)}},
+                {"size", std::string{benchmarkCase.size}},
+                {"max_iterations", std::to_string(benchmarkCase.maxIterations)},
+                {"viewport", std::string{benchmarkCase.viewport}},
+                {"layout", std::string{benchmarkCase.layout}},
+                {"partitioning", std::string{GetPartitioningName(benchmarkCase.partitioning)}},
+                {"memory_layout", std::string{GetMemoryLayoutName(benchmarkCase.memoryLayout)}},
+                {"executor", std::string{GetExecutorName(benchmarkCase.executor)}},
+                {"simd_width", std::to_string(generator->GetSimdWidth())},
+                {"isa", std::string{GetInstructionSetName(GetActiveInstructionSet())}},
+                {"core_type", std::string{GetCoreTypeName(arenaOptions.coreType)}},
+                {"pinned", arenaOptions.isPinned ? "true" : "false"},
+            },
+            Measure(
+                [&generator]() -> void
+                {
+                    // De-tiling is part of the cost of the tiled layout, so it is timed together with the render
+                    generator->Render();
+                    generator->Detile();
+                }, warmups, repetitions
+            ),
+            generator->CountIterations(),
+            imageSize.width * imageSize.height,
+        };
+
+        if (isCounting)
+        {
+            AddCounterMetrics(*generator, result);
+        }
+
+        return result;
+    }
+
+    // The kernel cases iterate one fixed buffer of points on the calling thread, so that scalar and lane kernels compare without tiles, pixels or scheduling
+    auto RunKernelCases(FractalType const type, std::size_t const maxIterations, std::string_view const viewportName, std::size_t const warmups, std::size_t const repetitions)
+        -> std::vector<BenchmarkResult>
+    {
+        Size const gridSize{KERNEL_GRID_SIZE, KERNEL_GRID_SIZE};
+        auto const viewport{GetBenchmarkViewport(type, viewportName)};
+        auto const generator{MakeFractalGenerator(type, gridSize, gridSize, viewport, maxIterations)};
+
+        std::vector<Point> points;
+        points.reserve(gridSize.width * gridSize.height);
+
+        auto const extent{viewport.bottomRight - viewport.topLeft};
+
+        for (std::size_t row{0}; row < gridSize.height; ++row)
+        {
+            for (std::size_t col{0}; col < gridSize.width; ++col)
+            {
+                auto const x{(static_cast<float>(col) + 0.5F) / static_cast<float>(gridSize.width)};
+                auto const y{(static_cast<float>(row) + 0.5F) / static_cast<float>(gridSize.height)};
+                points.emplace_back(viewport.topLeft.real() + x * extent.real(), viewport.topLeft.imag() + y * extent.imag());
+            }
+        }
+
+        std::vector<std::size_t> iterations(points.size());
+        std::vector<BenchmarkResult> results;
+
+        auto const run{
+            [&](std::string_view const isa, std::size_t const simdWidth) -> void
+            {
+                generator->SetSimdWidth(simdWidth);
+
+                auto const milliseconds{Measure([&]() -> void { generator->IteratePoints(points, iterations); }, warmups, repetitions)};
+
+                results.push_back({
+                    std::format("kernel/{}/{}/{}/{}", GetFractalName(type), maxIterations, viewportName, simdWidth == 1U ? std::string{"scalar"} : std::format("{}/lanes{}", isa, simdWidth)),
+                    {
+                        {"fractal", std::string{GetFractalName(type)}},
+                        {"max_iterations", std::to_string(maxIterations)},
+                        {"viewport", std::string{viewportName}},
+                        {"isa", std::string{isa}},
+                        {"simd_width", std::to_string(simdWidth)},
+                    },
+                    milliseconds,
+                    std::accumulate(iterations.begin(), iterations.end(), std::uint64_t{0}),
+                    points.size(),
+                });
+            }
+        };
+
+        run("scalar", 1U);
+
+        if (!generator->HasLaneKernel())
+        {
+            return results;
+        }
+
+        auto const active{GetActiveInstructionSet()};
+
+        for (std::size_t index{0}; index <= static_cast<std::size_t>(DetectInstructionSet()); ++index)
+        {
+            auto const instructionSet{static_cast<InstructionSet>(index)};
+            SetInstructionSet(instructionSet);
+
+            for (auto const simdWidth : SIMD_WIDTHS)
+            {
+                if (simdWidth > 1U)
+                {
+                    run(GetInstructionSetName(instructionSet), simdWidth);
+                }
+            }
+        }
+
+        SetInstructionSet(active);
+
+        return results;
+    }
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    CheckParameters(
+        argc, argv, OPTIONS,
+        "[--fractals=mandelbrot,julia,cosine,tricorn] [--sizes=1920x1080,...] [--iterations=256,...] [--viewports=full,center] [--layouts=rgb,indexed,...] "
+        "[--partitionings=affinity,balanced,longest,morton,hilbert,weighted] [--memory-layouts=row,tiled] [--executors=tbb,omp-dynamic,omp-guided,std,pool] [--simd-widths=native,1,4,8,16] [--threads=<count>] [--numa-node=<id>] [--core-type=any|performance|efficient] [--pin] [--warmups=<count>] [--repetitions=<count>] [--json=<file>] [--baseline=<file>] [--threshold=<percent>] [--counters] [--kernels]", 1U
+    );
+
+    auto const fractals{SplitList(GetOption(argc, argv, "fractals", "mandelbrot,julia,cosine,tricorn"))};
+    auto const sizes{SplitList(GetOption(argc, argv, "sizes", "1920x1080,3840x2160"))};
+    auto const iterationCounts{SplitList(GetOption(argc, argv, "iterations", "256,1024"))};
+    auto const viewports{SplitList(GetOption(argc, argv, "viewports", "full,center"))};
+    auto const layouts{SplitList(GetOption(argc, argv, "layouts", "rgb,indexed"))};
+    auto const partitionings{SplitList(GetOption(argc, argv, "partitionings", "affinity"))};
+    auto const memoryLayouts{SplitList(GetOption(argc, argv, "memory-layouts", "row"))};
+    auto const executors{SplitList(GetOption(argc, argv, "executors", "tbb"))};
+    auto const simdWidths{SplitList(GetOption(argc, argv, "simd-widths", "native"))};
+
+    std::size_t const warmups{std::stoul(std::string{GetOption(argc, argv, "warmups", "1")})};
+    std::size_t const repetitions{std::stoul(std::string{GetOption(argc, argv, "repetitions", "5")})};
+    std::string const jsonPath{GetOption(argc, argv, "json", "benchmark.json")};
+    std::string const baselinePath{GetOption(argc, argv, "baseline", "")};
+    double const threshold{std::stod(std::string{GetOption(argc, argv, "threshold", "5")})};
+
+    auto const numThreads{oneapi::tbb::info::default_concurrency()};
+    auto const arenaOptions{GetArenaOptions(argc, argv)};
+
+    auto isCounting{HasFlag(argc, argv, "counters")};
+
+    if (isCounting && !PerfCounters{}.IsAvailable())
+    {
+        std::println(stderr, "Hardware counters are not available, continuing without them");
+        isCounting = false;
+    }
+
+    std::println(
+        "Benchmarking on {} threads ({} kernels) with {} warm-up and {} timed runs per case", numThreads, GetInstructionSetName(GetActiveInstructionSet()), warmups, repetitions
+    );
+    std::println("{:<56} {:>12} {:>10} {:>12} {:>12}", "Benchmark", "Median [ms]", "MAD [ms]", "Giter/s", "Mpixel/s");
+
+    std::vector<BenchmarkResult> results;
+
+    auto const printResult{
+        [](BenchmarkResult const & result) -> void
+        {
+            std::println(
+                "{:<56} {:>12.3f} {:>10.3f} {:>12.3f} {:>12.3f}", result.name, result.milliseconds.median, result.milliseconds.medianAbsoluteDeviation, GetIterationsPerSecond(result) / 1e9,
+                GetPixelsPerSecond(result) / 1e6
+            );
+        }
+    };
+
+    // The kernel cases replace the render cases, the sizes and render options do not apply to them
+    if (HasFlag(argc, argv, "kernels"))
+    {
+        for (auto const fractal : fractals)
+        {
+            for (auto const iterations : iterationCounts)
+            {
+                for (auto const viewport : viewports)
+                {
+                    for (auto & result : RunKernelCases(ParseFractalType(fractal), std::stoul(std::string{iterations}), viewport, warmups, repetitions))
+                    {
+                        printResult(result);
+                        results.push_back(std::move(result));
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        std::vector<BenchmarkCase> cases;
+
+        for (auto const fractal : fractals)
+        {
+            for (auto const size : sizes)
+            {
+                for (auto const iterations : iterationCounts)
+                {
+                    for (auto const viewport : viewports)
+                    {
+                        for (auto const layout : layouts)
+                        {
+                            for (auto const memoryLayout : memoryLayouts)
+                            {
+                                for (auto const partitioning : partitionings)
+                                {
+                                    for (auto const executor : executors)
+                                    {
+                                        for (auto const simdWidth : simdWidths)
+                                        {
+                                            cases.push_back({
+                                                ParseFractalType(fractal), size, std::stoul(std::string{iterations}), viewport, layout, ParsePartitioning(partitioning),
+                                                ParseMemoryLayout(memoryLayout), ParseExecutorType(executor), simdWidth == "native" ? 0U : std::stoul(std::string{simdWidth}),
+                                            });
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        for (auto const & benchmarkCase : cases)
+        {
+            auto result{RunCase(benchmarkCase, arenaOptions, warmups, repetitions, isCounting)};
+
+            printResult(result);
+
+            for (auto const & [key, value] : result.metrics)
+            {
+                if (key == "ipc" || key == "vector_utilisation")
+                {
+                    std::println("    {:<52} {:>12.3f}", key, value);
+                }
+            }
+
+            results.push_back(std::move(result));
+        }
+    }
+
+    WriteBenchmarkJSON(results, jsonPath);
+    std::println("Results written to {}", jsonPath);
+
+    if (!baselinePath.empty() && CompareWithBaseline(results, LoadBenchmarkMedians(baselinePath), threshold))
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -3,6 +3,8 @@
 #include <oneapi/tbb.h>
 
 #include "CosineGenerator.hpp"
+#include "CpuDispatch.hpp"
+#include "FractalCommand.hpp"
 #include "Utils.hpp"
 
 
@@ -21,17 +23,14 @@ auto main(int const argc, char const * const argv[]) -> int
     auto const grainSize{GetGrainSize(imageSize, numThreads)};
 
     std::println(
-        "Generating Cosine fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height, numThreads
+        "Generating Cosine fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads ({} kernels)", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height,
+        numThreads, GetInstructionSetName(GetActiveInstructionSet())
     );
 
-    CosineGenerator cosineGenerator{imageSize, grainSize, maxIterations};
-    TestSpeed(
-        [&cosineGenerator]() -> void
-        {
-            cosineGenerator.Render();
-        }, "Cosine fractal generation"
-    );
-    cosineGenerator.Save("Cosine.png");
+    CosineGenerator cosineGenerator{imageSize, grainSize, maxIterations, ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"))};
+    ConfigureFromArguments(cosineGenerator, argc, argv);
+
+    RenderFromArguments(cosineGenerator, argc, argv);
 
     return EXIT_SUCCESS;
 }
@@ -1,9 +1,13 @@
 #include "CosineGenerator.hpp"
 
 
-CosineGenerator::CosineGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations) : FractalGenerator{imageSize, grainSize, TOP_LEFT, BOTTOM_RIGHT, maxIterations} { }
+CosineGenerator::CosineGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations, PixelLayout const layout) :
+    CosineGenerator{imageSize, grainSize, {TOP_LEFT, BOTTOM_RIGHT}, maxIterations, layout} { }
 
-auto CosineGenerator::Generate(Point const & startPoint) const -> std::uint8_t
+CosineGenerator::CosineGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t const maxIterations, PixelLayout const layout) :
+    FractalGenerator{imageSize, grainSize, viewport.topLeft, viewport.bottomRight, maxIterations, layout} { }
+
+auto CosineGenerator::Iterate(Point const & startPoint) const -> std::size_t
 {
     Point point{0.0, 0.0};
 
@@ -11,11 +15,16 @@ auto CosineGenerator::Generate(Point const & startPoint) const -> std::uint8_t
     {
         if (std::abs(point) > RADIUS)
         {
-            return static_cast<std::uint8_t>(MAX_COLOR * std::log(iteration + 1) / logMaxIterations);
+            return iteration;
         }
 
         point = std::cos(point) + startPoint;
     }
 
-    return 0;
+    return maxIterations;
+}
+
+auto CosineGenerator::GetName() const -> std::string_view
+{
+    return "Cosine";
 }
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <print>
+#include <string>
+#include <vector>
+
+#include "BufferPool.hpp"
+#include "DistributedRender.hpp"
+#include "ImageWriter.hpp"
+#include "Utils.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 6> OPTIONS{"workers", "fractal", "layout", "tile", "tile-timeout", "output"};
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    CheckParameters(
+        argc, argv, OPTIONS,
+        "<width> <height> <max_iterations> --workers=<host:port>,... [--fractal=mandelbrot|julia|cosine|tricorn] [--layout=rgb|bgr|rgba|bgra|indexed] [--tile=256x256] [--tile-timeout=<seconds>] [--output=Distributed.png]"
+    );
+
+    std::vector<std::string> workers;
+
+    for (auto const worker : SplitList(GetOption(argc, argv, "workers", "")))
+    {
+        workers.emplace_back(worker);
+    }
+
+    DistributedJob job{};
+    job.type = ParseFractalType(GetOption(argc, argv, "fractal", "mandelbrot"));
+    job.imageSize = {std::stoul(argv[PARAM_WIDTH]), std::stoul(argv[PARAM_HEIGHT])};
+    job.viewport = GetDefaultViewport(job.type);
+    job.maxIterations = std::stoul(argv[PARAM_MAX_ITERATIONS]);
+    job.layout = ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"));
+    job.tileSize = ParseSize(GetOption(argc, argv, "tile", "256x256"));
+
+    std::chrono::seconds const tileTimeout{std::stol(std::string{GetOption(argc, argv, "tile-timeout", "60")})};
+    auto const output{GetOption(argc, argv, "output", "Distributed.png")};
+
+    RenderCoordinator coordinator{std::move(workers), tileTimeout};
+
+    auto const stride{job.imageSize.width * GetChannels(job.layout)};
+    auto const image{BufferPool::GetDefault().Acquire(stride * job.imageSize.height)};
+
+    std::println("Rendering the {} fractal with size {}×{} in {}×{} tiles on {} workers", GetFractalName(job.type), job.imageSize.width, job.imageSize.height, job.tileSize.width, job.tileSize.height, coordinator.GetWorkerCount());
+
+    DistributedStatistics statistics;
+    TestSpeed(
+        [&]() -> void
+        {
+            statistics = coordinator.Render(
+                job,
+                [&](CompletedTile const & tile) -> void
+                {
+                    auto const rowSize{tile.view.size.width * GetChannels(job.layout)};
+
+                    for (std::size_t row{0}; row < tile.view.size.height; ++row)
+                    {
+                        std::memcpy(image.GetData() + (tile.position.y + row) * stride + tile.position.x * GetChannels(job.layout), tile.view.data + row * tile.view.stride, rowSize);
+                    }
+                }
+            );
+        }, "distributed render"
+    );
+
+    for (auto const & worker : statistics.workers)
+    {
+        std::println("{}: {} tiles, {} duplicates discarded{}", worker.address, worker.tiles, worker.discarded, worker.isLost ? ", lost" : "");
+    }
+
+    std::println("{} tiles retried, {} stolen, {} iterations", statistics.retries, statistics.steals, statistics.iterations);
+
+    WriteImage({image.GetData(), job.imageSize, stride, job.layout, &DEFAULT_PALETTE}, output);
+
+    return EXIT_SUCCESS;
+}
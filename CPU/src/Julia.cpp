@@ -3,6 +3,8 @@
 #include <oneapi/tbb.h>
 
 #include "JuliaGenerator.hpp"
+#include "CpuDispatch.hpp"
+#include "FractalCommand.hpp"
 #include "Utils.hpp"
 
 
@@ -21,17 +23,14 @@ auto main(int const argc, char const * const argv[]) -> int
     auto const grainSize{GetGrainSize(imageSize, numThreads)};
 
     std::println(
-        "Generating Julia fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height, numThreads
+        "Generating Julia fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads ({} kernels)", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height,
+        numThreads, GetInstructionSetName(GetActiveInstructionSet())
     );
 
-    JuliaGenerator juliaGenerator{imageSize, grainSize, maxIterations};
-    TestSpeed(
-        [&juliaGenerator]() -> void
-        {
-            juliaGenerator.Render();
-        }, "Julia fractal generation"
-    );
-    juliaGenerator.Save("Julia.png");
+    JuliaGenerator juliaGenerator{imageSize, grainSize, maxIterations, ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"))};
+    ConfigureFromArguments(juliaGenerator, argc, argv);
+
+    RenderFromArguments(juliaGenerator, argc, argv);
 
     return EXIT_SUCCESS;
 }
@@ -1,9 +1,18 @@
 #include "JuliaGenerator.hpp"
 
+#include "LaneKernels.hpp"
 
-JuliaGenerator::JuliaGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations) : FractalGenerator{imageSize, grainSize, TOP_LEFT, BOTTOM_RIGHT, maxIterations} { }
 
-auto JuliaGenerator::Generate(Point const & startPoint) const -> std::uint8_t
+JuliaGenerator::JuliaGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations, PixelLayout const layout) :
+    JuliaGenerator{imageSize, grainSize, {TOP_LEFT, BOTTOM_RIGHT}, maxIterations, layout} { }
+
+JuliaGenerator::JuliaGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t const maxIterations, PixelLayout const layout) :
+    JuliaGenerator{imageSize, grainSize, viewport, maxIterations, C_POINT, layout} { }
+
+JuliaGenerator::JuliaGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t const maxIterations, Point const & cPoint,
+    PixelLayout const layout) : FractalGenerator{imageSize, grainSize, viewport.topLeft, viewport.bottomRight, maxIterations, layout}, cPoint{cPoint} { }
+
+auto JuliaGenerator::Iterate(Point const & startPoint) const -> std::size_t
 {
     auto point{startPoint};
 
@@ -11,11 +20,26 @@ auto JuliaGenerator::Generate(Point const & startPoint) const -> std::uint8_t
     {
         if (std::abs(point) > RADIUS)
         {
-            return static_cast<std::uint8_t>(MAX_COLOR * std::log(iteration + 1) / logMaxIterations);
+            return iteration;
         }
 
-        point = point * point + C_POINT;
+        point = point * point + cPoint;
     }
 
-    return 0;
+    return maxIterations;
+}
+
+auto JuliaGenerator::GetName() const -> std::string_view
+{
+    return "Julia";
+}
+
+auto JuliaGenerator::HasLaneKernel() const -> bool
+{
+    return true;
+}
+
+auto JuliaGenerator::IterateLanes(std::span<Point const> const startPoints, std::span<std::size_t> const iterations) const -> void
+{
+    IterateQuadraticLanes(startPoints, iterations, maxIterations, RADIUS, false, &cPoint);
 }
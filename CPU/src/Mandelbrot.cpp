@@ -3,6 +3,8 @@
 #include <oneapi/tbb.h>
 
 #include "MandelbrotGenerator.hpp"
+#include "CpuDispatch.hpp"
+#include "FractalCommand.hpp"
 #include "Utils.hpp"
 
 
@@ -21,17 +23,14 @@ auto main(int const argc, char const * const argv[]) -> int
     auto const grainSize{GetGrainSize(imageSize, numThreads)};
 
     std::println(
-        "Generating Mandelbrot fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height, numThreads
+        "Generating Mandelbrot fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads ({} kernels)", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height,
+        numThreads, GetInstructionSetName(GetActiveInstructionSet())
     );
 
-    MandelbrotGenerator mandelbrotGenerator{imageSize, grainSize, maxIterations};
-    TestSpeed(
-        [&mandelbrotGenerator]() -> void
-        {
-            mandelbrotGenerator.Render();
-        }, "Mandelbrot fractal generation"
-    );
-    mandelbrotGenerator.Save("Mandelbrot.png");
+    MandelbrotGenerator mandelbrotGenerator{imageSize, grainSize, maxIterations, ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"))};
+    ConfigureFromArguments(mandelbrotGenerator, argc, argv);
+
+    RenderFromArguments(mandelbrotGenerator, argc, argv);
 
     return EXIT_SUCCESS;
 }
@@ -1,9 +1,15 @@
 #include "MandelbrotGenerator.hpp"
 
+#include "LaneKernels.hpp"
 
-MandelbrotGenerator::MandelbrotGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations) : FractalGenerator{imageSize, grainSize, TOP_LEFT, BOTTOM_RIGHT, maxIterations} { }
 
-auto MandelbrotGenerator::Generate(Point const & startPoint) const -> std::uint8_t
+MandelbrotGenerator::MandelbrotGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations, PixelLayout const layout) :
+    MandelbrotGenerator{imageSize, grainSize, {TOP_LEFT, BOTTOM_RIGHT}, maxIterations, layout} { }
+
+MandelbrotGenerator::MandelbrotGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t const maxIterations, PixelLayout const layout) :
+    FractalGenerator{imageSize, grainSize, viewport.topLeft, viewport.bottomRight, maxIterations, layout} { }
+
+auto MandelbrotGenerator::Iterate(Point const & startPoint) const -> std::size_t
 {
     Point point{0.0, 0.0};
 
@@ -11,11 +17,26 @@ auto MandelbrotGenerator::Generate(Point const & startPoint) const -> std::uint8
     {
         if (std::abs(point) > RADIUS)
         {
-            return static_cast<std::uint8_t>(MAX_COLOR * std::log(iteration + 1) / logMaxIterations);
+            return iteration;
         }
 
         point = point * point + startPoint;
     }
 
-    return 0;
+    return maxIterations;
+}
+
+auto MandelbrotGenerator::GetName() const -> std::string_view
+{
+    return "Mandelbrot";
+}
+
+auto MandelbrotGenerator::HasLaneKernel() const -> bool
+{
+    return true;
+}
+
+auto MandelbrotGenerator::IterateLanes(std::span<Point const> const startPoints, std::span<std::size_t> const iterations) const -> void
+{
+    IterateQuadraticLanes(startPoints, iterations, maxIterations, RADIUS, false);
 }
@@ -0,0 +1,50 @@
+#include <array>
+#include <format>
+#include <print>
+#include <string>
+
+#include "TilePyramid.hpp"
+#include "Utils.hpp"
+
+
+enum PyramidArguments : std::uint8_t
+{
+    PARAM_FRACTAL   = 0x01,
+    PARAM_MAX_LEVEL = 0x02,
+};
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 4> OPTIONS{"scheme", "format", "output", "layout"};
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    CheckParameters(argc, argv, OPTIONS, "<fractal> <max_level> <max_iterations> [--scheme=xyz|dzi] [--format=png|qoi|bmp|ppm] [--output=<directory>] [--layout=rgb|bgr|rgba|bgra|indexed]");
+
+    auto const type{ParseFractalType(argv[PARAM_FRACTAL])};
+    std::size_t const maxLevel{std::stoul(argv[PARAM_MAX_LEVEL])};
+    std::size_t const maxIterations{std::stoul(argv[PARAM_MAX_ITERATIONS])};
+
+    auto const scheme{ParsePyramidScheme(GetOption(argc, argv, "scheme", "xyz"))};
+    auto const format{GetOption(argc, argv, "format", "png")};
+    auto const layout{ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"))};
+    std::string const directory{GetOption(argc, argv, "output", std::format("{}_tiles", GetFractalName(type)))};
+
+    std::println(
+        "Generating {} tile pyramid with levels 0..{} of {}×{} tiles using {} iterations into {}", GetFractalName(type), maxLevel, TilePyramid::TILE_SIZE, TilePyramid::TILE_SIZE, maxIterations,
+        directory
+    );
+
+    TilePyramid pyramid{type, maxLevel, maxIterations, layout};
+    TestSpeed(
+        [&]() -> void
+        {
+            pyramid.Generate(directory, scheme, format);
+        }, "tile pyramid generation"
+    );
+
+    return EXIT_SUCCESS;
+}
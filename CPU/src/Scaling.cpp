@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <print>
+#include <string>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+#include "BenchmarkTools.hpp"
+#include "FractalFactory.hpp"
+#include "Utils.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 10> OPTIONS{"fractal", "size", "iterations", "threads", "modes", "partitioning", "format", "warmups", "repetitions", "csv"};
+
+    struct ScalingRow
+    {
+        std::string mode;
+        int threads;
+        Size imageSize;
+        std::uint64_t iterations;
+        Statistics render;
+        Statistics save;
+    };
+
+    auto GetDefaultThreadCounts(int const maxThreads) -> std::vector<int>
+    {
+        std::vector<int> counts;
+
+        for (auto count{1}; count < maxThreads; count *= 2)
+        {
+            counts.push_back(count);
+        }
+
+        counts.push_back(maxThreads);
+
+        return counts;
+    }
+
+    auto GetWorkloadSize(Size const & baseSize, std::string_view const mode, int const threads) -> Size
+    {
+        if (mode == "strong")
+        {
+            return baseSize;
+        }
+
+        if (mode == "weak")
+        {
+            auto const scale{std::sqrt(static_cast<double>(threads))};
+
+            return {static_cast<std::size_t>(std::lround(baseSize.width * scale)), static_cast<std::size_t>(std::lround(baseSize.height * scale))};
+        }
+
+        throw std::invalid_argument(std::format("Unknown scaling mode {}.", mode));
+    }
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    CheckParameters(
+        argc, argv, OPTIONS,
+        "[--fractal=mandelbrot|julia|cosine|tricorn] [--size=<width>x<height>] [--iterations=<count>] [--threads=1,2,4,...] [--modes=strong,weak] [--partitioning=affinity|balanced|longest] "
+        "[--format=qoi|png|bmp|ppm] [--warmups=<count>] [--repetitions=<count>] [--csv=<file>]", 1U
+    );
+
+    auto const type{ParseFractalType(GetOption(argc, argv, "fractal", "mandelbrot"))};
+    auto const baseSize{ParseSize(GetOption(argc, argv, "size", "1920x1080"))};
+    std::size_t const maxIterations{std::stoul(std::string{GetOption(argc, argv, "iterations", "256")})};
+    auto const modes{SplitList(GetOption(argc, argv, "modes", "strong,weak"))};
+    auto const partitioning{ParsePartitioning(GetOption(argc, argv, "partitioning", "affinity"))};
+    auto const format{GetOption(argc, argv, "format", "qoi")};
+    std::size_t const warmups{std::stoul(std::string{GetOption(argc, argv, "warmups", "1")})};
+    std::size_t const repetitions{std::stoul(std::string{GetOption(argc, argv, "repetitions", "3")})};
+    std::string const csvPath{GetOption(argc, argv, "csv", "")};
+
+    std::vector<int> threadCounts;
+
+    if (auto const threadList{GetOption(argc, argv, "threads", "")}; threadList.empty())
+    {
+        threadCounts = GetDefaultThreadCounts(oneapi::tbb::info::default_concurrency());
+    }
+    else
+    {
+        for (auto const count : SplitList(threadList))
+        {
+            threadCounts.push_back(std::stoi(std::string{count}));
+        }
+    }
+
+    auto const savePath{(std::filesystem::temp_directory_path() / std::format("scaling-{}.{}", GetFractalName(type), format)).string()};
+
+    std::vector<ScalingRow> rows;
+
+    for (auto const mode : modes)
+    {
+        for (auto const threads : threadCounts)
+        {
+            oneapi::tbb::global_control const limit{oneapi::tbb::global_control::max_allowed_parallelism, static_cast<std::size_t>(threads)};
+            oneapi::tbb::task_arena arena{threads};
+
+            auto const imageSize{GetWorkloadSize(baseSize, mode, threads)};
+
+            arena.execute(
+                [&]() -> void
+                {
+                    auto const generator{MakeFractalGenerator(type, imageSize, GetGrainSize(imageSize, threads), GetDefaultViewport(type), maxIterations)};
+                    generator->SetPartitioning(partitioning);
+
+                    auto const render{Measure([&generator]() -> void { generator->Render(); }, warmups, repetitions)};
+                    auto const save{Measure([&generator, &savePath]() -> void { generator->Save(savePath); }, warmups, repetitions)};
+
+                    rows.push_back({std::string{mode}, threads, imageSize, generator->CountIterations(), render, save});
+                }
+            );
+
+            std::println(stderr, "{} scaling: {} threads done", mode, threads);
+        }
+    }
+
+    std::filesystem::remove(savePath);
+
+    std::string table{"mode,fractal,threads,width,height,iterations,render_median_ms,render_mad_ms,save_median_ms,save_mad_ms,render_fraction,speedup,efficiency\n"};
+
+    for (auto const & row : rows)
+    {
+        auto const & reference{*std::ranges::find(rows, row.mode, &ScalingRow::mode)};
+
+        // Throughput in iterations per millisecond keeps the weak scaling numbers honest when the scaled size rounds
+        auto const throughput{static_cast<double>(row.iterations) / row.render.median};
+        auto const referenceThroughput{static_cast<double>(reference.iterations) / reference.render.median};
+        auto const speedup{throughput / referenceThroughput};
+        auto const efficiency{speedup / (static_cast<double>(row.threads) / reference.threads)};
+        auto const renderFraction{row.render.median / (row.render.median + row.save.median)};
+
+        table += std::format(
+            "{},{},{},{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.4f},{:.4f},{:.4f}\n", row.mode, GetFractalName(type), row.threads, row.imageSize.width, row.imageSize.height, row.iterations,
+            row.render.median, row.render.medianAbsoluteDeviation, row.save.median, row.save.medianAbsoluteDeviation, renderFraction, speedup, efficiency
+        );
+    }
+
+    std::print("{}", table);
+
+    if (!csvPath.empty())
+    {
+        std::ofstream{csvPath} << table;
+    }
+
+    return EXIT_SUCCESS;
+}
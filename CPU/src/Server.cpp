@@ -0,0 +1,79 @@
+#include <array>
+#include <csignal>
+#include <print>
+
+#include "CpuDispatch.hpp"
+#include "DistributedRender.hpp"
+#include "Metrics.hpp"
+#include "RenderServer.hpp"
+#include "Utils.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 11> OPTIONS{"socket", "port", "max-requests", "metrics-file", "metrics-interval", "threads", "numa-node", "core-type", "pin", "worker", "bind"};
+    constexpr std::string_view USAGE{"[--socket=<path>] [--port=<port>] [--max-requests=<count>] [--metrics-file=<path>] [--metrics-interval=<seconds>] [--threads=<count>] [--numa-node=<id>] [--core-type=any|performance|efficient] [--pin]\n"
+        "       --worker [--bind=<address>] [--port=9100] [--threads=<count>] [--numa-node=<id>] [--core-type=any|performance|efficient] [--pin]"};
+
+    RenderServer * activeServer{nullptr};
+    RenderWorker * activeWorker{nullptr};
+
+    auto HandleSignal(int const signal) -> void
+    {
+        static_cast<void>(signal);
+
+        if (activeServer != nullptr)
+        {
+            activeServer->Stop();
+        }
+
+        if (activeWorker != nullptr)
+        {
+            activeWorker->Stop();
+        }
+    }
+
+    // Renders the tiles that coordinators send, see Distribute
+    auto RunWorker(int const argc, char const * const argv[]) -> void
+    {
+        RenderWorker worker{GetWorkerOptions(argc, argv)};
+
+        activeWorker = &worker;
+
+        std::println("Rendering tiles on {} with {} threads ({} kernels)", worker.GetAddress(), worker.GetConcurrency(), GetInstructionSetName(GetActiveInstructionSet()));
+
+        worker.Run();
+
+        activeWorker = nullptr;
+        std::println("Worker stopped");
+    }
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    CheckParameters(argc, argv, OPTIONS, USAGE, 1U);
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+
+    if (HasFlag(argc, argv, "worker"))
+    {
+        RunWorker(argc, argv);
+        return EXIT_SUCCESS;
+    }
+
+    RenderServer server{GetServerOptions(argc, argv)};
+    auto const metricsDump{StartMetricsDump(argc, argv)};
+
+    activeServer = &server;
+
+    std::println("Serving fractal renders on {} with {} threads ({} kernels)", server.GetAddress(), server.GetConcurrency(), GetInstructionSetName(GetActiveInstructionSet()));
+
+    server.Run();
+
+    activeServer = nullptr;
+    std::println("Server stopped");
+
+    return EXIT_SUCCESS;
+}
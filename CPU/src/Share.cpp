@@ -0,0 +1,138 @@
+#include <array>
+#include <chrono>
+#include <print>
+#include <string>
+#include <thread>
+
+#include <oneapi/tbb.h>
+
+#include "Affinity.hpp"
+#include "FractalFactory.hpp"
+#include "ImageWriter.hpp"
+#include "SharedFrame.hpp"
+#include "Utils.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 11> OPTIONS{"name", "fractal", "layout", "frames", "interval", "threads", "numa-node", "core-type", "pin", "watch", "output"};
+    constexpr std::string_view USAGE{"<width> <height> <max_iterations> [--name=/fractal-frame] [--fractal=mandelbrot|julia|cosine|tricorn] [--layout=rgb|bgr|rgba|bgra|indexed] [--frames=<count>] [--interval=<ms>] [--threads=<count>] [--numa-node=<id>] [--core-type=any|performance|efficient] [--pin]\n"
+        "       --watch [--name=/fractal-frame] [--frames=<count>] [--output=<file>]"};
+    constexpr std::string_view DEFAULT_NAME{"/fractal-frame"};
+    constexpr std::chrono::seconds WATCH_TIMEOUT{10};
+
+    auto ElapsedMilliseconds(std::chrono::steady_clock::time_point const start) -> double
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    auto Produce(int const argc, char const * const argv[]) -> void
+    {
+        Size const imageSize{std::stoul(argv[PARAM_WIDTH]), std::stoul(argv[PARAM_HEIGHT])};
+        std::size_t const maxIterations{std::stoul(argv[PARAM_MAX_ITERATIONS])};
+
+        auto const type{ParseFractalType(GetOption(argc, argv, "fractal", "mandelbrot"))};
+        auto const layout{ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"))};
+        std::size_t const frames{std::stoul(std::string{GetOption(argc, argv, "frames", "1")})};
+        std::chrono::milliseconds const interval{std::stol(std::string{GetOption(argc, argv, "interval", "0")})};
+
+        auto frame{SharedFrame::Create(std::string{GetOption(argc, argv, "name", DEFAULT_NAME)}, imageSize, layout)};
+        auto const generator{
+            MakeFractalGenerator(type, imageSize, GetGrainSize(imageSize, oneapi::tbb::info::default_concurrency()), GetDefaultViewport(type), maxIterations, layout)
+        };
+
+        generator->SetArenaOptions(GetArenaOptions(argc, argv));
+
+        std::println("Rendering {} frames of the {} fractal with size {}×{} into the shared memory segment {}", frames, GetFractalName(type), imageSize.width, imageSize.height, frame.GetName());
+
+        for (std::size_t index{0}; index < frames; ++index)
+        {
+            // Also gives readers the time to map the segment before the first frame
+            std::this_thread::sleep_for(interval);
+
+            auto const start{std::chrono::steady_clock::now()};
+            frame.Render(*generator);
+
+            std::println("Frame {} rendered in {:.1f} ms", index + 1U, ElapsedMilliseconds(start));
+        }
+    }
+
+    auto Watch(int const argc, char const * const argv[]) -> int
+    {
+        auto const frame{SharedFrame::Open(std::string{GetOption(argc, argv, "name", DEFAULT_NAME)})};
+        auto const & header{frame.GetHeader()};
+        std::size_t const frames{std::stoul(std::string{GetOption(argc, argv, "frames", "1")})};
+
+        std::println("Watching {} with size {}×{} in {} tiles", frame.GetName(), header.width, header.height, frame.GetTileCount());
+
+        auto events{header.events.load(std::memory_order_acquire)};
+        auto lastSequence{header.sequence.load(std::memory_order_acquire)};
+        auto frameStart{std::chrono::steady_clock::now()};
+        double firstTile{0.0};
+        auto isFirstTileSeen{false};
+
+        for (std::size_t completed{0}; completed < frames; )
+        {
+            auto const current{frame.WaitForEvents(events, WATCH_TIMEOUT)};
+
+            if (current == events)
+            {
+                std::println(stderr, "No update of {} within {} s.", frame.GetName(), WATCH_TIMEOUT.count());
+                return EXIT_FAILURE;
+            }
+
+            events = current;
+
+            if (auto const sequence{header.sequence.load(std::memory_order_acquire)}; sequence != lastSequence)
+            {
+                lastSequence = sequence;
+
+                if (sequence % 2U == 1U)
+                {
+                    frameStart = std::chrono::steady_clock::now();
+                    isFirstTileSeen = false;
+                }
+                else
+                {
+                    ++completed;
+                    std::println(
+                        "Frame {} ({}): {} of {} tiles ready, the first after {:.1f} ms and the last after {:.1f} ms", sequence / 2U, frame.IsComplete() ? "complete" : "partial",
+                        frame.CountReadyTiles(), frame.GetTileCount(), firstTile, ElapsedMilliseconds(frameStart)
+                    );
+                    continue;
+                }
+            }
+
+            if (!isFirstTileSeen && frame.CountReadyTiles() > 0U)
+            {
+                isFirstTileSeen = true;
+                firstTile = ElapsedMilliseconds(frameStart);
+            }
+        }
+
+        // Encoded straight from the shared pixels
+        if (auto const output{GetOption(argc, argv, "output", "")}; !output.empty())
+        {
+            WriteImage(frame.GetView(), output);
+        }
+
+        return EXIT_SUCCESS;
+    }
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    auto const isWatching{HasFlag(argc, argv, "watch")};
+
+    CheckParameters(argc, argv, OPTIONS, USAGE, isWatching ? 1U : ARGS_COUNT);
+
+    if (isWatching)
+    {
+        return Watch(argc, argv);
+    }
+
+    Produce(argc, argv);
+
+    return EXIT_SUCCESS;
+}
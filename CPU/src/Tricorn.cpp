@@ -3,6 +3,8 @@
 #include <oneapi/tbb.h>
 
 #include "TricornGenerator.hpp"
+#include "CpuDispatch.hpp"
+#include "FractalCommand.hpp"
 #include "Utils.hpp"
 
 
@@ -21,17 +23,14 @@ auto main(int const argc, char const * const argv[]) -> int
     auto const grainSize{GetGrainSize(imageSize, numThreads)};
 
     std::println(
-        "Generating Tricorn fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height, numThreads
+        "Generating Tricorn fractal image with size {}×{} using {} iterations and grainsize {}×{} on {} threads ({} kernels)", imageWidth, imageHeight, maxIterations, grainSize.width, grainSize.height,
+        numThreads, GetInstructionSetName(GetActiveInstructionSet())
     );
 
-    TricornGenerator tricornGenerator{imageSize, grainSize, maxIterations};
-    TestSpeed(
-        [&tricornGenerator]() -> void
-        {
-            tricornGenerator.Render();
-        }, "Tricorn fractal generation"
-    );
-    tricornGenerator.Save("Tricorn.png");
+    TricornGenerator tricornGenerator{imageSize, grainSize, maxIterations, ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"))};
+    ConfigureFromArguments(tricornGenerator, argc, argv);
+
+    RenderFromArguments(tricornGenerator, argc, argv);
 
     return EXIT_SUCCESS;
 }
@@ -1,9 +1,15 @@
 #include "TricornGenerator.hpp"
 
+#include "LaneKernels.hpp"
 
-TricornGenerator::TricornGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations) : FractalGenerator{imageSize, grainSize, TOP_LEFT, BOTTOM_RIGHT, maxIterations} { }
 
-auto TricornGenerator::Generate(Point const & startPoint) const -> std::uint8_t
+TricornGenerator::TricornGenerator(Size const & imageSize, Size const & grainSize, std::size_t const maxIterations, PixelLayout const layout) :
+    TricornGenerator{imageSize, grainSize, {TOP_LEFT, BOTTOM_RIGHT}, maxIterations, layout} { }
+
+TricornGenerator::TricornGenerator(Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t const maxIterations, PixelLayout const layout) :
+    FractalGenerator{imageSize, grainSize, viewport.topLeft, viewport.bottomRight, maxIterations, layout} { }
+
+auto TricornGenerator::Iterate(Point const & startPoint) const -> std::size_t
 {
     Point point{0.0, 0.0};
 
@@ -11,12 +17,27 @@ auto TricornGenerator::Generate(Point const & startPoint) const -> std::uint8_t
     {
         if (std::abs(point) > RADIUS)
         {
-            return static_cast<std::uint8_t>(MAX_COLOR * std::log(iteration + 1) / logMaxIterations);
+            return iteration;
         }
 
         auto const conjugate = std::conj(point);
         point = conjugate * conjugate + startPoint;
     }
 
-    return 0;
+    return maxIterations;
+}
+
+auto TricornGenerator::GetName() const -> std::string_view
+{
+    return "Tricorn";
+}
+
+auto TricornGenerator::HasLaneKernel() const -> bool
+{
+    return true;
+}
+
+auto TricornGenerator::IterateLanes(std::span<Point const> const startPoints, std::span<std::size_t> const iterations) const -> void
+{
+    IterateQuadraticLanes(startPoints, iterations, maxIterations, RADIUS, true);
 }
@@ -0,0 +1,149 @@
+#include <array>
+#include <filesystem>
+#include <format>
+#include <print>
+#include <string>
+#include <vector>
+
+#include <oneapi/tbb.h>
+
+#include "BenchmarkTools.hpp"
+#include "FractalFactory.hpp"
+#include "LaneKernels.hpp"
+#include "Tuning.hpp"
+#include "Utils.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 8> OPTIONS{"fractal", "size", "iterations", "layout", "warmups", "repetitions", "passes", "cache"};
+
+    auto DescribeConfig(TuningConfig const & config) -> std::string
+    {
+        return std::format(
+            "grain {}×{}, {} partitioning, SIMD width {}, {} threads", config.grainSize.width, config.grainSize.height, GetPartitioningName(config.partitioning), config.simdWidth,
+            config.threads
+        );
+    }
+
+    auto GetGrainCandidates(Size const & imageSize, Size const & defaultGrain) -> std::vector<Size>
+    {
+        std::vector<Size> grains{defaultGrain};
+
+        for (auto const side : {16UZ, 32UZ, 64UZ, 128UZ, 256UZ})
+        {
+            grains.push_back({side, side});
+        }
+
+        for (auto const rows : {1UZ, 4UZ, 16UZ})
+        {
+            grains.push_back({imageSize.width, rows});
+        }
+
+        return grains;
+    }
+
+    auto GetThreadCandidates(int const maxThreads) -> std::vector<int>
+    {
+        std::vector<int> threads;
+
+        for (auto count{1}; count < maxThreads; count *= 2)
+        {
+            threads.push_back(count);
+        }
+
+        threads.push_back(maxThreads);
+
+        return threads;
+    }
+}
+
+
+auto main(int const argc, char const * const argv[]) -> int
+{
+    CheckParameters(
+        argc, argv, OPTIONS,
+        "[--fractal=mandelbrot|julia|cosine|tricorn] [--size=<width>x<height>] [--iterations=<count>] [--layout=rgb|bgr|rgba|bgra|indexed] [--warmups=<count>] "
+        "[--repetitions=<count>] [--passes=<count>] [--cache=<file>]", 1U
+    );
+
+    auto const type{ParseFractalType(GetOption(argc, argv, "fractal", "mandelbrot"))};
+    auto const imageSize{ParseSize(GetOption(argc, argv, "size", "1920x1080"))};
+    std::size_t const maxIterations{std::stoul(std::string{GetOption(argc, argv, "iterations", "256")})};
+    auto const layout{ParsePixelLayout(GetOption(argc, argv, "layout", "rgb"))};
+    std::size_t const warmups{std::stoul(std::string{GetOption(argc, argv, "warmups", "1")})};
+    std::size_t const repetitions{std::stoul(std::string{GetOption(argc, argv, "repetitions", "3")})};
+    std::size_t const passes{std::stoul(std::string{GetOption(argc, argv, "passes", "2")})};
+    std::filesystem::path const cachePath{GetOption(argc, argv, "cache", "")};
+
+    auto const maxThreads{oneapi::tbb::info::default_concurrency()};
+    auto const viewport{GetDefaultViewport(type)};
+
+    auto const evaluate{
+        [&](TuningConfig const & config) -> double
+        {
+            auto const generator{MakeFractalGenerator(type, imageSize, config.grainSize, viewport, maxIterations, layout)};
+            generator->ApplyTuning(config);
+
+            auto const milliseconds{Measure([&generator]() -> void { generator->Render(); }, warmups, repetitions).median};
+            std::println("{:>10.3f} ms  {}", milliseconds, DescribeConfig(config));
+
+            return milliseconds;
+        }
+    };
+
+    // Without a lane kernel the SIMD width changes nothing, so it stays at one instead of caching whichever width the noise favoured. With one, the search starts from the default width
+    auto const probe{MakeFractalGenerator(type, imageSize, GetGrainSize(imageSize, maxThreads), viewport, maxIterations, layout)};
+    auto const hasLaneKernel{probe->HasLaneKernel()};
+
+    TuningConfig best{GetGrainSize(imageSize, maxThreads), Partitioning::AFFINITY, hasLaneKernel ? probe->GetSimdWidth() : 1U, maxThreads};
+    auto bestMilliseconds{evaluate(best)};
+
+    // Coordinate descent: one parameter is varied at a time around the best configuration found so far
+    auto const tryCandidate{
+        [&](TuningConfig const & candidate) -> void
+        {
+            if (auto const milliseconds{evaluate(candidate)}; milliseconds < bestMilliseconds)
+            {
+                best = candidate;
+                bestMilliseconds = milliseconds;
+            }
+        }
+    };
+
+    for (std::size_t pass{0}; pass < passes; ++pass)
+    {
+        std::println("Pass {} of {}, best so far {:.3f} ms with {}", pass + 1U, passes, bestMilliseconds, DescribeConfig(best));
+
+        for (auto const grain : GetGrainCandidates(imageSize, GetGrainSize(imageSize, maxThreads)))
+        {
+            tryCandidate({grain, best.partitioning, best.simdWidth, best.threads});
+        }
+
+        for (auto const partitioning : {Partitioning::AFFINITY, Partitioning::AUTO, Partitioning::STATIC, Partitioning::BALANCED, Partitioning::LONGEST_FIRST, Partitioning::HILBERT})
+        {
+            tryCandidate({best.grainSize, partitioning, best.simdWidth, best.threads});
+        }
+
+        if (hasLaneKernel)
+        {
+            for (auto const simdWidth : SIMD_WIDTHS)
+            {
+                tryCandidate({best.grainSize, best.partitioning, simdWidth, best.threads});
+            }
+        }
+
+        for (auto const threads : GetThreadCandidates(maxThreads))
+        {
+            tryCandidate({best.grainSize, best.partitioning, best.simdWidth, threads});
+        }
+    }
+
+    auto const key{MakeFractalGenerator(type, imageSize, best.grainSize, viewport, maxIterations, layout)->GetTuningKey()};
+    auto const path{cachePath.empty() ? GetTuningCachePath() : cachePath};
+    SaveTuningEntry(path, {key, best, bestMilliseconds});
+
+    std::println("Best: {:.3f} ms with {}, saved to {}", bestMilliseconds, DescribeConfig(best), path.string());
+
+    return EXIT_SUCCESS;
+}
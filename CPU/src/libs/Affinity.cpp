@@ -0,0 +1,314 @@
+#include "Affinity.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "Utils.hpp"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+
+namespace
+{
+    constexpr std::array<std::string_view, CORE_TYPE_COUNT> CORE_TYPE_NAMES{"any", "performance", "efficient"};
+
+    auto ReadFirstLine(std::string const & path) -> std::string
+    {
+        std::ifstream file{path};
+        std::string line;
+        std::getline(file, line);
+
+        return line;
+    }
+
+#ifdef __linux__
+    // Read once before any arena changes the affinity of the main thread
+    auto GetAllowedCpus() -> std::vector<int> const &
+    {
+        static auto const allowed{
+            []() -> std::vector<int>
+            {
+                cpu_set_t mask;
+                CPU_ZERO(&mask);
+                sched_getaffinity(0, sizeof(mask), &mask);
+
+                std::vector<int> cpus;
+
+                for (int cpu{0}; cpu < CPU_SETSIZE; ++cpu)
+                {
+                    if (CPU_ISSET(cpu, &mask))
+                    {
+                        cpus.push_back(cpu);
+                    }
+                }
+
+                return cpus;
+            }()
+        };
+
+        return allowed;
+    }
+
+    // Intel hybrid parts expose one PMU per core type, other hybrid designs only differ in their relative capacity
+    auto GetCoreTypes() -> std::vector<CoreType> const &
+    {
+        static auto const coreTypes{
+            []() -> std::vector<CoreType>
+            {
+                auto const & allowed{GetAllowedCpus()};
+
+                // Without an allowed CPU there is nothing to classify, every core then reads as a performance core
+                if (allowed.empty())
+                {
+                    return {};
+                }
+
+                std::vector<CoreType> types(static_cast<std::size_t>(allowed.back()) + 1U, CoreType::PERFORMANCE);
+
+                if (auto const efficient{ReadFirstLine("/sys/devices/cpu_atom/cpus")}; !efficient.empty())
+                {
+                    for (auto const cpu : ParseCpuList(efficient))
+                    {
+                        if (static_cast<std::size_t>(cpu) < types.size())
+                        {
+                            types[static_cast<std::size_t>(cpu)] = CoreType::EFFICIENT;
+                        }
+                    }
+
+                    return types;
+                }
+
+                std::vector<int> capacities(types.size(), 0);
+
+                for (auto const cpu : allowed)
+                {
+                    auto const capacity{ReadFirstLine(std::format("/sys/devices/system/cpu/cpu{}/cpu_capacity", cpu))};
+                    std::from_chars(capacity.data(), capacity.data() + capacity.size(), capacities[static_cast<std::size_t>(cpu)]);
+                }
+
+                auto const maxCapacity{std::ranges::max(capacities)};
+
+                for (auto const cpu : allowed)
+                {
+                    if (capacities[static_cast<std::size_t>(cpu)] < maxCapacity)
+                    {
+                        types[static_cast<std::size_t>(cpu)] = CoreType::EFFICIENT;
+                    }
+                }
+
+                return types;
+            }()
+        };
+
+        return coreTypes;
+    }
+
+    auto MakeMask(std::vector<int> const & cpus) -> cpu_set_t
+    {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+
+        for (auto const cpu : cpus)
+        {
+            CPU_SET(cpu, &mask);
+        }
+
+        return mask;
+    }
+
+    // A stack, since a thread can enter a constrained arena from inside another one
+    thread_local std::vector<cpu_set_t> savedMasks;
+#endif
+}
+
+
+auto ArenaOptions::IsConstrained() const -> bool
+{
+    return numaNode >= 0 || coreType != CoreType::ANY || isPinned;
+}
+
+auto ParseCoreType(std::string_view const name) -> CoreType
+{
+    if (auto const found{std::ranges::find(CORE_TYPE_NAMES, name)}; found != CORE_TYPE_NAMES.end())
+    {
+        return static_cast<CoreType>(found - CORE_TYPE_NAMES.begin());
+    }
+
+    throw std::invalid_argument(std::format("Unknown core type {}.", name));
+}
+
+auto GetCoreTypeName(CoreType const coreType) -> std::string_view
+{
+    return CORE_TYPE_NAMES[static_cast<std::size_t>(coreType)];
+}
+
+auto ParseCpuList(std::string_view const list) -> std::vector<int>
+{
+    std::vector<int> cpus;
+
+    for (auto const range : SplitList(list))
+    {
+        auto const dash{range.find('-')};
+        auto const first{std::stoi(std::string{range.substr(0U, dash)})};
+        auto const last{dash == std::string_view::npos ? first : std::stoi(std::string{range.substr(dash + 1U)})};
+
+        for (auto cpu{first}; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+auto GetArenaCpus(ArenaOptions const & options) -> std::vector<int>
+{
+#ifdef __linux__
+    auto cpus{GetAllowedCpus()};
+
+    if (options.numaNode >= 0)
+    {
+        auto const nodeList{ReadFirstLine(std::format("/sys/devices/system/node/node{}/cpulist", options.numaNode))};
+
+        if (nodeList.empty())
+        {
+            throw std::invalid_argument(std::format("Unknown NUMA node {}.", options.numaNode));
+        }
+
+        auto nodeCpus{ParseCpuList(nodeList)};
+        std::ranges::sort(nodeCpus);
+
+        std::vector<int> common;
+        std::ranges::set_intersection(cpus, nodeCpus, std::back_inserter(common));
+        cpus = std::move(common);
+    }
+
+    if (options.coreType != CoreType::ANY)
+    {
+        std::erase_if(cpus, [&options](int const cpu) { return GetCoreType(cpu) != options.coreType; });
+    }
+
+    if (cpus.empty())
+    {
+        throw std::invalid_argument(std::format("No allowed CPU matches the {} core type{}.", GetCoreTypeName(options.coreType), options.numaNode >= 0 ? std::format(" on NUMA node {}", options.numaNode) : ""));
+    }
+
+    return cpus;
+#else
+    static_cast<void>(options);
+
+    return {};
+#endif
+}
+
+auto GetCoreType(int const cpu) -> CoreType
+{
+#ifdef __linux__
+    auto const & types{GetCoreTypes()};
+
+    return cpu >= 0 && static_cast<std::size_t>(cpu) < types.size() ? types[static_cast<std::size_t>(cpu)] : CoreType::PERFORMANCE;
+#else
+    static_cast<void>(cpu);
+
+    return CoreType::PERFORMANCE;
+#endif
+}
+
+auto GetCurrentCoreType() -> CoreType
+{
+#ifdef __linux__
+    return GetCoreType(sched_getcpu());
+#else
+    return CoreType::PERFORMANCE;
+#endif
+}
+
+auto IsHybrid() -> bool
+{
+#ifdef __linux__
+    return std::ranges::find(GetCoreTypes(), CoreType::EFFICIENT) != GetCoreTypes().end();
+#else
+    return false;
+#endif
+}
+
+auto GetArenaOptions(int const argc, char const * const argv[]) -> ArenaOptions
+{
+    return {
+        std::stoi(std::string{GetOption(argc, argv, "threads", "0")}),
+        std::stoi(std::string{GetOption(argc, argv, "numa-node", "-1")}),
+        ParseCoreType(GetOption(argc, argv, "core-type", "any")),
+        HasFlag(argc, argv, "pin"),
+    };
+}
+
+ArenaPinning::ArenaPinning(oneapi::tbb::task_arena & arena, std::vector<int> cpus, bool const isPinned) : task_scheduler_observer{arena}, cpus{std::move(cpus)},
+    isPinned{isPinned}
+{
+    observe(true);
+}
+
+ArenaPinning::~ArenaPinning()
+{
+    observe(false);
+}
+
+auto ArenaPinning::on_scheduler_entry(bool const isWorker) -> void
+{
+    static_cast<void>(isWorker);
+
+#ifdef __linux__
+    if (cpus.empty())
+    {
+        return;
+    }
+
+    cpu_set_t previous;
+    sched_getaffinity(0, sizeof(previous), &previous);
+    savedMasks.push_back(previous);
+
+    // Slots are stable for the lifetime of the arena, so a pinned slot always lands on the same CPU
+    auto const slot{static_cast<std::size_t>(std::max(0, oneapi::tbb::this_task_arena::current_thread_index()))};
+    auto const mask{isPinned ? MakeMask({cpus[slot % cpus.size()]}) : MakeMask(cpus)};
+
+    sched_setaffinity(0, sizeof(mask), &mask);
+#endif
+}
+
+auto ArenaPinning::on_scheduler_exit(bool const isWorker) -> void
+{
+    static_cast<void>(isWorker);
+
+#ifdef __linux__
+    if (cpus.empty() || savedMasks.empty())
+    {
+        return;
+    }
+
+    sched_setaffinity(0, sizeof(savedMasks.back()), &savedMasks.back());
+    savedMasks.pop_back();
+#endif
+}
+
+// Platforms without a known topology report no CPUs, which leaves only the thread limit
+auto InitializeArena(oneapi::tbb::task_arena & arena, ArenaOptions const & options, std::optional<ArenaPinning> & pinning) -> void
+{
+    auto cpus{options.IsConstrained() ? GetArenaCpus(options) : std::vector<int>{}};
+    auto const available{cpus.empty() ? oneapi::tbb::info::default_concurrency() : static_cast<int>(cpus.size())};
+
+    arena.initialize(options.maxConcurrency > 0 ? std::min(options.maxConcurrency, available) : available);
+
+    if (!cpus.empty())
+    {
+        pinning.emplace(arena, std::move(cpus), options.isPinned);
+    }
+}
@@ -0,0 +1,313 @@
+#include "Animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <memory>
+#include <print>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <oneapi/tbb.h>
+
+#include "Metrics.hpp"
+#include "Palette.hpp"
+#include "Trace.hpp"
+
+
+namespace
+{
+    struct YUV
+    {
+        std::uint8_t luma;
+        std::uint8_t blueDifference;
+        std::uint8_t redDifference;
+    };
+
+    // BT.601 limited range, which is what encoders assume for Y4M input without a color range tag
+    auto MakeYUVPalette(Palette const & palette) -> std::array<YUV, 256>
+    {
+        std::array<YUV, 256> yuvPalette{};
+
+        std::ranges::transform(
+            palette, yuvPalette.begin(), [](Color const & color) -> YUV
+            {
+                auto const red{static_cast<float>(color.red)};
+                auto const green{static_cast<float>(color.green)};
+                auto const blue{static_cast<float>(color.blue)};
+
+                auto const luma{16.0F + (65.481F * red + 128.553F * green + 24.966F * blue) / 255.0F};
+                auto const blueDifference{128.0F + (-37.797F * red - 74.203F * green + 112.0F * blue) / 255.0F};
+                auto const redDifference{128.0F + (112.0F * red - 93.786F * green - 18.214F * blue) / 255.0F};
+
+                return {static_cast<std::uint8_t>(std::lround(luma)), static_cast<std::uint8_t>(std::lround(blueDifference)), static_cast<std::uint8_t>(std::lround(redDifference))};
+            }
+        );
+
+        return yuvPalette;
+    }
+
+    auto Lerp(float const from, float const to, float const amount) -> float
+    {
+        return from + (to - from) * amount;
+    }
+
+    auto Lerp(Point const & from, Point const & to, float const amount) -> Point
+    {
+        return from + (to - from) * amount;
+    }
+}
+
+
+auto ParseStreamFormat(std::string_view const name) -> StreamFormat
+{
+    if (name == "y4m")
+    {
+        return StreamFormat::Y4M;
+    }
+
+    if (name == "rgb")
+    {
+        return StreamFormat::RGB;
+    }
+
+    throw std::invalid_argument(std::format("Unknown stream format {}.", name));
+}
+
+auto LoadKeyframes(std::filesystem::path const & path) -> std::vector<Keyframe>
+{
+    std::ifstream file{path};
+
+    if (!file)
+    {
+        throw std::runtime_error(std::format("Could not open {}.", path.string()));
+    }
+
+    std::vector<Keyframe> keyframes;
+
+    std::size_t lineNumber{0};
+
+    for (std::string line; std::getline(file, line);)
+    {
+        ++lineNumber;
+        line = line.substr(0U, line.find('#'));
+
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+
+        std::istringstream fields{line};
+        Keyframe keyframe{0U, {}, 0.0F, 0U, JuliaGenerator::C_POINT};
+        float centerReal{};
+        float centerImag{};
+
+        if (!(fields >> keyframe.frame >> centerReal >> centerImag >> keyframe.width >> keyframe.maxIterations))
+        {
+            throw std::invalid_argument(std::format("Line {} of {} is not a keyframe.", lineNumber, path.string()));
+        }
+
+        // The zoom between keyframes is the ratio of their widths
+        if (!std::isfinite(keyframe.width) || keyframe.width <= 0.0F)
+        {
+            throw std::invalid_argument(std::format("The keyframe on line {} of {} needs a positive width.", lineNumber, path.string()));
+        }
+
+        keyframe.center = {centerReal, centerImag};
+
+        // The Julia point is optional but must be complete, and nothing may follow it
+        if (float juliaReal{}, juliaImag{}; fields >> std::ws && !fields.eof())
+        {
+            if (!(fields >> juliaReal >> juliaImag) || !(fields >> std::ws).eof())
+            {
+                throw std::invalid_argument(std::format("Line {} of {} has an incomplete Julia point or trailing text.", lineNumber, path.string()));
+            }
+
+            keyframe.juliaPoint = {juliaReal, juliaImag};
+        }
+
+        keyframes.push_back(keyframe);
+    }
+
+    return keyframes;
+}
+
+Animation::Animation(FractalType const type, Size const & frameSize, std::vector<Keyframe> keyframes) : type{type}, frameSize{frameSize},
+    grainSize{GetGrainSize(frameSize, oneapi::tbb::info::default_concurrency())}, keyframes{std::move(keyframes)}
+{
+    if (this->keyframes.empty())
+    {
+        throw std::invalid_argument("An animation needs at least one keyframe.");
+    }
+
+    if (!std::ranges::is_sorted(this->keyframes, {}, &Keyframe::frame))
+    {
+        throw std::invalid_argument("The keyframes must be in frame order.");
+    }
+}
+
+auto Animation::GetFrameCount() const -> std::size_t
+{
+    return keyframes.back().frame + 1U;
+}
+
+auto Animation::Interpolate(std::size_t const frame) const -> Keyframe
+{
+    auto const next{std::ranges::upper_bound(keyframes, frame, {}, &Keyframe::frame)};
+
+    if (next == keyframes.begin())
+    {
+        return keyframes.front();
+    }
+
+    if (next == keyframes.end())
+    {
+        return keyframes.back();
+    }
+
+    auto const & from{*std::prev(next)};
+    auto const & to{*next};
+    auto const amount{static_cast<float>(frame - from.frame) / static_cast<float>(to.frame - from.frame)};
+
+    // The zoom is interpolated geometrically so that it progresses at a constant visual speed
+    auto const width{from.width * std::pow(to.width / from.width, amount)};
+    auto const maxIterations{static_cast<std::size_t>(std::lround(Lerp(static_cast<float>(from.maxIterations), static_cast<float>(to.maxIterations), amount)))};
+
+    return {frame, Lerp(from.center, to.center, amount), width, maxIterations, Lerp(from.juliaPoint, to.juliaPoint, amount)};
+}
+
+auto Animation::Stream(std::FILE * const output, StreamFormat const format, std::size_t const framesPerSecond) const -> void
+{
+    using namespace oneapi::tbb;
+
+    if (format == StreamFormat::Y4M)
+    {
+        std::print(output, "YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C444\n", frameSize.width, frameSize.height, framesPerSecond);
+    }
+
+    std::size_t nextFrame{0};
+    auto const frameCount{GetFrameCount()};
+
+    auto const source{
+        [&](flow_control & control) -> FramePointer
+        {
+            if (nextFrame == frameCount)
+            {
+                control.stop();
+                return nullptr;
+            }
+
+            return std::make_shared<Frame>(nextFrame++);
+        }
+    };
+
+    auto const render{
+        [this](FramePointer const & frame) -> FramePointer
+        {
+            Metrics::GetDefault().RecordStage(Stage::QUEUE, std::chrono::steady_clock::now() - frame->queued);
+
+            Metrics::StageTimer const timer{Metrics::GetDefault(), Stage::RENDER};
+            RenderFrame(*frame);
+            return frame;
+        }
+    };
+
+    auto const colorize{
+        [this, format](FramePointer const & frame) -> FramePointer
+        {
+            Metrics::StageTimer const timer{Metrics::GetDefault(), Stage::COLORIZE};
+            ColorizeFrame(*frame, format);
+            return frame;
+        }
+    };
+
+    auto const write{
+        [output, format](FramePointer const & frame) -> void
+        {
+            TRACE_SCOPE("write frame");
+
+            Metrics::StageTimer const timer{Metrics::GetDefault(), Stage::ENCODE};
+
+            if (format == StreamFormat::Y4M)
+            {
+                std::fputs("FRAME\n", output);
+            }
+
+            if (std::fwrite(frame->pixels.GetData(), 1U, frame->pixels.GetSize(), output) != frame->pixels.GetSize())
+            {
+                throw std::runtime_error("Could not write the animation frame.");
+            }
+
+            Metrics::GetDefault().AddBytesWritten(frame->pixels.GetSize());
+        }
+    };
+
+    parallel_pipeline(
+        MAX_FRAMES_IN_FLIGHT,
+        make_filter<void, FramePointer>(filter_mode::serial_in_order, source) &
+        make_filter<FramePointer, FramePointer>(filter_mode::parallel, render) &
+        make_filter<FramePointer, FramePointer>(filter_mode::parallel, colorize) &
+        make_filter<FramePointer, void>(filter_mode::serial_in_order, write)
+    );
+
+    std::fflush(output);
+}
+
+auto Animation::RenderFrame(Frame & frame) const -> void
+{
+    TRACE_SCOPE("render frame");
+
+    auto const parameters{Interpolate(frame.index)};
+    auto const height{parameters.width * static_cast<float>(frameSize.height) / static_cast<float>(frameSize.width)};
+    Viewport const viewport{parameters.center + Point{-parameters.width / 2.0F, height / 2.0F}, parameters.center + Point{parameters.width / 2.0F, -height / 2.0F}};
+
+    frame.indices = BufferPool::GetDefault().Acquire(frameSize.width * frameSize.height);
+
+    auto const generator{MakeFractalGenerator(type, frameSize, grainSize, viewport, std::max(1UZ, parameters.maxIterations), PixelLayout::INDEXED, parameters.juliaPoint)};
+    generator->UseBuffer(frame.indices.GetData(), frameSize.width);
+    generator->Render();
+
+    Metrics::GetDefault().AddIterations(generator->GetRenderedIterations());
+}
+
+auto Animation::ColorizeFrame(Frame & frame, StreamFormat const format) const -> void
+{
+    using namespace oneapi::tbb;
+
+    TRACE_SCOPE("colorize frame");
+
+    static auto const YUV_PALETTE{MakeYUVPalette(DEFAULT_PALETTE)};
+
+    auto const pixelCount{frame.indices.GetSize()};
+    frame.pixels = BufferPool::GetDefault().Acquire(pixelCount * 3U);
+
+    auto const * const indices{frame.indices.GetData()};
+    auto * const pixels{frame.pixels.GetData()};
+
+    parallel_for(
+        blocked_range<std::size_t>{0U, pixelCount}, [&, &yuvPalette = YUV_PALETTE](auto const & range) -> void
+        {
+            for (auto pixel{range.begin()}; pixel < range.end(); ++pixel)
+            {
+                auto const value{indices[pixel]};
+
+                if (format == StreamFormat::Y4M)
+                {
+                    auto const & color{yuvPalette[value]};
+                    pixels[pixel] = color.luma;
+                    pixels[pixelCount + pixel] = color.blueDifference;
+                    pixels[2U * pixelCount + pixel] = color.redDifference;
+                }
+                else
+                {
+                    auto const & color{DEFAULT_PALETTE[value]};
+                    pixels[3U * pixel + 0U] = color.red;
+                    pixels[3U * pixel + 1U] = color.green;
+                    pixels[3U * pixel + 2U] = color.blue;
+                }
+            }
+        }
+    );
+}
@@ -0,0 +1,198 @@
+#include "BenchmarkTools.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <print>
+#include <stdexcept>
+
+
+namespace
+{
+    auto Median(std::vector<double> values) -> double
+    {
+        std::ranges::sort(values);
+
+        auto const middle{values.size() / 2U};
+
+        return values.size() % 2U == 0U ? (values[middle - 1U] + values[middle]) / 2.0 : values[middle];
+    }
+
+    auto EscapeJSON(std::string_view const text) -> std::string
+    {
+        std::string escaped;
+
+        for (auto const character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                escaped.push_back('\\');
+            }
+
+            escaped.push_back(character);
+        }
+
+        return escaped;
+    }
+}
+
+
+auto Summarize(std::vector<double> samples) -> Statistics
+{
+    if (samples.empty())
+    {
+        throw std::invalid_argument("Cannot summarize an empty set of samples.");
+    }
+
+    auto const count{static_cast<double>(samples.size())};
+    auto const mean{std::accumulate(samples.begin(), samples.end(), 0.0) / count};
+    auto const variance{std::accumulate(samples.begin(), samples.end(), 0.0, [mean](double const sum, double const sample) { return sum + (sample - mean) * (sample - mean); }) / count};
+    auto const median{Median(samples)};
+
+    std::vector<double> deviations(samples.size());
+    std::ranges::transform(samples, deviations.begin(), [median](double const sample) { return std::abs(sample - median); });
+
+    auto const [minimum, maximum]{std::ranges::minmax(samples)};
+
+    return {median, mean, std::sqrt(variance), Median(std::move(deviations)), minimum, maximum, samples.size()};
+}
+
+auto Measure(std::function<void()> const & function, std::size_t const warmups, std::size_t const repetitions) -> Statistics
+{
+    using namespace std::chrono;
+
+    for (std::size_t warmup{0}; warmup < warmups; ++warmup)
+    {
+        function();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+
+    for (std::size_t repetition{0}; repetition < std::max(1UZ, repetitions); ++repetition)
+    {
+        auto const start{steady_clock::now()};
+        function();
+        auto const stop{steady_clock::now()};
+
+        samples.push_back(duration<double, std::milli>(stop - start).count());
+    }
+
+    return Summarize(std::move(samples));
+}
+
+auto GetIterationsPerSecond(BenchmarkResult const & result) -> double
+{
+    return static_cast<double>(result.iterations) * 1000.0 / result.milliseconds.median;
+}
+
+auto GetPixelsPerSecond(BenchmarkResult const & result) -> double
+{
+    return static_cast<double>(result.pixels) * 1000.0 / result.milliseconds.median;
+}
+
+auto WriteBenchmarkJSON(std::vector<BenchmarkResult> const & results, std::filesystem::path const & path) -> void
+{
+    std::ofstream file{path};
+
+    if (!file)
+    {
+        throw std::runtime_error(std::format("Could not open {} for writing.", path.string()));
+    }
+
+    file << "{\n    \"results\": [\n";
+
+    for (std::size_t index{0}; index < results.size(); ++index)
+    {
+        auto const & result{results[index]};
+        auto const & time{result.milliseconds};
+
+        // One result per line, which keeps the baseline reader trivial and the files diff-friendly
+        file << std::format("        {{\"name\": \"{}\"", EscapeJSON(result.name));
+
+        for (auto const & [key, value] : result.parameters)
+        {
+            file << std::format(", \"{}\": \"{}\"", EscapeJSON(key), EscapeJSON(value));
+        }
+
+        file << std::format(
+            ", \"median_ms\": {:.6f}, \"mean_ms\": {:.6f}, \"stddev_ms\": {:.6f}, \"mad_ms\": {:.6f}, \"min_ms\": {:.6f}, \"max_ms\": {:.6f}, \"repetitions\": {}", time.median, time.mean,
+            time.standardDeviation, time.medianAbsoluteDeviation, time.minimum, time.maximum, time.repetitions
+        );
+        file << std::format(
+            ", \"iterations\": {}, \"pixels\": {}, \"iterations_per_second\": {:.1f}, \"pixels_per_second\": {:.1f}", result.iterations, result.pixels, GetIterationsPerSecond(result),
+            GetPixelsPerSecond(result)
+        );
+
+        for (auto const & [key, value] : result.metrics)
+        {
+            file << std::format(", \"{}\": {:.6f}", EscapeJSON(key), value);
+        }
+
+        file << (index + 1U < results.size() ? "},\n" : "}\n");
+    }
+
+    file << "    ]\n}\n";
+}
+
+auto LoadBenchmarkMedians(std::filesystem::path const & path) -> std::map<std::string, double>
+{
+    static constexpr std::string_view NAME_KEY{"\"name\": \""};
+    static constexpr std::string_view MEDIAN_KEY{"\"median_ms\": "};
+
+    std::ifstream file{path};
+
+    if (!file)
+    {
+        throw std::runtime_error(std::format("Could not open {}.", path.string()));
+    }
+
+    std::map<std::string, double> medians;
+
+    for (std::string line; std::getline(file, line);)
+    {
+        auto const nameStart{line.find(NAME_KEY)};
+        auto const medianStart{line.find(MEDIAN_KEY)};
+
+        if (nameStart == std::string::npos || medianStart == std::string::npos)
+        {
+            continue;
+        }
+
+        auto const nameBegin{nameStart + NAME_KEY.size()};
+        auto const name{line.substr(nameBegin, line.find('"', nameBegin) - nameBegin)};
+
+        medians[name] = std::stod(line.substr(medianStart + MEDIAN_KEY.size()));
+    }
+
+    return medians;
+}
+
+auto CompareWithBaseline(std::vector<BenchmarkResult> const & results, std::map<std::string, double> const & baseline, double const thresholdPercent) -> bool
+{
+    auto hasRegression{false};
+
+    std::println("{:<56} {:>14} {:>14} {:>9}", "Benchmark", "Baseline [ms]", "Current [ms]", "Change");
+
+    for (auto const & result : results)
+    {
+        auto const found{baseline.find(result.name)};
+
+        if (found == baseline.end())
+        {
+            std::println("{:<56} {:>14} {:>14.3f} {:>9}", result.name, "-", result.milliseconds.median, "new");
+            continue;
+        }
+
+        auto const change{(result.milliseconds.median - found->second) / found->second * 100.0};
+        auto const isRegression{change > thresholdPercent};
+        hasRegression = hasRegression || isRegression;
+
+        std::println("{:<56} {:>14.3f} {:>14.3f} {:>+8.2f}%{}", result.name, found->second, result.milliseconds.median, change, isRegression ? "  REGRESSION" : "");
+    }
+
+    return hasRegression;
+}
@@ -0,0 +1,184 @@
+#include "BufferPool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <print>
+
+
+namespace
+{
+    constexpr std::size_t MIN_SIZE_CLASS{4096};
+
+    // Every power of two is split into this many classes, which wastes at most a quarter of a buffer
+    constexpr std::size_t CLASSES_PER_DOUBLING_LOG2{2};
+
+    constexpr double MEBIBYTE{1024.0 * 1024.0};
+}
+
+
+PooledBuffer::PooledBuffer(BufferPool * const pool, PageBuffer buffer, std::size_t const size, bool const isRecycled) : pool{pool}, buffer{std::move(buffer)},
+    size{size}, isRecycled{isRecycled} { }
+
+PooledBuffer::~PooledBuffer()
+{
+    Release();
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer && other) noexcept : pool{std::exchange(other.pool, nullptr)}, buffer{std::move(other.buffer)}, size{std::exchange(other.size, 0U)},
+    isRecycled{other.isRecycled} { }
+
+auto PooledBuffer::operator=(PooledBuffer && other) noexcept -> PooledBuffer &
+{
+    if (this != &other)
+    {
+        Release();
+
+        pool = std::exchange(other.pool, nullptr);
+        buffer = std::move(other.buffer);
+        size = std::exchange(other.size, 0U);
+        isRecycled = other.isRecycled;
+    }
+
+    return *this;
+}
+
+auto PooledBuffer::GetData() const -> std::uint8_t *
+{
+    return buffer.GetData();
+}
+
+auto PooledBuffer::GetSize() const -> std::size_t
+{
+    return size;
+}
+
+auto PooledBuffer::IsEmpty() const -> bool
+{
+    return buffer.IsEmpty();
+}
+
+auto PooledBuffer::IsRecycled() const -> bool
+{
+    return isRecycled;
+}
+
+auto PooledBuffer::Release() -> void
+{
+    if (pool != nullptr && !buffer.IsEmpty())
+    {
+        pool->Return(std::move(buffer));
+    }
+
+    pool = nullptr;
+    size = 0U;
+}
+
+BufferPool::BufferPool(std::size_t const maxIdleBytes) : maxIdleBytes{maxIdleBytes} { }
+
+auto BufferPool::GetSizeClass(std::size_t const size) -> std::size_t
+{
+    if (size <= MIN_SIZE_CLASS)
+    {
+        return MIN_SIZE_CLASS;
+    }
+
+    auto const step{1UZ << (std::bit_width(size - 1U) - 1U - CLASSES_PER_DOUBLING_LOG2)};
+
+    return (size + step - 1U) / step * step;
+}
+
+auto BufferPool::Acquire(std::size_t const size, HugePages const hugePages) -> PooledBuffer
+{
+    if (size == 0U)
+    {
+        return {};
+    }
+
+    auto const sizeClass{GetSizeClass(size)};
+
+    {
+        std::scoped_lock const lock{mutex};
+
+        statistics.inUseBytes += sizeClass;
+        statistics.peakInUseBytes = std::max(statistics.peakInUseBytes, statistics.inUseBytes);
+
+        if (auto const found{idle.find({sizeClass, hugePages})}; found != idle.end() && !found->second.empty())
+        {
+            auto buffer{std::move(found->second.back())};
+            found->second.pop_back();
+            idleBytes -= sizeClass;
+            ++statistics.hits;
+
+            return {this, std::move(buffer), size, true};
+        }
+
+        ++statistics.misses;
+        statistics.residentBytes += sizeClass;
+        statistics.peakResidentBytes = std::max(statistics.peakResidentBytes, statistics.residentBytes);
+    }
+
+    // Mapping happens outside the lock, since the kernel may take a while for large or huge page buffers
+    try
+    {
+        return {this, PageBuffer{sizeClass, hugePages}, size, false};
+    }
+    catch (...)
+    {
+        std::scoped_lock const lock{mutex};
+        statistics.inUseBytes -= sizeClass;
+        statistics.residentBytes -= sizeClass;
+
+        throw;
+    }
+}
+
+auto BufferPool::Return(PageBuffer buffer) -> void
+{
+    auto const sizeClass{buffer.GetSize()};
+
+    std::scoped_lock const lock{mutex};
+
+    statistics.inUseBytes -= sizeClass;
+
+    if (idleBytes + sizeClass > maxIdleBytes)
+    {
+        statistics.residentBytes -= sizeClass;
+        return;
+    }
+
+    idleBytes += sizeClass;
+    idle[{sizeClass, buffer.GetHugePages()}].push_back(std::move(buffer));
+}
+
+auto BufferPool::Trim() -> void
+{
+    std::scoped_lock const lock{mutex};
+
+    idle.clear();
+    statistics.residentBytes -= idleBytes;
+    idleBytes = 0U;
+}
+
+auto BufferPool::GetStatistics() const -> PoolStatistics
+{
+    std::scoped_lock const lock{mutex};
+
+    return statistics;
+}
+
+auto BufferPool::GetDefault() -> BufferPool &
+{
+    static auto * const pool{new BufferPool{}};
+
+    return *pool;
+}
+
+auto PrintPoolStatistics(PoolStatistics const & statistics, std::FILE * const stream) -> void
+{
+    auto const requests{statistics.hits + statistics.misses};
+
+    std::println(
+        stream, "Buffer pool: {:.1f} MiB resident (peak {:.1f} MiB), {:.1f} MiB in use (peak {:.1f} MiB), {} of {} requests recycled", statistics.residentBytes / MEBIBYTE,
+        statistics.peakResidentBytes / MEBIBYTE, statistics.inUseBytes / MEBIBYTE, statistics.peakInUseBytes / MEBIBYTE, statistics.hits, requests
+    );
+}
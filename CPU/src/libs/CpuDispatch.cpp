@@ -0,0 +1,232 @@
+#include "CpuDispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+#include "LaneKernels.hpp"
+
+#ifdef FRACTAL_X86_DISPATCH
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+
+#define DECLARE_LANE_KERNEL(isa)                                                                                                                                     \
+    namespace isa                                                                                                                                                    \
+    {                                                                                                                                                                \
+        auto IterateQuadraticLanes(float const * startPoints, std::size_t * iterations, std::size_t count, std::size_t maxIterations, float radius, bool conjugate,  \
+            float const * juliaPoint) -> void;                                                                                                                       \
+    }
+
+DECLARE_LANE_KERNEL(baseline)
+
+#ifdef FRACTAL_X86_DISPATCH
+DECLARE_LANE_KERNEL(sse42)
+DECLARE_LANE_KERNEL(avx2)
+DECLARE_LANE_KERNEL(avx512)
+#endif
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 4> INSTRUCTION_SET_NAMES{"baseline", "sse4.2", "avx2", "avx512"};
+
+#ifdef FRACTAL_X86_DISPATCH
+    auto CpuId(unsigned const leaf, unsigned const subleaf) -> std::array<unsigned, 4>
+    {
+        #ifdef _MSC_VER
+        std::array<int, 4> registers{};
+        __cpuidex(registers.data(), static_cast<int>(leaf), static_cast<int>(subleaf));
+
+        return {static_cast<unsigned>(registers[0]), static_cast<unsigned>(registers[1]), static_cast<unsigned>(registers[2]), static_cast<unsigned>(registers[3])};
+        #else
+        std::array<unsigned, 4> registers{};
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+
+        return registers;
+        #endif
+    }
+
+    // The processor may support the wide registers while the operating system does not save them on a context switch
+    auto GetEnabledStateMask() -> std::uint64_t
+    {
+        #ifdef _MSC_VER
+        return _xgetbv(0);
+        #else
+        std::uint32_t low{0};
+        std::uint32_t high{0};
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+
+        return (static_cast<std::uint64_t>(high) << 32U) | low;
+        #endif
+    }
+
+    auto HasBit(unsigned const value, unsigned const bit) -> bool
+    {
+        return ((value >> bit) & 1U) != 0U;
+    }
+#endif
+
+    auto GetInitialInstructionSet() -> InstructionSet
+    {
+        auto const detected{DetectInstructionSet()};
+
+        // FRACTAL_ISA can only lower the instruction set, which is handy to compare the kernels on one machine
+        if (auto const * const requested{std::getenv("FRACTAL_ISA")}; requested != nullptr)
+        {
+            return std::min(detected, ParseInstructionSet(requested));
+        }
+
+        return detected;
+    }
+
+    auto GetActiveSlot() -> std::atomic<InstructionSet> &
+    {
+        static std::atomic<InstructionSet> active{GetInitialInstructionSet()};
+
+        return active;
+    }
+}
+
+
+auto DetectInstructionSet() -> InstructionSet
+{
+#ifdef FRACTAL_X86_DISPATCH
+    static constexpr unsigned SSE42_BIT{20};
+    static constexpr unsigned FMA_BIT{12};
+    static constexpr unsigned OSXSAVE_BIT{27};
+    static constexpr unsigned AVX_BIT{28};
+    static constexpr unsigned AVX2_BIT{5};
+    static constexpr unsigned AVX512F_BIT{16};
+    static constexpr unsigned AVX512DQ_BIT{17};
+
+    static constexpr std::uint64_t AVX_STATE{0x06};
+    static constexpr std::uint64_t AVX512_STATE{0xE6};
+
+    auto const maxLeaf{CpuId(0U, 0U)[0]};
+    auto const features{CpuId(1U, 0U)[2]};
+
+    if (!HasBit(features, SSE42_BIT))
+    {
+        return InstructionSet::BASELINE;
+    }
+
+    if (maxLeaf < 7U || !HasBit(features, OSXSAVE_BIT) || !HasBit(features, AVX_BIT) || !HasBit(features, FMA_BIT))
+    {
+        return InstructionSet::SSE42;
+    }
+
+    auto const stateMask{GetEnabledStateMask()};
+    auto const extendedFeatures{CpuId(7U, 0U)[1]};
+
+    if ((stateMask & AVX_STATE) != AVX_STATE || !HasBit(extendedFeatures, AVX2_BIT))
+    {
+        return InstructionSet::SSE42;
+    }
+
+    if ((stateMask & AVX512_STATE) == AVX512_STATE && HasBit(extendedFeatures, AVX512F_BIT) && HasBit(extendedFeatures, AVX512DQ_BIT))
+    {
+        return InstructionSet::AVX512;
+    }
+
+    return InstructionSet::AVX2;
+#else
+    return InstructionSet::BASELINE;
+#endif
+}
+
+auto GetActiveInstructionSet() -> InstructionSet
+{
+    return GetActiveSlot().load(std::memory_order_relaxed);
+}
+
+auto SetInstructionSet(InstructionSet const instructionSet) -> void
+{
+    if (instructionSet > DetectInstructionSet())
+    {
+        throw std::invalid_argument(std::format("This processor does not support {}.", GetInstructionSetName(instructionSet)));
+    }
+
+    GetActiveSlot().store(instructionSet, std::memory_order_relaxed);
+}
+
+auto GetLaneWidth(InstructionSet const instructionSet) -> std::size_t
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::AVX512:
+        {
+            return 16U;
+        }
+        case InstructionSet::AVX2:
+        {
+            return 8U;
+        }
+        default:
+        {
+            return 4U;
+        }
+    }
+}
+
+auto ParseInstructionSet(std::string_view const name) -> InstructionSet
+{
+    std::string lower{name};
+    std::ranges::transform(lower, lower.begin(), [](unsigned char const character) { return static_cast<char>(std::tolower(character)); });
+
+    if (auto const found{std::ranges::find(INSTRUCTION_SET_NAMES, lower)}; found != INSTRUCTION_SET_NAMES.end())
+    {
+        return static_cast<InstructionSet>(found - INSTRUCTION_SET_NAMES.begin());
+    }
+
+    throw std::invalid_argument(std::format("Unknown instruction set {}.", name));
+}
+
+auto GetInstructionSetName(InstructionSet const instructionSet) -> std::string_view
+{
+    return INSTRUCTION_SET_NAMES[static_cast<std::size_t>(instructionSet)];
+}
+
+auto IterateQuadraticLanes(std::span<Point const> const startPoints, std::span<std::size_t> const iterations, std::size_t const maxIterations, float const radius,
+    bool const conjugate, Point const * const juliaPoint) -> void
+{
+    // The kernels take the points as pairs of floats, so that they need nothing inline from std::span or std::complex
+    auto const * const points{reinterpret_cast<float const *>(startPoints.data())};
+    auto const * const constant{reinterpret_cast<float const *>(juliaPoint)};
+    auto * const counts{iterations.data()};
+    auto const count{startPoints.size()};
+
+    switch (GetActiveInstructionSet())
+    {
+#ifdef FRACTAL_X86_DISPATCH
+        case InstructionSet::AVX512:
+        {
+            avx512::IterateQuadraticLanes(points, counts, count, maxIterations, radius, conjugate, constant);
+            return;
+        }
+        case InstructionSet::AVX2:
+        {
+            avx2::IterateQuadraticLanes(points, counts, count, maxIterations, radius, conjugate, constant);
+            return;
+        }
+        case InstructionSet::SSE42:
+        {
+            sse42::IterateQuadraticLanes(points, counts, count, maxIterations, radius, conjugate, constant);
+            return;
+        }
+#endif
+        default:
+        {
+            baseline::IterateQuadraticLanes(points, counts, count, maxIterations, radius, conjugate, constant);
+        }
+    }
+}
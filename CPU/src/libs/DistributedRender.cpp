@@ -0,0 +1,649 @@
+#include "DistributedRender.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <exception>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+namespace
+{
+    constexpr std::size_t MAX_TILE_SIDE{4096};
+    // The cap of the render server, since a worker bound beyond loopback takes jobs from anyone who reaches it
+    constexpr std::size_t MAX_ITERATIONS{100000};
+    constexpr std::size_t MAX_ERROR_SIZE{4096};
+    constexpr std::size_t JOBS_IN_FLIGHT{2};
+    constexpr std::size_t MAX_ATTEMPTS{3};
+    constexpr std::size_t MAX_COPIES{2};
+    // A zero timeout would reach the sockets as no timeout at all, and a lost worker would then hold the render forever
+    constexpr std::chrono::seconds MIN_TILE_TIMEOUT{1};
+
+    constexpr std::string_view DEFAULT_WORKER_PORT{"9100"};
+
+    auto SendAll(int const connection, void const * const data, std::size_t size) -> bool
+    {
+        auto const * bytes{static_cast<std::uint8_t const *>(data)};
+
+        while (size > 0U)
+        {
+            auto const sent{send(connection, bytes, size, MSG_NOSIGNAL)};
+
+            if (sent <= 0 && !(sent < 0 && errno == EINTR))
+            {
+                return false;
+            }
+
+            bytes += std::max(0L, sent);
+            size -= static_cast<std::size_t>(std::max(0L, sent));
+        }
+
+        return true;
+    }
+
+    auto ReceiveAll(int const connection, void * const data, std::size_t size) -> bool
+    {
+        auto * bytes{static_cast<std::uint8_t *>(data)};
+
+        while (size > 0U)
+        {
+            auto const received{recv(connection, bytes, size, 0)};
+
+            if (received <= 0 && !(received < 0 && errno == EINTR))
+            {
+                return false;
+            }
+
+            bytes += std::max(0L, received);
+            size -= static_cast<std::size_t>(std::max(0L, received));
+        }
+
+        return true;
+    }
+
+    // The timeout bounds every send and receive, so that a worker that stops answering counts as lost
+    auto Connect(std::string_view const worker, std::chrono::milliseconds const timeout) -> int
+    {
+        auto const separator{worker.rfind(':')};
+
+        if (separator == std::string_view::npos)
+        {
+            throw std::invalid_argument(std::format("The worker {} is not given as host:port.", worker));
+        }
+
+        std::string const host{worker.substr(0U, separator)};
+        std::string const port{worker.substr(separator + 1U)};
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo * addresses{nullptr};
+
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0)
+        {
+            return -1;
+        }
+
+        auto connection{-1};
+
+        for (auto const * address{addresses}; address != nullptr && connection < 0; address = address->ai_next)
+        {
+            connection = ::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+
+            if (connection >= 0 && ::connect(connection, address->ai_addr, address->ai_addrlen) != 0)
+            {
+                close(connection);
+                connection = -1;
+            }
+        }
+
+        freeaddrinfo(addresses);
+
+        if (connection >= 0)
+        {
+            auto const seconds{std::chrono::duration_cast<std::chrono::seconds>(timeout)};
+            timeval const limit{seconds.count(), static_cast<suseconds_t>(std::chrono::microseconds{timeout - seconds}.count())};
+            int const noDelay{1};
+
+            setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof(limit));
+            setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+            setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+
+        return connection;
+    }
+
+    struct TileBounds
+    {
+        Pixel position;
+        Size size;
+    };
+
+    auto GetTileBounds(DistributedJob const & job, std::size_t const tile) -> TileBounds
+    {
+        auto const tilesWide{(job.imageSize.width + job.tileSize.width - 1U) / job.tileSize.width};
+        Pixel const position{tile % tilesWide * job.tileSize.width, tile / tilesWide * job.tileSize.height};
+
+        return {position, {std::min(job.tileSize.width, job.imageSize.width - position.x), std::min(job.tileSize.height, job.imageSize.height - position.y)}};
+    }
+
+    // The tile keeps the viewport of the whole image and its place in it, so that its pixels come out exactly as in a render of the whole image
+    auto MakeJobMessage(DistributedJob const & job, std::size_t const tile) -> TileJobMessage
+    {
+        auto const [position, size]{GetTileBounds(job, tile)};
+
+        return {
+            TILE_PROTOCOL_MAGIC, static_cast<std::uint32_t>(tile), static_cast<std::uint32_t>(job.type), static_cast<std::uint32_t>(job.layout),
+            static_cast<std::uint32_t>(position.x), static_cast<std::uint32_t>(position.y), static_cast<std::uint32_t>(size.width), static_cast<std::uint32_t>(size.height),
+            static_cast<std::uint32_t>(job.imageSize.width), static_cast<std::uint32_t>(job.imageSize.height), static_cast<std::uint32_t>(job.maxIterations),
+            job.viewport.topLeft.real(), job.viewport.topLeft.imag(), job.viewport.bottomRight.real(), job.viewport.bottomRight.imag(), job.juliaPoint.real(), job.juliaPoint.imag(),
+        };
+    }
+
+    // Shared by the threads that drive the workers of one render
+    struct Schedule
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+
+        std::deque<std::size_t> pending;
+        std::vector<std::uint8_t> isDone;
+        std::vector<std::size_t> copies;
+        std::vector<std::size_t> attempts;
+        std::vector<std::chrono::steady_clock::time_point> sentAt;
+
+        std::size_t remaining;
+        std::size_t liveWorkers;
+        std::size_t retries{0};
+        std::size_t steals{0};
+        std::uint64_t iterations{0};
+        std::exception_ptr error;
+        // Open worker connections, shut down once the render is over so that no thread keeps waiting on a slow worker
+        std::vector<int> connections;
+
+        std::mutex sinkMutex;
+    };
+
+    // Called with the schedule locked. Once the queue is empty the oldest tile in flight at another worker is taken again, since it is the likeliest to be stuck
+    // behind a slow worker.
+    auto TakeTile(Schedule & schedule, std::deque<std::size_t> const & inFlight) -> std::optional<std::size_t>
+    {
+        while (!schedule.pending.empty())
+        {
+            auto const tile{schedule.pending.front()};
+            schedule.pending.pop_front();
+
+            if (schedule.isDone[tile] == 0U)
+            {
+                return tile;
+            }
+        }
+
+        std::optional<std::size_t> oldest;
+
+        for (std::size_t tile{0}; tile < schedule.isDone.size(); ++tile)
+        {
+            auto const isCandidate{schedule.isDone[tile] == 0U && schedule.copies[tile] > 0U && schedule.copies[tile] < MAX_COPIES};
+
+            if (isCandidate && std::ranges::find(inFlight, tile) == inFlight.end() && (!oldest || schedule.sentAt[tile] < schedule.sentAt[*oldest]))
+            {
+                oldest = tile;
+            }
+        }
+
+        if (oldest)
+        {
+            ++schedule.steals;
+        }
+
+        return oldest;
+    }
+
+    // Called with the schedule locked once every tile is done or the render failed. The pending sends and receives then fail at once instead of at their timeout.
+    auto ShutDownWorkers(Schedule & schedule) -> void
+    {
+        for (auto const connection : schedule.connections)
+        {
+            shutdown(connection, SHUT_RDWR);
+        }
+
+        schedule.changed.notify_all();
+    }
+
+    auto Fail(Schedule & schedule, std::exception_ptr error) -> void
+    {
+        std::scoped_lock const lock{schedule.mutex};
+
+        if (!schedule.error)
+        {
+            schedule.error = std::move(error);
+        }
+
+        ShutDownWorkers(schedule);
+    }
+
+    // Runs on a thread per worker until every tile is done, the render failed or the worker is lost
+    auto DriveWorker(Schedule & schedule, DistributedJob const & job, std::function<void(CompletedTile const &)> const & sink, WorkerStatistics & statistics,
+        std::chrono::milliseconds const timeout) -> void
+    {
+        auto const connection{Connect(statistics.address, timeout)};
+        auto const channels{GetChannels(job.layout)};
+
+        std::deque<std::size_t> inFlight;
+        std::vector<std::uint8_t> pixels;
+        auto isHealthy{connection >= 0};
+
+        if (isHealthy)
+        {
+            std::scoped_lock const lock{schedule.mutex};
+            schedule.connections.push_back(connection);
+        }
+
+        while (isHealthy)
+        {
+            std::vector<std::size_t> newJobs;
+
+            {
+                std::unique_lock lock{schedule.mutex};
+
+                while (schedule.remaining > 0U && !schedule.error && inFlight.size() < JOBS_IN_FLIGHT)
+                {
+                    if (auto const tile{TakeTile(schedule, inFlight)})
+                    {
+                        ++schedule.copies[*tile];
+                        schedule.sentAt[*tile] = std::chrono::steady_clock::now();
+                        inFlight.push_back(*tile);
+                        newJobs.push_back(*tile);
+                    }
+                    else if (inFlight.empty())
+                    {
+                        // Nothing to take until a worker is lost or the render ends
+                        schedule.changed.wait(lock);
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                if (schedule.remaining == 0U || schedule.error)
+                {
+                    break;
+                }
+            }
+
+            for (auto const tile : newJobs)
+            {
+                auto const message{MakeJobMessage(job, tile)};
+                isHealthy = isHealthy && SendAll(connection, &message, sizeof(message));
+            }
+
+            // A worker answers its jobs in order
+            TileResultMessage result{};
+            auto const tile{inFlight.front()};
+            auto const [position, size]{GetTileBounds(job, tile)};
+
+            isHealthy = isHealthy && ReceiveAll(connection, &result, sizeof(result)) && result.magic == TILE_PROTOCOL_MAGIC && result.tile == tile;
+
+            if (isHealthy && result.status != 0U)
+            {
+                std::string message(std::min<std::size_t>(result.byteCount, MAX_ERROR_SIZE), '\0');
+                static_cast<void>(ReceiveAll(connection, message.data(), message.size()));
+
+                Fail(schedule, std::make_exception_ptr(std::runtime_error(std::format("The worker {} failed: {}", statistics.address, message))));
+                break;
+            }
+
+            pixels.resize(size.width * size.height * channels);
+            isHealthy = isHealthy && result.byteCount == pixels.size() && ReceiveAll(connection, pixels.data(), pixels.size());
+
+            if (!isHealthy)
+            {
+                break;
+            }
+
+            auto isFirst{false};
+
+            {
+                std::scoped_lock const lock{schedule.mutex};
+
+                --schedule.copies[tile];
+                inFlight.pop_front();
+
+                if (schedule.isDone[tile] == 0U)
+                {
+                    isFirst = true;
+                    schedule.isDone[tile] = 1U;
+                    schedule.iterations += result.iterations;
+                    ++statistics.tiles;
+                }
+                else
+                {
+                    ++statistics.discarded;
+                }
+            }
+
+            if (isFirst)
+            {
+                try
+                {
+                    std::scoped_lock const lock{schedule.sinkMutex};
+                    sink({tile, position, {pixels.data(), size, size.width * channels, job.layout, &DEFAULT_PALETTE}});
+                }
+                catch (...)
+                {
+                    Fail(schedule, std::current_exception());
+                    break;
+                }
+
+                // Only counted once the sink has the tile, so that Render does not return before the last one is through
+                std::scoped_lock const lock{schedule.mutex};
+
+                if (--schedule.remaining == 0U)
+                {
+                    ShutDownWorkers(schedule);
+                }
+            }
+        }
+
+        std::scoped_lock const lock{schedule.mutex};
+
+        if (connection >= 0)
+        {
+            // Taken out of the list first, so that a shutdown never hits a descriptor number that was reused
+            std::erase(schedule.connections, connection);
+            close(connection);
+        }
+
+        // A connection that ShutDownWorkers shut down is not a lost worker
+        if (isHealthy || schedule.remaining == 0U || schedule.error)
+        {
+            return;
+        }
+
+        statistics.isLost = true;
+        --schedule.liveWorkers;
+
+        for (auto const tile : inFlight)
+        {
+            --schedule.copies[tile];
+
+            if (schedule.isDone[tile] != 0U)
+            {
+                continue;
+            }
+
+            if (++schedule.attempts[tile] >= MAX_ATTEMPTS && !schedule.error)
+            {
+                schedule.error = std::make_exception_ptr(std::runtime_error(std::format("Tile {} was lost {} times.", tile, MAX_ATTEMPTS)));
+            }
+
+            schedule.pending.push_front(tile);
+            ++schedule.retries;
+        }
+
+        if (schedule.liveWorkers == 0U && schedule.remaining > 0U && !schedule.error)
+        {
+            schedule.error = std::make_exception_ptr(std::runtime_error(std::format("Every worker is lost with {} tiles left.", schedule.remaining)));
+        }
+
+        if (schedule.error)
+        {
+            ShutDownWorkers(schedule);
+        }
+        else
+        {
+            schedule.changed.notify_all();
+        }
+    }
+}
+
+
+auto GetWorkerOptions(int const argc, char const * const argv[]) -> WorkerOptions
+{
+    auto const port{std::stoi(std::string{GetOption(argc, argv, "port", DEFAULT_WORKER_PORT)})};
+
+    if (port <= 0 || port > 65535)
+    {
+        throw std::invalid_argument(std::format("The worker port {} is out of range.", port));
+    }
+
+    return {std::string{GetOption(argc, argv, "bind", "127.0.0.1")}, port, GetArenaOptions(argc, argv)};
+}
+
+RenderWorker::RenderWorker(WorkerOptions workerOptions) : options{std::move(workerOptions)}, listener{options.address, options.port}
+{
+    InitializeArena(arena, options.arenaOptions, arenaPinning);
+}
+
+auto RenderWorker::Run() -> void
+{
+    // A small tile up front, so that the first coordinator does not wait for the arena threads to start
+    std::vector<std::uint8_t> warmUp;
+    static_cast<void>(RenderJob(MakeJobMessage({.viewport = GetDefaultViewport(FractalType::MANDELBROT), .tileSize = {64, 64}}, 0U), warmUp));
+
+    listener.Run(
+        [this](int const connection) -> void
+        {
+            std::scoped_lock const lock{connectionsMutex};
+
+            connections.push_back(connection);
+            std::thread{[this, connection]() -> void { Serve(connection); }}.detach();
+        }
+    );
+
+    // Coordinators that are still connected see the connection drop and hand their tiles to other workers
+    std::unique_lock lock{connectionsMutex};
+
+    for (auto const connection : connections)
+    {
+        shutdown(connection, SHUT_RDWR);
+    }
+
+    connectionsClosed.wait(lock, [this]() { return connections.empty(); });
+}
+
+auto RenderWorker::Stop() -> void
+{
+    listener.Stop();
+}
+
+auto RenderWorker::Serve(int const connection) -> void
+{
+    auto const start{std::chrono::steady_clock::now()};
+    int const noDelay{1};
+    setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    std::vector<std::uint8_t> pixels;
+    std::size_t tiles{0};
+    TileJobMessage job{};
+
+    while (ReceiveAll(connection, &job, sizeof(job)))
+    {
+        TileResultMessage result{TILE_PROTOCOL_MAGIC, job.tile, 0U, 0U, 0U};
+        std::string error;
+
+        try
+        {
+            if (job.magic != TILE_PROTOCOL_MAGIC)
+            {
+                throw std::invalid_argument("The message is not a tile job.");
+            }
+
+            result.iterations = RenderJob(job, pixels);
+            result.byteCount = static_cast<std::uint32_t>(pixels.size());
+        }
+        catch (std::exception const & exception)
+        {
+            error = exception.what();
+            result.status = 1U;
+            result.byteCount = static_cast<std::uint32_t>(error.size());
+        }
+
+        auto const * const payload{result.status == 0U ? static_cast<void const *>(pixels.data()) : error.data()};
+
+        if (!SendAll(connection, &result, sizeof(result)) || !SendAll(connection, payload, result.byteCount) || job.magic != TILE_PROTOCOL_MAGIC)
+        {
+            break;
+        }
+
+        ++tiles;
+    }
+
+    auto const elapsed{std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)};
+    std::println("Rendered {} tiles for a coordinator in {} ms", tiles, elapsed.count());
+
+    std::scoped_lock const lock{connectionsMutex};
+
+    close(connection);
+    std::erase(connections, connection);
+    connectionsClosed.notify_all();
+}
+
+auto RenderWorker::RenderJob(TileJobMessage const & job, std::vector<std::uint8_t> & pixels) -> std::uint64_t
+{
+    if (job.type > static_cast<std::uint32_t>(FractalType::TRICORN) || job.layout > static_cast<std::uint32_t>(PixelLayout::INDEXED))
+    {
+        throw std::invalid_argument("Unknown fractal type or pixel layout.");
+    }
+
+    if (job.width == 0U || job.height == 0U || job.width > MAX_TILE_SIDE || job.height > MAX_TILE_SIDE)
+    {
+        throw std::invalid_argument(std::format("Tile sides must be between 1 and {} pixels.", MAX_TILE_SIDE));
+    }
+
+    if (job.maxIterations == 0U || job.maxIterations > MAX_ITERATIONS)
+    {
+        throw std::invalid_argument(std::format("Iterations must be between 1 and {}.", MAX_ITERATIONS));
+    }
+
+    if (static_cast<std::uint64_t>(job.x) + job.width > job.frameWidth || static_cast<std::uint64_t>(job.y) + job.height > job.frameHeight)
+    {
+        throw std::invalid_argument("The tile must lie within its frame.");
+    }
+
+    Size const tileSize{job.width, job.height};
+    auto const layout{static_cast<PixelLayout>(job.layout)};
+    auto const stride{tileSize.width * GetChannels(layout)};
+
+    auto const generator{MakeFractalGenerator(
+        static_cast<FractalType>(job.type), tileSize, GetGrainSize(tileSize, arena.max_concurrency()), {{job.left, job.top}, {job.right, job.bottom}}, job.maxIterations,
+        layout, {job.juliaReal, job.juliaImaginary}
+    )};
+
+    generator->SetFrame({job.frameWidth, job.frameHeight}, {job.x, job.y});
+
+    // Counts as configured, which keeps the cached tuning from giving the generator an arena besides the worker's
+    generator->SetThreads(0);
+
+    pixels.resize(stride * tileSize.height);
+    generator->UseBuffer(pixels.data(), stride);
+
+    arena.execute([&generator]() -> void { generator->Render(); });
+
+    return generator->GetRenderedIterations();
+}
+
+auto RenderWorker::GetAddress() const -> std::string
+{
+    return listener.GetAddress();
+}
+
+auto RenderWorker::GetConcurrency() const -> int
+{
+    return arena.max_concurrency();
+}
+
+RenderCoordinator::RenderCoordinator(std::vector<std::string> workerAddresses, std::chrono::milliseconds const timeout) : workers{std::move(workerAddresses)},
+    tileTimeout{timeout}
+{
+    if (workers.empty())
+    {
+        throw std::invalid_argument("At least one worker is needed.");
+    }
+
+    if (tileTimeout < MIN_TILE_TIMEOUT)
+    {
+        throw std::invalid_argument(std::format("The tile timeout must be at least {} s.", MIN_TILE_TIMEOUT.count()));
+    }
+}
+
+auto RenderCoordinator::Render(DistributedJob const & job, std::function<void(CompletedTile const &)> const & sink) -> DistributedStatistics
+{
+    if (job.imageSize.width == 0U || job.imageSize.height == 0U || job.tileSize.width == 0U || job.tileSize.height == 0U)
+    {
+        throw std::invalid_argument("The image and the tiles must not be empty.");
+    }
+
+    auto const tilesWide{(job.imageSize.width + job.tileSize.width - 1U) / job.tileSize.width};
+    auto const tilesHigh{(job.imageSize.height + job.tileSize.height - 1U) / job.tileSize.height};
+    auto const tileCount{tilesWide * tilesHigh};
+
+    Schedule schedule;
+    schedule.isDone.resize(tileCount);
+    schedule.copies.resize(tileCount);
+    schedule.attempts.resize(tileCount);
+    schedule.sentAt.resize(tileCount);
+    schedule.remaining = tileCount;
+    schedule.liveWorkers = workers.size();
+
+    for (std::size_t tile{0}; tile < tileCount; ++tile)
+    {
+        schedule.pending.push_back(tile);
+    }
+
+    DistributedStatistics statistics{{}, 0U, 0U, 0U};
+
+    for (auto const & worker : workers)
+    {
+        statistics.workers.push_back({worker, 0U, 0U, false});
+    }
+
+    {
+        std::vector<std::jthread> threads;
+
+        for (auto & workerStatistics : statistics.workers)
+        {
+            threads.emplace_back(
+                [&schedule, &job, &sink, &workerStatistics, this]() -> void
+                {
+                    try
+                    {
+                        DriveWorker(schedule, job, sink, workerStatistics, tileTimeout);
+                    }
+                    catch (...)
+                    {
+                        Fail(schedule, std::current_exception());
+                    }
+                }
+            );
+        }
+    }
+
+    if (schedule.error)
+    {
+        std::rethrow_exception(schedule.error);
+    }
+
+    statistics.retries = schedule.retries;
+    statistics.steals = schedule.steals;
+    statistics.iterations = schedule.iterations;
+
+    return statistics;
+}
+
+auto RenderCoordinator::GetWorkerCount() const -> std::size_t
+{
+    return workers.size();
+}
@@ -0,0 +1,495 @@
+#include "Executor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <format>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <version>
+
+#include <oneapi/tbb.h>
+
+#ifdef __cpp_lib_parallel_algorithm
+    #include <execution>
+#endif
+
+#ifdef WITH_OPENMP
+    #include <omp.h>
+#endif
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 5> EXECUTOR_NAMES{"tbb", "omp-dynamic", "omp-guided", "std", "pool"};
+
+    auto GetChunkCount(std::size_t const count, std::size_t const grainSize) -> std::size_t
+    {
+        return (count + grainSize - 1U) / grainSize;
+    }
+
+    // Keeps the first exception thrown by a chunk, since only TBB carries exceptions across threads by itself
+    class ErrorSlot
+    {
+    public:
+        auto Capture() -> void
+        {
+            std::scoped_lock const lock{mutex};
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+
+        auto Rethrow() -> void
+        {
+            if (auto const caught{std::exchange(error, nullptr)})
+            {
+                std::rethrow_exception(caught);
+            }
+        }
+
+    private:
+        std::mutex mutex;
+        std::exception_ptr error;
+    };
+
+    auto RunChunk(ChunkFunction const & function, std::size_t const chunk, std::size_t const grainSize, std::size_t const count, ErrorSlot & errors) -> void
+    {
+        try
+        {
+            function(chunk * grainSize, std::min(count, (chunk + 1U) * grainSize));
+        }
+        catch (...)
+        {
+            errors.Capture();
+        }
+    }
+
+    class TbbExecutor final : public Executor
+    {
+    public:
+        explicit TbbExecutor(int const threads)
+        {
+            if (threads > 0)
+            {
+                arena.emplace(threads);
+            }
+        }
+
+        auto ParallelFor(std::size_t const count, std::size_t const grainSize, ChunkFunction const & function) -> void override
+        {
+            using namespace oneapi::tbb;
+
+            auto const loop{
+                [&]() -> void
+                {
+                    parallel_for(blocked_range<std::size_t>{0U, count, grainSize}, [&function](auto const & range) -> void { function(range.begin(), range.end()); });
+                }
+            };
+
+            if (arena)
+            {
+                arena->execute(loop);
+            }
+            else
+            {
+                loop();
+            }
+        }
+
+        [[nodiscard]] auto GetType() const -> ExecutorType override
+        {
+            return ExecutorType::TBB;
+        }
+
+        [[nodiscard]] auto GetConcurrency() const -> int override
+        {
+            return arena ? arena->max_concurrency() : oneapi::tbb::this_task_arena::max_concurrency();
+        }
+
+        [[nodiscard]] auto GetThreadIndex() const -> int override
+        {
+            return oneapi::tbb::this_task_arena::current_thread_index();
+        }
+
+    private:
+        std::optional<oneapi::tbb::task_arena> arena;
+    };
+
+#ifdef WITH_OPENMP
+    class OpenMPExecutor final : public Executor
+    {
+    public:
+        OpenMPExecutor(bool const isGuided, int const threads) : isGuided{isGuided}, threads{threads > 0 ? threads : omp_get_max_threads()} { }
+
+        auto ParallelFor(std::size_t const count, std::size_t const grainSize, ChunkFunction const & function) -> void override
+        {
+            auto const chunks{static_cast<std::int64_t>(GetChunkCount(count, grainSize))};
+            ErrorSlot errors;
+
+            // The schedule clause only takes a compile-time kind, hence the two loops
+            if (isGuided)
+            {
+                #pragma omp parallel for schedule(guided) num_threads(threads)
+                for (std::int64_t chunk = 0; chunk < chunks; ++chunk)
+                {
+                    RunChunk(function, static_cast<std::size_t>(chunk), grainSize, count, errors);
+                }
+            }
+            else
+            {
+                #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+                for (std::int64_t chunk = 0; chunk < chunks; ++chunk)
+                {
+                    RunChunk(function, static_cast<std::size_t>(chunk), grainSize, count, errors);
+                }
+            }
+
+            errors.Rethrow();
+        }
+
+        [[nodiscard]] auto GetType() const -> ExecutorType override
+        {
+            return isGuided ? ExecutorType::OPENMP_GUIDED : ExecutorType::OPENMP_DYNAMIC;
+        }
+
+        [[nodiscard]] auto GetConcurrency() const -> int override
+        {
+            return threads;
+        }
+
+        [[nodiscard]] auto GetThreadIndex() const -> int override
+        {
+            return omp_get_thread_num();
+        }
+
+    private:
+        bool const isGuided;
+        int const threads;
+    };
+#endif
+
+#ifdef __cpp_lib_parallel_algorithm
+    // The standard library picks its own thread count, so the requested one is ignored
+    class StdParallelExecutor final : public Executor
+    {
+    public:
+        auto ParallelFor(std::size_t const count, std::size_t const grainSize, ChunkFunction const & function) -> void override
+        {
+            std::vector<std::size_t> chunks(GetChunkCount(count, grainSize));
+            std::iota(chunks.begin(), chunks.end(), 0U);
+
+            ErrorSlot errors;
+
+            std::for_each(
+                std::execution::par, chunks.begin(), chunks.end(), [&](std::size_t const chunk) -> void
+                {
+                    RunChunk(function, chunk, grainSize, count, errors);
+                }
+            );
+
+            errors.Rethrow();
+        }
+
+        [[nodiscard]] auto GetType() const -> ExecutorType override
+        {
+            return ExecutorType::STD_PARALLEL;
+        }
+
+        [[nodiscard]] auto GetConcurrency() const -> int override
+        {
+            return static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+        }
+
+        [[nodiscard]] auto GetThreadIndex() const -> int override
+        {
+            static std::atomic<int> nextIndex{0};
+            thread_local int const index{nextIndex++};
+
+            return index;
+        }
+    };
+#endif
+
+    thread_local int poolThreadIndex{0};
+
+    // Every thread owns a contiguous run of chunks which it takes from the front, while idle threads steal single chunks from the back of the others.
+    // The calling thread takes part as thread zero.
+    class ThreadPool final : public Executor
+    {
+    public:
+        explicit ThreadPool(int const threads) : slots(static_cast<std::size_t>(threads))
+        {
+            workers.reserve(slots.size() - 1U);
+
+            for (std::size_t index{1}; index < slots.size(); ++index)
+            {
+                workers.emplace_back([this, index](std::stop_token const & stopToken) -> void { RunWorker(stopToken, index); });
+            }
+        }
+
+        auto ParallelFor(std::size_t const count, std::size_t const grainSize, ChunkFunction const & function) -> void override
+        {
+            auto const chunks{GetChunkCount(count, grainSize)};
+
+            if (chunks == 0U)
+            {
+                return;
+            }
+
+            // A loop started from inside a chunk would wait for the threads that are already busy with the outer one
+            if (isInsideLoop)
+            {
+                for (std::size_t chunk{0}; chunk < chunks; ++chunk)
+                {
+                    function(chunk * grainSize, std::min(count, (chunk + 1U) * grainSize));
+                }
+
+                return;
+            }
+
+            std::scoped_lock const loopLock{loopMutex};
+
+            // The loop is published before any chunk becomes visible, and a chunk is only taken under the lock of its slot
+            loop = {&function, grainSize, count};
+            remaining.store(chunks, std::memory_order_relaxed);
+
+            for (std::size_t index{0}; index < slots.size(); ++index)
+            {
+                std::scoped_lock const lock{slots[index].mutex};
+                slots[index].begin = chunks * index / slots.size();
+                slots[index].end = chunks * (index + 1U) / slots.size();
+            }
+
+            {
+                std::scoped_lock const lock{wakeMutex};
+                ++generation;
+            }
+
+            wake.notify_all();
+
+            isInsideLoop = true;
+            RunChunks(0U);
+            isInsideLoop = false;
+
+            for (auto left{remaining.load(std::memory_order_acquire)}; left != 0U; left = remaining.load(std::memory_order_acquire))
+            {
+                remaining.wait(left, std::memory_order_acquire);
+            }
+
+            errors.Rethrow();
+        }
+
+        [[nodiscard]] auto GetType() const -> ExecutorType override
+        {
+            return ExecutorType::THREAD_POOL;
+        }
+
+        [[nodiscard]] auto GetConcurrency() const -> int override
+        {
+            return static_cast<int>(slots.size());
+        }
+
+        [[nodiscard]] auto GetThreadIndex() const -> int override
+        {
+            return poolThreadIndex;
+        }
+
+    private:
+        struct alignas(std::hardware_destructive_interference_size) Slot
+        {
+            std::mutex mutex;
+            std::size_t begin{0};
+            std::size_t end{0};
+        };
+
+        struct Loop
+        {
+            ChunkFunction const * function;
+            std::size_t grainSize;
+            std::size_t count;
+        };
+
+        auto RunWorker(std::stop_token const & stopToken, std::size_t const index) -> void
+        {
+            poolThreadIndex = static_cast<int>(index);
+            isInsideLoop = true;
+
+            std::uint64_t seenGeneration{0};
+
+            while (true)
+            {
+                {
+                    std::unique_lock lock{wakeMutex};
+
+                    if (!wake.wait(lock, stopToken, [this, seenGeneration]() { return generation != seenGeneration; }))
+                    {
+                        return;
+                    }
+
+                    seenGeneration = generation;
+                }
+
+                RunChunks(index);
+            }
+        }
+
+        auto RunChunks(std::size_t const index) -> void
+        {
+            while (auto const chunk{TakeChunk(index)})
+            {
+                RunChunk(*loop.function, *chunk, loop.grainSize, loop.count, errors);
+
+                if (remaining.fetch_sub(1U, std::memory_order_acq_rel) == 1U)
+                {
+                    remaining.notify_all();
+                }
+            }
+        }
+
+        auto TakeChunk(std::size_t const index) -> std::optional<std::size_t>
+        {
+            if (auto const own{TakeOwn(index)})
+            {
+                return own;
+            }
+
+            return Steal(index);
+        }
+
+        auto TakeOwn(std::size_t const index) -> std::optional<std::size_t>
+        {
+            auto & slot{slots[index]};
+            std::scoped_lock const lock{slot.mutex};
+
+            if (slot.begin == slot.end)
+            {
+                return std::nullopt;
+            }
+
+            return slot.begin++;
+        }
+
+        auto Steal(std::size_t const thief) -> std::optional<std::size_t>
+        {
+            for (std::size_t offset{1}; offset < slots.size(); ++offset)
+            {
+                auto & victim{slots[(thief + offset) % slots.size()]};
+                std::scoped_lock const lock{victim.mutex};
+
+                if (victim.begin != victim.end)
+                {
+                    return --victim.end;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        static thread_local bool isInsideLoop;
+
+        std::vector<Slot> slots;
+
+        std::mutex loopMutex;
+        Loop loop{};
+        std::atomic<std::size_t> remaining{0};
+        ErrorSlot errors;
+
+        std::mutex wakeMutex;
+        std::condition_variable_any wake;
+        std::uint64_t generation{0};
+
+        // Declared last so that the workers are stopped and joined before anything they use goes away
+        std::vector<std::jthread> workers;
+    };
+
+    thread_local bool ThreadPool::isInsideLoop{false};
+}
+
+
+auto ParseExecutorType(std::string_view const name) -> ExecutorType
+{
+    if (auto const found{std::ranges::find(EXECUTOR_NAMES, name)}; found != EXECUTOR_NAMES.end())
+    {
+        return static_cast<ExecutorType>(found - EXECUTOR_NAMES.begin());
+    }
+
+    throw std::invalid_argument(std::format("Unknown executor {}.", name));
+}
+
+auto GetExecutorName(ExecutorType const type) -> std::string_view
+{
+    return EXECUTOR_NAMES[static_cast<std::size_t>(type)];
+}
+
+auto IsExecutorAvailable(ExecutorType const type) -> bool
+{
+    switch (type)
+    {
+        case ExecutorType::OPENMP_DYNAMIC:
+        case ExecutorType::OPENMP_GUIDED:
+        {
+#ifdef WITH_OPENMP
+            return true;
+#else
+            return false;
+#endif
+        }
+        case ExecutorType::STD_PARALLEL:
+        {
+#ifdef __cpp_lib_parallel_algorithm
+            return true;
+#else
+            return false;
+#endif
+        }
+        default:
+        {
+            return true;
+        }
+    }
+}
+
+auto MakeExecutor(ExecutorType const type, int const threads) -> std::unique_ptr<Executor>
+{
+    if (!IsExecutorAvailable(type))
+    {
+        throw std::runtime_error(std::format("The {} executor is not available in this build.", GetExecutorName(type)));
+    }
+
+    switch (type)
+    {
+#ifdef WITH_OPENMP
+        case ExecutorType::OPENMP_DYNAMIC:
+        case ExecutorType::OPENMP_GUIDED:
+        {
+            return std::make_unique<OpenMPExecutor>(type == ExecutorType::OPENMP_GUIDED, threads);
+        }
+#endif
+#ifdef __cpp_lib_parallel_algorithm
+        case ExecutorType::STD_PARALLEL:
+        {
+            return std::make_unique<StdParallelExecutor>();
+        }
+#endif
+        case ExecutorType::THREAD_POOL:
+        {
+            return std::make_unique<ThreadPool>(threads > 0 ? threads : static_cast<int>(std::max(1U, std::thread::hardware_concurrency())));
+        }
+        default:
+        {
+            return std::make_unique<TbbExecutor>(threads);
+        }
+    }
+}
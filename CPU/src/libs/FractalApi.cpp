@@ -0,0 +1,235 @@
+#include "FractalApi.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <oneapi/tbb.h>
+
+#include "FractalFactory.hpp"
+#include "Palette.hpp"
+
+
+struct fractal_generator
+{
+    std::unique_ptr<FractalGenerator> generator;
+    // Taken before the buffer is swapped in, which must not happen under a render in flight
+    std::atomic<bool> isRendering{false};
+};
+
+
+namespace
+{
+    static_assert(static_cast<FractalType>(FRACTAL_TRICORN) == FractalType::TRICORN);
+    static_assert(static_cast<PixelLayout>(FRACTAL_LAYOUT_INDEXED) == PixelLayout::INDEXED);
+
+    thread_local std::string lastError;
+
+    // C callers may pass any integer as an enumerator
+    auto IsValid(fractal_type const type) -> bool
+    {
+        return static_cast<unsigned>(type) <= FRACTAL_TRICORN;
+    }
+
+    auto IsValid(fractal_layout const layout) -> bool
+    {
+        return static_cast<unsigned>(layout) <= FRACTAL_LAYOUT_INDEXED;
+    }
+
+    // Exceptions must not cross the C boundary, so every entry point reports them as a status and keeps the message
+    template <typename Function>
+    auto Guard(Function const & function) noexcept -> fractal_status
+    {
+        try
+        {
+            return function();
+        }
+        catch (std::invalid_argument const & exception)
+        {
+            lastError = exception.what();
+            return FRACTAL_INVALID_ARGUMENT;
+        }
+        catch (std::bad_alloc const &)
+        {
+            lastError = "Out of memory.";
+            return FRACTAL_OUT_OF_MEMORY;
+        }
+        catch (std::exception const & exception)
+        {
+            lastError = exception.what();
+            return FRACTAL_ERROR;
+        }
+        catch (...)
+        {
+            lastError = "Unknown error.";
+            return FRACTAL_ERROR;
+        }
+    }
+}
+
+
+extern "C"
+{
+    auto fractal_api_version() -> std::uint32_t
+    {
+        return FRACTAL_API_VERSION;
+    }
+
+    auto fractal_default_params(fractal_type const type, fractal_params * const params) -> fractal_status
+    {
+        return Guard(
+            [type, params]() -> fractal_status
+            {
+                if (params == nullptr)
+                {
+                    throw std::invalid_argument("The parameters must not be null.");
+                }
+
+                if (!IsValid(type))
+                {
+                    throw std::invalid_argument("Unknown fractal type.");
+                }
+
+                auto const viewport{GetDefaultViewport(static_cast<FractalType>(type))};
+
+                *params = {
+                    sizeof(fractal_params), type, 1024U, 768U, 256U, FRACTAL_LAYOUT_RGB,
+                    viewport.topLeft.real(), viewport.topLeft.imag(), viewport.bottomRight.real(), viewport.bottomRight.imag(),
+                    JuliaGenerator::C_POINT.real(), JuliaGenerator::C_POINT.imag(), 0U,
+                };
+
+                return FRACTAL_OK;
+            }
+        );
+    }
+
+    auto fractal_create(fractal_params const * const params, fractal_generator ** const generator) -> fractal_status
+    {
+        return Guard(
+            [params, generator]() -> fractal_status
+            {
+                if (params == nullptr || generator == nullptr || params->size < sizeof(fractal_params))
+                {
+                    throw std::invalid_argument("The parameters must come from fractal_default_params.");
+                }
+
+                if (!IsValid(params->type) || !IsValid(params->layout))
+                {
+                    throw std::invalid_argument("Unknown fractal type or pixel layout.");
+                }
+
+                if (params->width == 0U || params->height == 0U || params->max_iterations == 0U)
+                {
+                    throw std::invalid_argument("The image size and the iteration count must be positive.");
+                }
+
+                Size const imageSize{params->width, params->height};
+                Viewport const viewport{
+                    {static_cast<float>(params->left), static_cast<float>(params->top)}, {static_cast<float>(params->right), static_cast<float>(params->bottom)}
+                };
+                auto const threads{params->threads > 0U ? static_cast<int>(params->threads) : oneapi::tbb::info::default_concurrency()};
+
+                auto handle{std::make_unique<fractal_generator>()};
+                handle->generator = MakeFractalGenerator(
+                    static_cast<FractalType>(params->type), imageSize, GetGrainSize(imageSize, threads), viewport, params->max_iterations,
+                    static_cast<PixelLayout>(params->layout), {static_cast<float>(params->julia_real), static_cast<float>(params->julia_imaginary)}
+                );
+
+                if (params->threads > 0U)
+                {
+                    handle->generator->SetThreads(threads);
+                }
+
+                *generator = handle.release();
+
+                return FRACTAL_OK;
+            }
+        );
+    }
+
+    auto fractal_destroy(fractal_generator * const generator) -> void
+    {
+        delete generator;
+    }
+
+    auto fractal_render(fractal_generator * const generator, std::uint8_t * const buffer, std::size_t const stride) -> fractal_status
+    {
+        return Guard(
+            [generator, buffer, stride]() -> fractal_status
+            {
+                if (generator == nullptr || buffer == nullptr)
+                {
+                    throw std::invalid_argument("The generator and the buffer must not be null.");
+                }
+
+                if (generator->isRendering.exchange(true, std::memory_order_acquire))
+                {
+                    lastError = "The generator is already rendering.";
+                    return FRACTAL_BUSY;
+                }
+
+                try
+                {
+                    generator->generator->UseBuffer(buffer, stride);
+                    generator->generator->Render();
+                }
+                catch (...)
+                {
+                    generator->isRendering.store(false, std::memory_order_release);
+                    throw;
+                }
+
+                generator->isRendering.store(false, std::memory_order_release);
+
+                if (generator->generator->IsCancelled())
+                {
+                    lastError = "The render was cancelled.";
+                    return FRACTAL_CANCELLED;
+                }
+
+                return FRACTAL_OK;
+            }
+        );
+    }
+
+    auto fractal_get_progress(fractal_generator const * const generator) -> double
+    {
+        return generator == nullptr ? 0.0 : generator->generator->GetProgress();
+    }
+
+    auto fractal_cancel(fractal_generator * const generator) -> void
+    {
+        if (generator != nullptr)
+        {
+            generator->generator->Cancel();
+        }
+    }
+
+    auto fractal_default_palette(std::uint8_t * const rgb) -> void
+    {
+        if (rgb == nullptr)
+        {
+            return;
+        }
+
+        for (std::size_t index{0}; index < DEFAULT_PALETTE.size(); ++index)
+        {
+            rgb[3U * index + 0U] = DEFAULT_PALETTE[index].red;
+            rgb[3U * index + 1U] = DEFAULT_PALETTE[index].green;
+            rgb[3U * index + 2U] = DEFAULT_PALETTE[index].blue;
+        }
+    }
+
+    auto fractal_bytes_per_pixel(fractal_layout const layout) -> std::size_t
+    {
+        return IsValid(layout) ? GetChannels(static_cast<PixelLayout>(layout)) : 0U;
+    }
+
+    auto fractal_last_error() -> char const *
+    {
+        return lastError.c_str();
+    }
+}
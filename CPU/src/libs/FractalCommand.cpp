@@ -0,0 +1,88 @@
+#include "FractalCommand.hpp"
+
+#include <chrono>
+#include <format>
+#include <optional>
+#include <print>
+#include <string>
+
+#include "PerfCounters.hpp"
+#include "TileProfile.hpp"
+
+
+auto ConfigureFromArguments(FractalGenerator & generator, int const argc, char const * const argv[]) -> void
+{
+    generator.SetMemoryLayout(ParseMemoryLayout(GetOption(argc, argv, "memory", "row")));
+    generator.SetExecutor(ParseExecutorType(GetOption(argc, argv, "executor", "tbb")));
+    generator.SetAllocation(ParseAllocation(GetOption(argc, argv, "allocation", "zeroed")), ParseHugePages(GetOption(argc, argv, "huge-pages", "none")));
+
+    generator.SetArenaOptions(GetArenaOptions(argc, argv));
+
+    if (auto const budget{GetOption(argc, argv, "budget", "")}; !budget.empty())
+    {
+        generator.SetTimeBudget(std::chrono::milliseconds{std::stol(std::string{budget})}, HasFlag(argc, argv, "coarse-fill"));
+    }
+
+    if (auto const efficientWeight{GetOption(argc, argv, "efficient-weight", "")}; !efficientWeight.empty())
+    {
+        generator.SetCoreWeight(CoreType::EFFICIENT, std::stod(std::string{efficientWeight}));
+    }
+
+    if (auto const partitioning{GetOption(argc, argv, "partitioning", "")}; !partitioning.empty())
+    {
+        generator.SetPartitioning(ParsePartitioning(partitioning));
+    }
+
+    if (auto const simdWidth{GetOption(argc, argv, "simd", "")}; !simdWidth.empty())
+    {
+        generator.SetSimdWidth(std::stoul(std::string{simdWidth}));
+    }
+
+    generator.EnableProfiling(!GetOption(argc, argv, "profile", "").empty());
+}
+
+auto RenderFromArguments(FractalGenerator & generator, int const argc, char const * const argv[]) -> void
+{
+    std::optional<PerfCounters> counters;
+
+    if (HasFlag(argc, argv, "counters"))
+    {
+        counters.emplace(generator.GetRenderArena());
+    }
+
+    TestSpeed(
+        [&generator, &counters]() -> void
+        {
+            if (counters)
+            {
+                counters->Start();
+            }
+
+            generator.Render();
+
+            if (counters)
+            {
+                counters->Stop();
+            }
+        }, std::format("{} fractal generation", generator.GetName())
+    );
+
+    if (generator.IsExpired())
+    {
+        std::println("The time budget ran out with {:.0f} % of the image rendered", 100.0 * generator.GetProgress());
+    }
+
+    std::string const defaultOutput{std::format("{}.png", generator.GetName())};
+    generator.Save(GetOption(argc, argv, "output", defaultOutput));
+
+    // Saving de-tiles the image, so its view is available in either memory layout
+    if (auto const profilePrefix{GetOption(argc, argv, "profile", "")}; !profilePrefix.empty())
+    {
+        WriteTileProfile(generator.GetTileRecords(), generator.GetView().size, profilePrefix);
+    }
+
+    if (counters)
+    {
+        PrintCounters(*counters, stdout);
+    }
+}
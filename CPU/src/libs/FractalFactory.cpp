@@ -0,0 +1,95 @@
+#include "FractalFactory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <format>
+#include <stdexcept>
+
+#include "CosineGenerator.hpp"
+#include "JuliaGenerator.hpp"
+#include "MandelbrotGenerator.hpp"
+#include "Trace.hpp"
+#include "TricornGenerator.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 4> NAMES{"Mandelbrot", "Julia", "Cosine", "Tricorn"};
+}
+
+
+auto ParseFractalType(std::string_view const name) -> FractalType
+{
+    auto const matches{
+        [name](std::string_view const candidate) -> bool
+        {
+            return std::ranges::equal(name, candidate, [](unsigned char const left, unsigned char const right) { return std::tolower(left) == std::tolower(right); });
+        }
+    };
+
+    if (auto const found{std::ranges::find_if(NAMES, matches)}; found != NAMES.end())
+    {
+        return static_cast<FractalType>(std::distance(NAMES.begin(), found));
+    }
+
+    throw std::invalid_argument(std::format("Unknown fractal {}.", name));
+}
+
+auto GetFractalName(FractalType const type) -> std::string_view
+{
+    return NAMES[static_cast<std::size_t>(type)];
+}
+
+auto GetDefaultViewport(FractalType const type) -> Viewport
+{
+    switch (type)
+    {
+        case FractalType::MANDELBROT:
+        {
+            return {MandelbrotGenerator::TOP_LEFT, MandelbrotGenerator::BOTTOM_RIGHT};
+        }
+        case FractalType::JULIA:
+        {
+            return {JuliaGenerator::TOP_LEFT, JuliaGenerator::BOTTOM_RIGHT};
+        }
+        case FractalType::COSINE:
+        {
+            return {CosineGenerator::TOP_LEFT, CosineGenerator::BOTTOM_RIGHT};
+        }
+        case FractalType::TRICORN:
+        {
+            return {TricornGenerator::TOP_LEFT, TricornGenerator::BOTTOM_RIGHT};
+        }
+    }
+
+    throw std::invalid_argument("Unknown fractal type.");
+}
+
+auto MakeFractalGenerator(FractalType const type, Size const & imageSize, Size const & grainSize, Viewport const & viewport, std::size_t const maxIterations,
+    PixelLayout const layout, Point const & juliaPoint) -> std::unique_ptr<FractalGenerator>
+{
+    TRACE_SCOPE("construct generator");
+
+    switch (type)
+    {
+        case FractalType::MANDELBROT:
+        {
+            return std::make_unique<MandelbrotGenerator>(imageSize, grainSize, viewport, maxIterations, layout);
+        }
+        case FractalType::JULIA:
+        {
+            return std::make_unique<JuliaGenerator>(imageSize, grainSize, viewport, maxIterations, juliaPoint, layout);
+        }
+        case FractalType::COSINE:
+        {
+            return std::make_unique<CosineGenerator>(imageSize, grainSize, viewport, maxIterations, layout);
+        }
+        case FractalType::TRICORN:
+        {
+            return std::make_unique<TricornGenerator>(imageSize, grainSize, viewport, maxIterations, layout);
+        }
+    }
+
+    throw std::invalid_argument("Unknown fractal type.");
+}
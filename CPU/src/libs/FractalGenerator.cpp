@@ -1,130 +1,1211 @@
 #include "FractalGenerator.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <future>
 #include <ranges>
 
-#include <opencv2/opencv.hpp>
+#include "CpuDispatch.hpp"
+#include "ImageWriter.hpp"
+#include "LaneKernels.hpp"
+#include "Trace.hpp"
 
 
-FractalGenerator::FractalGenerator(Size const & imageSize, Size const & grainSize, Point const & topLeft, Point const & bottomRight, std::size_t const maxIterations) : imageSize{imageSize},
-    grainSize{grainSize}, topLeft{topLeft}, bottomRight{bottomRight}, maxIterations{maxIterations}, logMaxIterations{static_cast<float>(std::log(maxIterations))}
+FractalGenerator::FractalGenerator(Size const & imageSize, Size const & grainSize, Point const & topLeft, Point const & bottomRight, std::size_t const maxIterations,
+    PixelLayout const layout) : imageSize{imageSize}, grainSize{grainSize}, topLeft{topLeft}, bottomRight{bottomRight},
+    viewportWidth{bottomRight.real() - topLeft.real()}, viewportHeight{topLeft.imag() - bottomRight.imag()}, frameSize{imageSize},
+    maxIterations{maxIterations},
+    logMaxIterations{static_cast<float>(std::log(maxIterations))}, layout{layout}, channels{GetChannels(layout)}, channelOrder{GetChannelOrder(layout)}, stride{imageSize.width * channels},
+    storageTiles{(imageSize.width + STORAGE_TILE_SIZE - 1U) / STORAGE_TILE_SIZE, (imageSize.height + STORAGE_TILE_SIZE - 1U) / STORAGE_TILE_SIZE},
+    cellPixels{std::make_unique<std::atomic<std::uint32_t>[]>(storageTiles.width * storageTiles.height)} { }
+
+auto FractalGenerator::PixelToPoint(Pixel const & pixel) const -> Point
 {
-    image.resize(imageSize.width * imageSize.height * CHANNELS);
+    auto const real{topLeft.real() + ((origin.x + pixel.x) * viewportWidth / frameSize.width)};
+    auto const imag{topLeft.imag() - ((origin.y + pixel.y) * viewportHeight / frameSize.height)};
+
+    return {real, imag};
 }
 
-auto FractalGenerator::PixelToPoint(Pixel const & pixel) const -> Point
+// In the tiled layout every 64×64 tile is stored contiguously, so a row pointer is only valid up to the end of its tile
+auto FractalGenerator::GetRowPointer(std::size_t const row, std::size_t const col) const -> std::uint8_t *
 {
-    static auto const WIDTH{bottomRight.real() - topLeft.real()};
-    static auto const HEIGHT{topLeft.imag() - bottomRight.imag()};
+    if (memoryLayout == MemoryLayout::ROW_MAJOR)
+    {
+        return pixels + row * stride + col * channels;
+    }
 
-    auto const real{topLeft.real() + (pixel.x * WIDTH / imageSize.width)};
-    auto const imag{topLeft.imag() - (pixel.y * HEIGHT / imageSize.height)};
+    auto const tile{(row / STORAGE_TILE_SIZE) * storageTiles.width + col / STORAGE_TILE_SIZE};
+    auto const offset{(row % STORAGE_TILE_SIZE) * STORAGE_TILE_SIZE + col % STORAGE_TILE_SIZE};
 
-    return {real, imag};
+    return pixels + (tile * STORAGE_TILE_SIZE * STORAGE_TILE_SIZE + offset) * channels;
 }
 
-auto FractalGenerator::Colorize(std::uint8_t & red, std::uint8_t & green, std::uint8_t & blue, std::size_t const value) -> void
-{
-    static constexpr std::array RED{
-        0.001462F, 0.002258F, 0.003279F, 0.004512F, 0.005950F, 0.007588F, 0.009426F, 0.011465F, 0.013708F, 0.016156F, 0.018815F, 0.021692F, 0.024792F, 0.028123F, 0.031696F, 0.035520F,
-        0.039608F, 0.043830F, 0.048062F, 0.052320F, 0.056615F, 0.060949F, 0.065330F, 0.069764F, 0.074257F, 0.078815F, 0.083446F, 0.088155F, 0.092949F, 0.097833F, 0.102815F, 0.107899F,
-        0.113094F, 0.118405F, 0.123833F, 0.129380F, 0.135053F, 0.140858F, 0.146785F, 0.152839F, 0.159018F, 0.165308F, 0.171713F, 0.178212F, 0.184801F, 0.191460F, 0.198177F, 0.204935F,
-        0.211718F, 0.218512F, 0.225302F, 0.232077F, 0.238826F, 0.245543F, 0.252220F, 0.258857F, 0.265447F, 0.271994F, 0.278493F, 0.284951F, 0.291366F, 0.297740F, 0.304081F, 0.310382F,
-        0.316654F, 0.322899F, 0.329114F, 0.335308F, 0.341482F, 0.347636F, 0.353773F, 0.359898F, 0.366012F, 0.372116F, 0.378211F, 0.384299F, 0.390384F, 0.396467F, 0.402548F, 0.408629F,
-        0.414709F, 0.420791F, 0.426877F, 0.432967F, 0.439062F, 0.445163F, 0.451271F, 0.457386F, 0.463508F, 0.469640F, 0.475780F, 0.481929F, 0.488088F, 0.494258F, 0.500438F, 0.506629F,
-        0.512831F, 0.519045F, 0.525270F, 0.531507F, 0.537755F, 0.544015F, 0.550287F, 0.556571F, 0.562866F, 0.569172F, 0.575490F, 0.581819F, 0.588158F, 0.594508F, 0.600868F, 0.607238F,
-        0.613617F, 0.620005F, 0.626401F, 0.632805F, 0.639216F, 0.645633F, 0.652056F, 0.658483F, 0.664915F, 0.671349F, 0.677786F, 0.684224F, 0.690661F, 0.697098F, 0.703532F, 0.709962F,
-        0.716387F, 0.722805F, 0.729216F, 0.735616F, 0.742004F, 0.748378F, 0.754737F, 0.761077F, 0.767398F, 0.773695F, 0.779968F, 0.786212F, 0.792427F, 0.798608F, 0.804752F, 0.810855F,
-        0.816914F, 0.822926F, 0.828886F, 0.834791F, 0.840636F, 0.846416F, 0.852126F, 0.857763F, 0.863320F, 0.868793F, 0.874176F, 0.879464F, 0.884651F, 0.889731F, 0.894700F, 0.899552F,
-        0.904281F, 0.908884F, 0.913354F, 0.917689F, 0.921884F, 0.925937F, 0.929845F, 0.933606F, 0.937221F, 0.940687F, 0.944006F, 0.947180F, 0.950210F, 0.953099F, 0.955849F, 0.958464F,
-        0.960949F, 0.963310F, 0.965549F, 0.967671F, 0.969680F, 0.971582F, 0.973381F, 0.975082F, 0.976690F, 0.978210F, 0.979645F, 0.981000F, 0.982279F, 0.983485F, 0.984622F, 0.985693F,
-        0.986700F, 0.987646F, 0.988533F, 0.989363F, 0.990138F, 0.990871F, 0.991558F, 0.992196F, 0.992785F, 0.993326F, 0.993834F, 0.994309F, 0.994738F, 0.995122F, 0.995480F, 0.995810F,
-        0.996096F, 0.996341F, 0.996580F, 0.996775F, 0.996925F, 0.997077F, 0.997186F, 0.997254F, 0.997325F, 0.997351F, 0.997351F, 0.997341F, 0.997285F, 0.997228F, 0.997138F, 0.997019F,
-        0.996898F, 0.996727F, 0.996571F, 0.996369F, 0.996162F, 0.995932F, 0.995680F, 0.995424F, 0.995131F, 0.994851F, 0.994524F, 0.994222F, 0.993866F, 0.993545F, 0.993170F, 0.992831F,
-        0.992440F, 0.992089F, 0.991688F, 0.991332F, 0.990930F, 0.990570F, 0.990175F, 0.989815F, 0.989434F, 0.989077F, 0.988717F, 0.988367F, 0.988033F, 0.987691F, 0.987387F, 0.987053F,
-    };
+auto FractalGenerator::GetColorIndex(std::size_t const iterations) const -> std::uint8_t
+{
+    if (iterations == maxIterations)
+    {
+        return 0;
+    }
+
+    return static_cast<std::uint8_t>(MAX_COLOR * std::log(iterations + 1) / logMaxIterations);
+}
+
+auto FractalGenerator::Colorize(std::uint8_t * const pixel, std::uint8_t const value) const -> void
+{
+    auto const & color{palette[value]};
+
+    pixel[channelOrder.red] = color.red;
+    pixel[channelOrder.green] = color.green;
+    pixel[channelOrder.blue] = color.blue;
+
+    if (channels == 4U)
+    {
+        pixel[3] = MAX_COLOR;
+    }
+}
+
+auto FractalGenerator::StorePixel(std::uint8_t * const pixel, std::size_t const iterations) const -> void
+{
+    auto const value{GetColorIndex(iterations)};
+
+    if (layout == PixelLayout::INDEXED)
+    {
+        *pixel = value;
+    }
+    else
+    {
+        Colorize(pixel, value);
+    }
+}
+
+auto FractalGenerator::RenderTile(Tile const & range) -> std::uint64_t
+{
+    TRACE_SCOPE("render tile");
+
+    std::uint64_t totalIterations{0};
+
+    std::array<Point, MAX_SIMD_WIDTH> points{};
+    std::array<std::size_t, MAX_SIMD_WIDTH> iterations{};
+
+    auto const lanes{GetSimdWidth()};
+
+    for (auto row{range.rows().begin()}; row < range.rows().end(); ++row)
+    {
+        auto * const rowPixels{GetRowPointer(row, range.cols().begin())};
+        auto col{range.cols().begin()};
+
+        // The last group of a row is padded with its last pixel, so that every pixel goes through the same kernel whatever the tile bounds are and tiles
+        // rendered apart match a whole render
+        if (lanes > 1U)
+        {
+            for (; col < range.cols().end(); col += lanes)
+            {
+                auto const count{std::min(lanes, range.cols().end() - col)};
+
+                for (std::size_t lane{0}; lane < lanes; ++lane)
+                {
+                    points[lane] = PixelToPoint({col + std::min(lane, count - 1U), row});
+                }
+
+                IterateLanes({points.data(), lanes}, {iterations.data(), lanes});
+
+                for (std::size_t lane{0}; lane < count; ++lane)
+                {
+                    totalIterations += iterations[lane];
+                    StorePixel(rowPixels + (col + lane - range.cols().begin()) * channels, iterations[lane]);
+                }
+            }
+        }
+        else
+        {
+            for (; col < range.cols().end(); ++col)
+            {
+                auto const pointIterations{Iterate(PixelToPoint({col, row}))};
+
+                totalIterations += pointIterations;
+                StorePixel(rowPixels + (col - range.cols().begin()) * channels, pointIterations);
+            }
+        }
+    }
+
+    return totalIterations;
+}
+
+auto FractalGenerator::IterateLanes(std::span<Point const> const startPoints, std::span<std::size_t> const iterations) const -> void
+{
+    for (std::size_t lane{0}; lane < startPoints.size(); ++lane)
+    {
+        iterations[lane] = Iterate(startPoints[lane]);
+    }
+}
+
+auto FractalGenerator::IteratePoints(std::span<Point const> const startPoints, std::span<std::size_t> const iterations) const -> void
+{
+    auto const lanes{GetSimdWidth()};
+    std::size_t point{0};
+
+    if (lanes > 1U)
+    {
+        for (; point + lanes <= startPoints.size(); point += lanes)
+        {
+            IterateLanes(startPoints.subspan(point, lanes), iterations.subspan(point, lanes));
+        }
+    }
+
+    for (; point < startPoints.size(); ++point)
+    {
+        iterations[point] = Iterate(startPoints[point]);
+    }
+}
 
-    static constexpr std::array GREEN{
-        0.000466F, 0.001295F, 0.002305F, 0.003490F, 0.004843F, 0.006356F, 0.008022F, 0.009828F, 0.011771F, 0.013840F, 0.016026F, 0.018320F, 0.020715F, 0.023201F, 0.025765F, 0.028397F,
-        0.031090F, 0.033830F, 0.036607F, 0.039407F, 0.042160F, 0.044794F, 0.047318F, 0.049726F, 0.052017F, 0.054184F, 0.056225F, 0.058133F, 0.059904F, 0.061531F, 0.063010F, 0.064335F,
-        0.065492F, 0.066479F, 0.067295F, 0.067935F, 0.068391F, 0.068654F, 0.068738F, 0.068637F, 0.068354F, 0.067911F, 0.067305F, 0.066576F, 0.065732F, 0.064818F, 0.063862F, 0.062907F,
-        0.061992F, 0.061158F, 0.060445F, 0.059889F, 0.059517F, 0.059352F, 0.059415F, 0.059706F, 0.060237F, 0.060994F, 0.061978F, 0.063168F, 0.064553F, 0.066117F, 0.067835F, 0.069702F,
-        0.071690F, 0.073782F, 0.075972F, 0.078236F, 0.080564F, 0.082946F, 0.085373F, 0.087831F, 0.090314F, 0.092816F, 0.095332F, 0.097855F, 0.100379F, 0.102902F, 0.105420F, 0.107930F,
-        0.110431F, 0.112920F, 0.115395F, 0.117855F, 0.120298F, 0.122724F, 0.125132F, 0.127522F, 0.129893F, 0.132245F, 0.134577F, 0.136891F, 0.139186F, 0.141462F, 0.143719F, 0.145958F,
-        0.148179F, 0.150383F, 0.152569F, 0.154739F, 0.156894F, 0.159033F, 0.161158F, 0.163269F, 0.165368F, 0.167454F, 0.169530F, 0.171596F, 0.173652F, 0.175701F, 0.177743F, 0.179779F,
-        0.181811F, 0.183840F, 0.185867F, 0.187893F, 0.189921F, 0.191952F, 0.193986F, 0.196027F, 0.198075F, 0.200133F, 0.202203F, 0.204286F, 0.206384F, 0.208501F, 0.210638F, 0.212797F,
-        0.214982F, 0.217194F, 0.219437F, 0.221713F, 0.224025F, 0.226377F, 0.228772F, 0.231214F, 0.233705F, 0.236249F, 0.238851F, 0.241514F, 0.244242F, 0.247040F, 0.249911F, 0.252861F,
-        0.255895F, 0.259016F, 0.262229F, 0.265540F, 0.268953F, 0.272473F, 0.276106F, 0.279857F, 0.283729F, 0.287728F, 0.291859F, 0.296125F, 0.300530F, 0.305079F, 0.309773F, 0.314616F,
-        0.319610F, 0.324755F, 0.330052F, 0.335500F, 0.341098F, 0.346844F, 0.352734F, 0.358764F, 0.364929F, 0.371224F, 0.377643F, 0.384178F, 0.390820F, 0.397563F, 0.404400F, 0.411324F,
-        0.418323F, 0.425390F, 0.432519F, 0.439703F, 0.446936F, 0.454210F, 0.461520F, 0.468861F, 0.476226F, 0.483612F, 0.491014F, 0.498428F, 0.505851F, 0.513280F, 0.520713F, 0.528148F,
-        0.535582F, 0.543015F, 0.550446F, 0.557873F, 0.565296F, 0.572706F, 0.580107F, 0.587502F, 0.594891F, 0.602275F, 0.609644F, 0.616999F, 0.624350F, 0.631696F, 0.639027F, 0.646344F,
-        0.653659F, 0.660969F, 0.668256F, 0.675541F, 0.682828F, 0.690088F, 0.697349F, 0.704611F, 0.711848F, 0.719089F, 0.726324F, 0.733545F, 0.740772F, 0.747981F, 0.755190F, 0.762398F,
-        0.769591F, 0.776795F, 0.783977F, 0.791167F, 0.798348F, 0.805527F, 0.812706F, 0.819875F, 0.827052F, 0.834213F, 0.841387F, 0.848540F, 0.855711F, 0.862859F, 0.870024F, 0.877168F,
-        0.884330F, 0.891470F, 0.898627F, 0.905763F, 0.912915F, 0.920049F, 0.927196F, 0.934329F, 0.941470F, 0.948604F, 0.955742F, 0.962878F, 0.970012F, 0.977154F, 0.984288F, 0.991438F,
+auto FractalGenerator::ProcessTile(Tile const & tile) -> void
+{
+    if (IsStopping())
+    {
+        return;
+    }
+
+    if (!isProfiling)
+    {
+        renderedIterations.fetch_add(RenderTile(tile), std::memory_order_relaxed);
+        MarkCompleted(tile);
+        return;
+    }
+
+    auto const elapsed{
+        [this]() -> double
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+        }
     };
 
-    static constexpr std::array BLUE{
-        0.013866F, 0.018331F, 0.023708F, 0.029965F, 0.037130F, 0.044973F, 0.052844F, 0.060750F, 0.068667F, 0.076603F, 0.084584F, 0.092610F, 0.100676F, 0.108787F, 0.116965F, 0.125209F,
-        0.133515F, 0.141886F, 0.150327F, 0.158841F, 0.167446F, 0.176129F, 0.184892F, 0.193735F, 0.202660F, 0.211667F, 0.220755F, 0.229922F, 0.239164F, 0.248477F, 0.257854F, 0.267289F,
-        0.276784F, 0.286321F, 0.295879F, 0.305443F, 0.315000F, 0.324538F, 0.334011F, 0.343404F, 0.352688F, 0.361816F, 0.370771F, 0.379497F, 0.387973F, 0.396152F, 0.404009F, 0.411514F,
-        0.418647F, 0.425392F, 0.431742F, 0.437695F, 0.443256F, 0.448436F, 0.453248F, 0.457710F, 0.461840F, 0.465660F, 0.469190F, 0.472451F, 0.475462F, 0.478243F, 0.480812F, 0.483186F,
-        0.485380F, 0.487408F, 0.489287F, 0.491024F, 0.492631F, 0.494121F, 0.495501F, 0.496778F, 0.497960F, 0.499053F, 0.500067F, 0.501002F, 0.501864F, 0.502658F, 0.503386F, 0.504052F,
-        0.504662F, 0.505215F, 0.505714F, 0.506160F, 0.506555F, 0.506901F, 0.507198F, 0.507448F, 0.507652F, 0.507809F, 0.507921F, 0.507989F, 0.508011F, 0.507988F, 0.507920F, 0.507806F,
-        0.507648F, 0.507443F, 0.507192F, 0.506895F, 0.506551F, 0.506159F, 0.505719F, 0.505230F, 0.504692F, 0.504105F, 0.503466F, 0.502777F, 0.502035F, 0.501241F, 0.500394F, 0.499492F,
-        0.498536F, 0.497524F, 0.496456F, 0.495332F, 0.494150F, 0.492910F, 0.491611F, 0.490253F, 0.488836F, 0.487358F, 0.485819F, 0.484219F, 0.482558F, 0.480835F, 0.479049F, 0.477201F,
-        0.475290F, 0.473316F, 0.471279F, 0.469180F, 0.467018F, 0.464794F, 0.462509F, 0.460162F, 0.457755F, 0.455289F, 0.452765F, 0.450184F, 0.447543F, 0.444848F, 0.442102F, 0.439305F,
-        0.436461F, 0.433573F, 0.430644F, 0.427671F, 0.424666F, 0.421631F, 0.418573F, 0.415496F, 0.412403F, 0.409303F, 0.406205F, 0.403118F, 0.400047F, 0.397002F, 0.393995F, 0.391037F,
-        0.388137F, 0.385308F, 0.382563F, 0.379915F, 0.377376F, 0.374959F, 0.372677F, 0.370541F, 0.368567F, 0.366762F, 0.365136F, 0.363701F, 0.362468F, 0.361438F, 0.360619F, 0.360014F,
-        0.359630F, 0.359469F, 0.359529F, 0.359810F, 0.360311F, 0.361030F, 0.361965F, 0.363111F, 0.364466F, 0.366025F, 0.367783F, 0.369734F, 0.371874F, 0.374198F, 0.376698F, 0.379371F,
-        0.382210F, 0.385210F, 0.388365F, 0.391671F, 0.395122F, 0.398714F, 0.402441F, 0.406299F, 0.410283F, 0.414390F, 0.418613F, 0.422950F, 0.427397F, 0.431951F, 0.436607F, 0.441361F,
-        0.446213F, 0.451160F, 0.456192F, 0.461314F, 0.466526F, 0.471811F, 0.477182F, 0.482635F, 0.488154F, 0.493755F, 0.499428F, 0.505167F, 0.510983F, 0.516859F, 0.522806F, 0.528821F,
-        0.534892F, 0.541039F, 0.547233F, 0.553499F, 0.559820F, 0.566202F, 0.572645F, 0.579140F, 0.585701F, 0.592307F, 0.598983F, 0.605696F, 0.612482F, 0.619299F, 0.626189F, 0.633109F,
-        0.640099F, 0.647116F, 0.654202F, 0.661309F, 0.668481F, 0.675675F, 0.682926F, 0.690198F, 0.697519F, 0.704863F, 0.712242F, 0.719649F, 0.727077F, 0.734536F, 0.742002F, 0.749504F,
+    auto const start{elapsed()};
+    auto const iterations{RenderTile(tile)};
+    auto const end{elapsed()};
+
+    renderedIterations.fetch_add(iterations, std::memory_order_relaxed);
+    MarkCompleted(tile);
+
+    tileRecords.push_back(
+        {{tile.cols().begin(), tile.rows().begin()}, {tile.cols().size(), tile.rows().size()}, start, end, iterations, executor->GetThreadIndex()}
+    );
+}
+
+// Checked before every tile. Cancelling the context as well keeps the TBB loops from splitting and scheduling the tiles that are left.
+auto FractalGenerator::IsStopping() -> bool
+{
+    if (isCancelled.load(std::memory_order_relaxed) || isExpired.load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+
+    if (timeBudget == std::chrono::milliseconds::zero() || std::chrono::steady_clock::now() < deadline)
+    {
+        return false;
+    }
+
+    isExpired.store(true, std::memory_order_relaxed);
+    renderContext.cancel_group_execution();
+
+    return true;
+}
+
+// A tile may straddle several cells, so every cell counts its own pixels and is complete once the count reaches its area. The count is acquired and released so that
+// the thread completing a cell sees the pixels the others wrote to it before it publishes the cell.
+auto FractalGenerator::MarkCompleted(Tile const & tile) -> void
+{
+    renderedPixels.fetch_add(tile.rows().size() * tile.cols().size(), std::memory_order_relaxed);
+
+    for (auto cellRow{tile.rows().begin() / STORAGE_TILE_SIZE}; cellRow * STORAGE_TILE_SIZE < tile.rows().end(); ++cellRow)
+    {
+        auto const rows{std::min(tile.rows().end(), (cellRow + 1U) * STORAGE_TILE_SIZE) - std::max(tile.rows().begin(), cellRow * STORAGE_TILE_SIZE)};
+
+        for (auto cellCol{tile.cols().begin() / STORAGE_TILE_SIZE}; cellCol * STORAGE_TILE_SIZE < tile.cols().end(); ++cellCol)
+        {
+            auto const cols{std::min(tile.cols().end(), (cellCol + 1U) * STORAGE_TILE_SIZE) - std::max(tile.cols().begin(), cellCol * STORAGE_TILE_SIZE)};
+
+            auto const cell{cellRow * storageTiles.width + cellCol};
+            auto const area{static_cast<std::uint32_t>(rows * cols)};
+            auto const completed{cellPixels[cell].fetch_add(area, std::memory_order_acq_rel) + area};
+
+            if (!tileStream)
+            {
+                continue;
+            }
+
+            if (auto const bounds{GetCell(cell)}; completed == bounds.rows().size() * bounds.cols().size())
+            {
+                tileStream->Publish({cell, {bounds.cols().begin(), bounds.rows().begin()}, GetCellView(bounds)});
+            }
+        }
+    }
+}
+
+// Costs a sixty-fourth of rendering the cells that are left, which is spent after the deadline
+auto FractalGenerator::FillCoarse() -> void
+{
+    TRACE_SCOPE("coarse fill");
+
+    executor->ParallelFor(
+        storageTiles.width * storageTiles.height, 1U, [this](std::size_t const begin, std::size_t const end) -> void
+        {
+            for (auto cell{begin}; cell < end; ++cell)
+            {
+                auto const bounds{GetCell(cell)};
+
+                if (cellPixels[cell].load(std::memory_order_relaxed) == bounds.rows().size() * bounds.cols().size())
+                {
+                    continue;
+                }
+
+                for (auto blockRow{bounds.rows().begin()}; blockRow < bounds.rows().end(); blockRow += COARSE_BLOCK_SIZE)
+                {
+                    auto const blockRowEnd{std::min(blockRow + COARSE_BLOCK_SIZE, bounds.rows().end())};
+
+                    for (auto blockCol{bounds.cols().begin()}; blockCol < bounds.cols().end(); blockCol += COARSE_BLOCK_SIZE)
+                    {
+                        auto const blockColEnd{std::min(blockCol + COARSE_BLOCK_SIZE, bounds.cols().end())};
+                        auto const iterations{Iterate(PixelToPoint({(blockCol + blockColEnd) / 2U, (blockRow + blockRowEnd) / 2U}))};
+
+                        for (auto row{blockRow}; row < blockRowEnd; ++row)
+                        {
+                            auto * const rowPixels{GetRowPointer(row, blockCol)};
+
+                            for (auto col{blockCol}; col < blockColEnd; ++col)
+                            {
+                                StorePixel(rowPixels + (col - blockCol) * channels, iterations);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    );
+}
+
+// A recycled buffer still holds whatever image it had before, which may be another render's, so a stopped render must not leave it in the cells it did not finish
+auto FractalGenerator::ClearUnfinished() -> void
+{
+    executor->ParallelFor(
+        storageTiles.width * storageTiles.height, 1U, [this](std::size_t const begin, std::size_t const end) -> void
+        {
+            for (auto cell{begin}; cell < end; ++cell)
+            {
+                auto const bounds{GetCell(cell)};
+
+                if (cellPixels[cell].load(std::memory_order_relaxed) == bounds.rows().size() * bounds.cols().size())
+                {
+                    continue;
+                }
+
+                for (auto row{bounds.rows().begin()}; row < bounds.rows().end(); ++row)
+                {
+                    std::memset(GetRowPointer(row, bounds.cols().begin()), 0, bounds.cols().size() * channels);
+                }
+            }
+        }
+    );
+}
+
+// Cells are whole storage tiles in the tiled layout, so their rows follow each other without a gap
+auto FractalGenerator::GetCellView(Tile const & cell) const -> ImageView
+{
+    auto const cellStride{memoryLayout == MemoryLayout::TILED ? STORAGE_TILE_SIZE * channels : stride};
+
+    return {GetRowPointer(cell.rows().begin(), cell.cols().begin()), {cell.cols().size(), cell.rows().size()}, cellStride, layout, &palette};
+}
+
+auto FractalGenerator::GetCell(std::size_t const cell) const -> Tile
+{
+    auto const row{cell / storageTiles.width * STORAGE_TILE_SIZE};
+    auto const col{cell % storageTiles.width * STORAGE_TILE_SIZE};
+
+    return {
+        row, std::min(row + STORAGE_TILE_SIZE, imageSize.height), STORAGE_TILE_SIZE,
+        col, std::min(col + STORAGE_TILE_SIZE, imageSize.width), STORAGE_TILE_SIZE,
     };
+}
+
+auto FractalGenerator::Probe() -> void
+{
+    TRACE_SCOPE("probe");
+
+    Size const cells{(imageSize.width + probeStep - 1U) / probeStep, (imageSize.height + probeStep - 1U) / probeStep};
+
+    costGrid = {cells, probeStep, std::vector<double>(cells.width * cells.height)};
 
-    red = static_cast<std::uint8_t>(MAX_COLOR * RED[value]);
-    green = static_cast<std::uint8_t>(MAX_COLOR * GREEN[value]);
-    blue = static_cast<std::uint8_t>(MAX_COLOR * BLUE[value]);
+    executor->ParallelFor(
+        cells.height, 1U, [this, &cells](std::size_t const begin, std::size_t const end) -> void
+        {
+            for (auto row{begin}; row < end; ++row)
+            {
+                for (std::size_t col{0}; col < cells.width; ++col)
+                {
+                    Pixel const sample{std::min(col * probeStep + probeStep / 2U, imageSize.width - 1U), std::min(row * probeStep + probeStep / 2U, imageSize.height - 1U)};
+
+                    // The extra unit stands for the fixed cost of mapping and storing a pixel
+                    costGrid.costs[row * cells.width + col] = static_cast<double>(Iterate(PixelToPoint(sample))) + 1.0;
+                }
+            }
+        }
+    );
 }
 
-auto FractalGenerator::Render() -> void
+auto FractalGenerator::GetScheduledTiles() -> std::vector<Tile> const &
+{
+    auto const tileCount{static_cast<std::size_t>(executor->GetConcurrency()) * TILES_PER_THREAD};
+
+    if (!scheduledTiles.empty() && scheduledPartitioning == partitioning && scheduledTileCount == tileCount)
+    {
+        return scheduledTiles;
+    }
+
+    if (partitioning == Partitioning::MORTON || partitioning == Partitioning::HILBERT)
+    {
+        scheduledTiles = MakeCurveTiles(imageSize, STORAGE_TILE_SIZE, partitioning);
+        scheduledPartitioning = partitioning;
+        scheduledTileCount = tileCount;
+
+        return scheduledTiles;
+    }
+
+    // The probe only depends on the viewport and the frame, so it is kept for every later schedule until SetFrame moves the image
+    if (costGrid.costs.empty())
+    {
+        Probe();
+    }
+
+    scheduledTiles = partitioning == Partitioning::BALANCED ? SplitByCost(costGrid, imageSize, tileCount) : SortByCost(costGrid, imageSize, tileCount);
+    scheduledPartitioning = partitioning;
+    scheduledTileCount = tileCount;
+
+    return scheduledTiles;
+}
+
+template <typename Partitioner, typename Visitor>
+auto FractalGenerator::ForEachRange(Partitioner && partitioner, Visitor const & visitor) -> void
 {
     using namespace oneapi::tbb;
 
-    static affinity_partitioner affinityPartitioner;
+    if (memoryLayout == MemoryLayout::ROW_MAJOR)
+    {
+        auto const range2d{Tile{0U, imageSize.height, grainSize.height, 0U, imageSize.width, grainSize.width}};
+
+        parallel_for(range2d, [&visitor](auto const & range) -> void { visitor(range); }, partitioner, renderContext);
+        return;
+    }
 
-    auto const range2d{blocked_range2d<std::size_t>{0U, imageSize.height, grainSize.height, 0U, imageSize.width, grainSize.width}};
+    // The same split over whole storage tiles, so that no render tile straddles two of them
+    auto const tileGrain{[](std::size_t const grain) { return std::max(1UZ, grain / STORAGE_TILE_SIZE); }};
+    auto const range2d{Tile{0U, storageTiles.height, tileGrain(grainSize.height), 0U, storageTiles.width, tileGrain(grainSize.width)}};
 
-    auto const process{
-        [this](auto const & range) -> void
+    parallel_for(
+        range2d, [this, &visitor](auto const & range) -> void
         {
-            for (auto row{range.rows().begin()}; row < range.rows().end(); ++row)
+            for (auto tileRow{range.rows().begin()}; tileRow < range.rows().end(); ++tileRow)
             {
-                for (auto col{range.cols().begin()}; col < range.cols().end(); ++col)
+                for (auto tileCol{range.cols().begin()}; tileCol < range.cols().end(); ++tileCol)
                 {
-                    auto const point = PixelToPoint({col, row});
-                    auto const value = Generate(point);
-                    Colorize(image[(row * imageSize.width + col) * CHANNELS + 0], image[(row * imageSize.width + col) * CHANNELS + 1], image[(row * imageSize.width + col) * CHANNELS + 2], value);
+                    visitor(Tile{
+                        tileRow * STORAGE_TILE_SIZE, std::min((tileRow + 1U) * STORAGE_TILE_SIZE, imageSize.height), STORAGE_TILE_SIZE,
+                        tileCol * STORAGE_TILE_SIZE, std::min((tileCol + 1U) * STORAGE_TILE_SIZE, imageSize.width), STORAGE_TILE_SIZE,
+                    });
                 }
             }
+        }, partitioner, renderContext
+    );
+}
+
+// Every claim takes a band of rows scaled by the weight of the core type the claiming thread runs on, so that slower cores take less work at a time
+template <typename Visitor>
+auto FractalGenerator::ForEachWeightedBand(std::atomic<std::size_t> & nextRow, Visitor const & visitor) -> void
+{
+    // Bands stay aligned to whole storage tiles in the tiled layout
+    auto const unit{memoryLayout == MemoryLayout::TILED ? STORAGE_TILE_SIZE : 1UZ};
+    auto const units{(imageSize.height + unit - 1U) / unit};
+    auto const baseUnits{static_cast<double>(units) / static_cast<double>(static_cast<std::size_t>(executor->GetConcurrency()) * TILES_PER_THREAD)};
+
+    while (true)
+    {
+        auto const weight{coreWeights[static_cast<std::size_t>(GetCurrentCoreType())]};
+        auto const claim{std::max(1UZ, static_cast<std::size_t>(std::lround(baseUnits * weight)))};
+        auto const first{nextRow.fetch_add(claim)};
+
+        if (first >= units)
+        {
+            return;
         }
-    };
 
-    parallel_for(range2d, process, affinityPartitioner);
+        auto const rowBegin{first * unit};
+        auto const rowEnd{std::min((first + claim) * unit, imageSize.height)};
+
+        if (memoryLayout == MemoryLayout::ROW_MAJOR)
+        {
+            visitor(Tile{rowBegin, rowEnd, rowEnd - rowBegin, 0U, imageSize.width, imageSize.width});
+            continue;
+        }
+
+        for (std::size_t col{0}; col < imageSize.width; col += STORAGE_TILE_SIZE)
+        {
+            visitor(Tile{rowBegin, rowEnd, rowEnd - rowBegin, col, std::min(col + STORAGE_TILE_SIZE, imageSize.width), STORAGE_TILE_SIZE});
+        }
+    }
+}
+
+// The other backends only run flat loops, so the range-splitting partitionings become a uniform grid of grain-sized tiles for them
+template <typename Visitor>
+auto FractalGenerator::ForEachTileWithExecutor(Visitor const & visitor) -> void
+{
+    if (partitioning == Partitioning::WEIGHTED)
+    {
+        std::atomic<std::size_t> nextRow{0};
+
+        executor->ParallelFor(
+            static_cast<std::size_t>(executor->GetConcurrency()), 1U, [this, &nextRow, &visitor](std::size_t const begin, std::size_t const end) -> void
+            {
+                for (auto task{begin}; task < end; ++task)
+                {
+                    ForEachWeightedBand(nextRow, visitor);
+                }
+            }
+        );
+        return;
+    }
+
+    std::vector<Tile> gridTiles;
+    auto const * tiles{&gridTiles};
+
+    if (partitioning == Partitioning::AFFINITY || partitioning == Partitioning::AUTO || partitioning == Partitioning::STATIC)
+    {
+        auto const tileSize{memoryLayout == MemoryLayout::TILED ? Size{STORAGE_TILE_SIZE, STORAGE_TILE_SIZE} : grainSize};
+
+        for (std::size_t row{0}; row < imageSize.height; row += tileSize.height)
+        {
+            for (std::size_t col{0}; col < imageSize.width; col += tileSize.width)
+            {
+                gridTiles.emplace_back(
+                    row, std::min(row + tileSize.height, imageSize.height), tileSize.height, col, std::min(col + tileSize.width, imageSize.width), tileSize.width
+                );
+            }
+        }
+    }
+    else
+    {
+        tiles = &GetScheduledTiles();
+    }
 
-    isRendered = true;
+    executor->ParallelFor(
+        tiles->size(), 1U, [tiles, &visitor](std::size_t const begin, std::size_t const end) -> void
+        {
+            for (auto index{begin}; index < end; ++index)
+            {
+                visitor((*tiles)[index]);
+            }
+        }
+    );
 }
 
-auto FractalGenerator::Save(std::string_view const & filename) -> void
+template <typename Visitor>
+auto FractalGenerator::ForEachTile(Visitor const & visitor) -> void
 {
-    using namespace cv;
+    using namespace oneapi::tbb;
 
-    if (!isRendered)
+    if (executor->GetType() != ExecutorType::TBB)
     {
-        throw std::runtime_error("The fractal has not been rendered yet.");
+        ForEachTileWithExecutor(visitor);
+        return;
+    }
+
+    switch (partitioning)
+    {
+        case Partitioning::AFFINITY:
+        {
+            ForEachRange(affinityPartitioner, visitor);
+            break;
+        }
+        case Partitioning::AUTO:
+        {
+            ForEachRange(auto_partitioner{}, visitor);
+            break;
+        }
+        case Partitioning::STATIC:
+        {
+            ForEachRange(static_partitioner{}, visitor);
+            break;
+        }
+        case Partitioning::BALANCED:
+        {
+            auto const & tiles{GetScheduledTiles()};
+
+            parallel_for(
+                blocked_range<std::size_t>{0U, tiles.size(), 1U}, [&tiles, &visitor](auto const & range) -> void
+                {
+                    for (auto index{range.begin()}; index < range.end(); ++index)
+                    {
+                        visitor(tiles[index]);
+                    }
+                }, simple_partitioner{}, renderContext
+            );
+            break;
+        }
+        case Partitioning::LONGEST_FIRST:
+        {
+            auto const & tiles{GetScheduledTiles()};
+
+            // A shared cursor keeps the descending cost order, which recursive range splitting would not
+            std::atomic<std::size_t> nextTile{0};
+
+            parallel_for(
+                0, this_task_arena::max_concurrency(), [&tiles, &nextTile, &visitor](int) -> void
+                {
+                    for (auto index{nextTile++}; index < tiles.size(); index = nextTile++)
+                    {
+                        visitor(tiles[index]);
+                    }
+                }, renderContext
+            );
+            break;
+        }
+        case Partitioning::WEIGHTED:
+        {
+            std::atomic<std::size_t> nextRow{0};
+
+            parallel_for(0, this_task_arena::max_concurrency(), [this, &nextRow, &visitor](int) -> void { ForEachWeightedBand(nextRow, visitor); }, renderContext);
+            break;
+        }
+        case Partitioning::MORTON:
+        case Partitioning::HILBERT:
+        {
+            auto const & tiles{GetScheduledTiles()};
+
+            // Consecutive curve positions are spatial neighbours, so each contiguous chunk a thread takes stays compact
+            parallel_for(
+                blocked_range<std::size_t>{0U, tiles.size()}, [&tiles, &visitor](auto const & range) -> void
+                {
+                    for (auto index{range.begin()}; index < range.end(); ++index)
+                    {
+                        visitor(tiles[index]);
+                    }
+                }, renderContext
+            );
+            break;
+        }
     }
+}
 
-    Mat const imageRGB{static_cast<int>(imageSize.height), static_cast<int>(imageSize.width), CV_8UC3, image.data()};
-    Mat const imageBGR{imageRGB.size(), CV_8UC3};
-    cvtColor(imageRGB, imageBGR, COLOR_RGB2BGR);
-    imwrite(filename.data(), imageBGR);
+// One write per page is enough for the kernel to place it on the node of the writing thread
+auto FractalGenerator::TouchTile(Tile const & tile) const -> void
+{
+    auto const pageSize{GetPageSize(hugePages)};
+
+    for (auto row{tile.rows().begin()}; row < tile.rows().end(); ++row)
+    {
+        auto * const begin{GetRowPointer(row, tile.cols().begin())};
+        auto * const end{begin + tile.cols().size() * channels};
+
+        for (auto * page{begin}; page < end; page += pageSize - reinterpret_cast<std::uintptr_t>(page) % pageSize)
+        {
+            *page = 0;
+        }
+    }
+}
+
+auto FractalGenerator::AllocateImage() -> void
+{
+    TRACE_SCOPE("allocate buffer");
+
+    auto const tiledSize{storageTiles.width * storageTiles.height * STORAGE_TILE_SIZE * STORAGE_TILE_SIZE * channels};
+
+    image = bufferPool->Acquire(memoryLayout == MemoryLayout::TILED ? tiledSize : stride * imageSize.height, hugePages);
+    pixels = image.GetData();
+
+    // Every pixel is written by the render, or cleared when the render stops early, so a recycled buffer is neither cleared nor touched again
+    if (image.IsRecycled())
+    {
+        return;
+    }
+
+    if (allocation == Allocation::ZEROED)
+    {
+        std::memset(pixels, 0, image.GetSize());
+        return;
+    }
+
+    // The pages are faulted in with the same tile-to-thread assignment as the render, which the affinity partitioner then replays
+    ForEachTile([this](Tile const & tile) -> void { TouchTile(tile); });
+}
+
+auto FractalGenerator::Render() -> void
+{
+    BeginRender();
+    FinishRender();
+}
+
+// Runs the render that BeginRender started and ends it, also when it throws
+auto FractalGenerator::FinishRender() -> void
+{
+    try
+    {
+        if (renderArena)
+        {
+            renderArena->execute([this]() -> void { RenderInArena(); });
+        }
+        else
+        {
+            RenderInArena();
+        }
+    }
+    catch (...)
+    {
+        EndRender();
+        throw;
+    }
+
+    EndRender();
+}
+
+auto FractalGenerator::BeginRender() -> void
+{
+    {
+        std::scoped_lock const lock{renderMutex};
+
+        // A second render would share the image, the completion mask and the context of the one in flight
+        if (isRendering)
+        {
+            throw std::logic_error("The generator is already rendering.");
+        }
+
+        isRendering = true;
+        isCancelled = false;
+    }
+
+    isExpired = false;
+    renderedPixels = 0U;
+    deadline = std::chrono::steady_clock::now() + timeBudget;
+
+    // Reading or applying the cache can throw, which must not leave the generator rendering forever
+    try
+    {
+        ApplyCachedTuning();
+    }
+    catch (...)
+    {
+        EndRender();
+        throw;
+    }
+}
+
+// A tuned configuration from the cache is only picked up when nothing was configured explicitly
+auto FractalGenerator::ApplyCachedTuning() -> void
+{
+    if (!isConfigured && !isTuningChecked)
+    {
+        isTuningChecked = true;
+
+        auto const config{LookupTuning(GetTuningKey())};
+
+        // The cache is tuned row-major, and a cost-ordered partitioning cannot render the tiled layout
+        auto const isCostOrdered{config && (config->partitioning == Partitioning::BALANCED || config->partitioning == Partitioning::LONGEST_FIRST)};
+
+        if (config && !(memoryLayout == MemoryLayout::TILED && isCostOrdered))
+        {
+            ApplyTuning(*config);
+        }
+    }
+}
+
+auto FractalGenerator::GetRenderArena() -> oneapi::tbb::task_arena *
+{
+    ApplyCachedTuning();
+
+    return renderArena ? &*renderArena : nullptr;
+}
+
+auto FractalGenerator::EndRender() -> void
+{
+    std::scoped_lock const lock{renderMutex};
+
+    // Closed before the flag drops, so that the next render cannot have its own stream replaced by this one
+    if (tileStream)
+    {
+        tileStream->Close();
+        tileStream = nullptr;
+    }
+
+    isRendering = false;
+    renderContext.reset();
+}
+
+auto FractalGenerator::RenderAsync(oneapi::tbb::task_arena * const arena) -> AsyncRender
+{
+    auto stream{std::make_shared<TileStream>(storageTiles.width * storageTiles.height)};
+
+    // Begun on the calling thread, so that a cancel right after this returns finds the render in flight
+    BeginRender();
+
+    tileStream = stream;
+
+    std::future<void> done;
+
+    try
+    {
+        done = std::async(
+            std::launch::async, [this, arena]() -> void
+            {
+                if (arena != nullptr)
+                {
+                    arena->execute([this]() -> void { FinishRender(); });
+                }
+                else
+                {
+                    FinishRender();
+                }
+            }
+        );
+    }
+    catch (...)
+    {
+        EndRender();
+        throw;
+    }
+
+    return {std::move(done), std::move(stream)};
+}
+
+auto FractalGenerator::RenderInArena() -> void
+{
+    using namespace oneapi::tbb;
+
+    TRACE_SCOPE("render");
+
+    auto const isCostOrdered{partitioning == Partitioning::BALANCED || partitioning == Partitioning::LONGEST_FIRST};
+
+    if (memoryLayout == MemoryLayout::TILED && isCostOrdered)
+    {
+        throw std::invalid_argument(std::format("The {} partitioning cannot render into the tiled memory layout.", GetPartitioningName(partitioning)));
+    }
+
+    if (pixels == nullptr)
+    {
+        AllocateImage();
+    }
+
+    isDetiled = false;
+    renderedIterations = 0U;
+
+    for (std::size_t cell{0}; cell < storageTiles.width * storageTiles.height; ++cell)
+    {
+        cellPixels[cell].store(0U, std::memory_order_relaxed);
+    }
+
+    if (isProfiling)
+    {
+        tileRecords.clear();
+        renderStart = std::chrono::steady_clock::now();
+    }
+
+    ForEachTile([this](Tile const & tile) -> void { ProcessTile(tile); });
+
+    if (isExpired && isCoarseFilled && !isCancelled)
+    {
+        FillCoarse();
+    }
+    else if (isExpired || isCancelled)
+    {
+        ClearUnfinished();
+    }
+
+    isRendered = !isCancelled;
+}
+
+auto FractalGenerator::Cancel() -> void
+{
+    std::scoped_lock const lock{renderMutex};
+
+    if (isRendering)
+    {
+        isCancelled = true;
+        renderContext.cancel_group_execution();
+    }
+}
+
+auto FractalGenerator::IsCancelled() const -> bool
+{
+    return isCancelled;
+}
+
+auto FractalGenerator::GetProgress() const -> double
+{
+    return static_cast<double>(renderedPixels.load(std::memory_order_relaxed)) / static_cast<double>(imageSize.width * imageSize.height);
+}
+
+auto FractalGenerator::SetTimeBudget(std::chrono::milliseconds const budget, bool const coarseFill) -> void
+{
+    if (budget < std::chrono::milliseconds::zero())
+    {
+        throw std::invalid_argument("The time budget must not be negative.");
+    }
+
+    timeBudget = budget;
+    isCoarseFilled = coarseFill;
+}
+
+auto FractalGenerator::IsExpired() const -> bool
+{
+    return isExpired;
+}
+
+auto FractalGenerator::GetCompletedTiles() const -> TileMask
+{
+    TileMask mask{{STORAGE_TILE_SIZE, STORAGE_TILE_SIZE}, storageTiles, std::vector<std::uint8_t>(storageTiles.width * storageTiles.height)};
+
+    for (std::size_t cell{0}; cell < mask.completed.size(); ++cell)
+    {
+        auto const bounds{GetCell(cell)};
+
+        mask.completed[cell] = cellPixels[cell].load(std::memory_order_relaxed) == bounds.rows().size() * bounds.cols().size() ? 1U : 0U;
+    }
+
+    return mask;
+}
+
+auto FractalGenerator::Save(std::string_view const & filename) -> void
+{
+    if (!isRendered)
+    {
+        throw std::runtime_error("The fractal has not been rendered yet.");
+    }
+
+    Detile();
+
+    TRACE_SCOPE("save");
+
+    WriteImage(GetView(), filename);
+}
+
+auto FractalGenerator::Detile() -> void
+{
+    if (memoryLayout == MemoryLayout::ROW_MAJOR || isDetiled)
+    {
+        return;
+    }
+
+    TRACE_SCOPE("detile");
+
+    auto const rowSize{imageSize.width * channels};
+
+    if (detiledImage.GetSize() != rowSize * imageSize.height)
+    {
+        detiledImage = bufferPool->Acquire(rowSize * imageSize.height);
+    }
+
+    executor->ParallelFor(
+        imageSize.height, 1U, [this, rowSize](std::size_t const begin, std::size_t const end) -> void
+        {
+            for (auto row{begin}; row < end; ++row)
+            {
+                for (std::size_t col{0}; col < imageSize.width; col += STORAGE_TILE_SIZE)
+                {
+                    auto const width{std::min(STORAGE_TILE_SIZE, imageSize.width - col)};
+
+                    std::memcpy(detiledImage.GetData() + row * rowSize + col * channels, GetRowPointer(row, col), width * channels);
+                }
+            }
+        }
+    );
+
+    isDetiled = true;
+}
+
+auto FractalGenerator::GetView() const -> ImageView
+{
+    if (memoryLayout == MemoryLayout::ROW_MAJOR)
+    {
+        return {pixels, imageSize, stride, layout, &palette};
+    }
+
+    if (!isDetiled)
+    {
+        throw std::runtime_error("The tiled image has not been detiled yet.");
+    }
+
+    return {detiledImage.GetData(), imageSize, imageSize.width * channels, layout, &palette};
+}
+
+auto FractalGenerator::GetImageSize() const -> Size const &
+{
+    return imageSize;
+}
+
+auto FractalGenerator::GetPixelLayout() const -> PixelLayout
+{
+    return layout;
+}
+
+auto FractalGenerator::CountIterations() const -> std::uint64_t
+{
+    using namespace oneapi::tbb;
+
+    return parallel_reduce(
+        blocked_range<std::size_t>{0U, imageSize.height}, std::uint64_t{0}, [this](auto const & range, std::uint64_t total) -> std::uint64_t
+        {
+            for (auto row{range.begin()}; row < range.end(); ++row)
+            {
+                for (std::size_t col{0}; col < imageSize.width; ++col)
+                {
+                    total += Iterate(PixelToPoint({col, row}));
+                }
+            }
+
+            return total;
+        }, std::plus{}
+    );
+}
+
+auto FractalGenerator::GetRenderedIterations() const -> std::uint64_t
+{
+    return renderedIterations.load(std::memory_order_relaxed);
+}
+
+// A row stride set before is kept, the tiled layout only stores rows without padding
+auto FractalGenerator::SetMemoryLayout(MemoryLayout const newMemoryLayout) -> void
+{
+    if (newMemoryLayout == MemoryLayout::TILED && stride != imageSize.width * channels)
+    {
+        throw std::invalid_argument("The tiled memory layout cannot use a custom row stride.");
+    }
+
+    memoryLayout = newMemoryLayout;
+    pixels = nullptr;
+    image = {};
+    detiledImage = {};
+    isRendered = false;
+    isDetiled = false;
+}
+
+auto FractalGenerator::SetFrame(Size const & newFrameSize, Pixel const & newOrigin) -> void
+{
+    if (newOrigin.x + imageSize.width > newFrameSize.width || newOrigin.y + imageSize.height > newFrameSize.height)
+    {
+        throw std::invalid_argument("The image must lie within its frame.");
+    }
+
+    // The probe was taken through the old mapping from pixels to points
+    costGrid = {};
+    scheduledTiles.clear();
+
+    frameSize = newFrameSize;
+    origin = newOrigin;
+    isRendered = false;
+}
+
+auto FractalGenerator::SetGrainSize(Size const & newGrainSize) -> void
+{
+    grainSize = {std::max(1UZ, newGrainSize.width), std::max(1UZ, newGrainSize.height)};
+    isConfigured = true;
+}
+
+auto FractalGenerator::SetSimdWidth(std::size_t const newSimdWidth) -> void
+{
+    if (std::ranges::find(SIMD_WIDTHS, newSimdWidth) == SIMD_WIDTHS.end())
+    {
+        throw std::invalid_argument(std::format("Unsupported SIMD width {}.", newSimdWidth));
+    }
+
+    simdWidth = newSimdWidth;
+    isConfigured = true;
+}
+
+auto FractalGenerator::GetSimdWidth() const -> std::size_t
+{
+    if (simdWidth != 0U)
+    {
+        return simdWidth;
+    }
+
+    return HasLaneKernel() ? GetLaneWidth(GetActiveInstructionSet()) : 1U;
+}
+
+auto FractalGenerator::HasLaneKernel() const -> bool
+{
+    return false;
+}
+
+auto FractalGenerator::SetThreads(int const threads) -> void
+{
+    arenaOptions.maxConcurrency = threads;
+    ResetArena();
+
+    isConfigured = true;
+}
+
+auto FractalGenerator::SetArenaOptions(ArenaOptions const & options) -> void
+{
+    arenaOptions = options;
+    ResetArena();
+
+    // An explicit thread count wins over the tuned one, the other constraints still leave room for tuning
+    if (options.maxConcurrency > 0)
+    {
+        isConfigured = true;
+    }
+}
+
+auto FractalGenerator::SetCoreWeight(CoreType const coreType, double const weight) -> void
+{
+    if (weight <= 0.0)
+    {
+        throw std::invalid_argument("A core weight must be positive.");
+    }
+
+    coreWeights[static_cast<std::size_t>(coreType)] = weight;
+}
+
+auto FractalGenerator::SetExecutor(ExecutorType const type) -> void
+{
+    executor = MakeExecutor(type, type == ExecutorType::TBB ? 0 : arenaOptions.maxConcurrency);
+}
+
+auto FractalGenerator::SetBufferPool(BufferPool & pool) -> void
+{
+    bufferPool = &pool;
+    pixels = nullptr;
+    image = {};
+    detiledImage = {};
+    isRendered = false;
+}
+
+auto FractalGenerator::SetAllocation(Allocation const newAllocation, HugePages const newHugePages) -> void
+{
+    allocation = newAllocation;
+    hugePages = newHugePages;
+    pixels = nullptr;
+    image = {};
+    isRendered = false;
+}
+
+// The render runs in its own arena whenever it is limited to fewer threads or constrained to some of the CPUs
+auto FractalGenerator::ResetArena() -> void
+{
+    using namespace oneapi::tbb;
+
+    arenaPinning.reset();
+
+    // The TBB executor runs inside the render arena, the others manage their own threads
+    if (executor->GetType() != ExecutorType::TBB)
+    {
+        executor = MakeExecutor(executor->GetType(), arenaOptions.maxConcurrency);
+    }
+
+    auto const isLimited{arenaOptions.maxConcurrency > 0 && arenaOptions.maxConcurrency < info::default_concurrency()};
+
+    if (!arenaOptions.IsConstrained())
+    {
+        if (isLimited)
+        {
+            renderArena.emplace(arenaOptions.maxConcurrency);
+        }
+        else
+        {
+            renderArena.reset();
+        }
+
+        return;
+    }
+
+    renderArena.emplace();
+    InitializeArena(*renderArena, arenaOptions, arenaPinning);
+}
+
+auto FractalGenerator::ApplyTuning(TuningConfig const & config) -> void
+{
+    SetGrainSize(config.grainSize);
+    SetPartitioning(config.partitioning);
+
+    // Older caches may hold a width for a generator without a lane kernel, where it would only batch the scalar loop
+    if (HasLaneKernel())
+    {
+        SetSimdWidth(config.simdWidth);
+    }
+
+    SetThreads(config.threads);
+}
+
+auto FractalGenerator::GetTuningKey() const -> TuningKey
+{
+    return {std::string{GetName()}, imageSize, maxIterations, layout, oneapi::tbb::info::default_concurrency()};
+}
+
+auto FractalGenerator::SetPartitioning(Partitioning const newPartitioning, std::size_t const newProbeStep) -> void
+{
+    if (newProbeStep == 0U)
+    {
+        throw std::invalid_argument("The probe step must be at least one pixel.");
+    }
+
+    if (newProbeStep != probeStep)
+    {
+        costGrid = {};
+        scheduledTiles.clear();
+    }
+
+    partitioning = newPartitioning;
+    probeStep = newProbeStep;
+    isConfigured = true;
+}
+
+auto FractalGenerator::EnableProfiling(bool const enabled) -> void
+{
+    isProfiling = enabled;
+    tileRecords.clear();
+}
+
+auto FractalGenerator::GetTileRecords() const -> std::vector<TileRecord>
+{
+    return {tileRecords.begin(), tileRecords.end()};
+}
+
+auto FractalGenerator::SetStride(std::size_t const newStride) -> void
+{
+    if (newStride < imageSize.width * channels)
+    {
+        throw std::invalid_argument("The row stride is smaller than a row of pixels.");
+    }
+
+    if (memoryLayout == MemoryLayout::TILED && newStride != imageSize.width * channels)
+    {
+        throw std::invalid_argument("The tiled memory layout cannot use a custom row stride.");
+    }
+
+    stride = newStride;
+    pixels = nullptr;
+    image = {};
+    isRendered = false;
+}
+
+auto FractalGenerator::UseBuffer(std::uint8_t * const buffer, std::size_t const bufferStride) -> void
+{
+    if (memoryLayout == MemoryLayout::TILED)
+    {
+        throw std::invalid_argument("External buffers must use the row-major memory layout.");
+    }
+
+    SetStride(bufferStride);
+
+    pixels = buffer;
+}
+
+auto FractalGenerator::SetPalette(Palette const & newPalette) -> void
+{
+    palette = newPalette;
+
+    if (layout != PixelLayout::INDEXED)
+    {
+        isRendered = false;
+    }
 }
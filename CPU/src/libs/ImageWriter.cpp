@@ -0,0 +1,787 @@
+#include "ImageWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <oneapi/tbb.h>
+#include <zlib.h>
+
+#include "BufferPool.hpp"
+#include "Trace.hpp"
+
+#ifdef WITH_OPENCV
+#include <opencv2/opencv.hpp>
+#endif
+
+
+namespace
+{
+    constexpr std::array<std::pair<std::string_view, PixelLayout>, 5> LAYOUT_NAMES{{
+        {"rgb", PixelLayout::RGB},
+        {"bgr", PixelLayout::BGR},
+        {"rgba", PixelLayout::RGBA},
+        {"bgra", PixelLayout::BGRA},
+        {"indexed", PixelLayout::INDEXED},
+    }};
+
+    constexpr std::array<std::string_view, 4> FORMAT_NAMES{"png", "qoi", "bmp", "ppm"};
+    constexpr std::array<std::string_view, 4> MIME_TYPES{"image/png", "image/qoi", "image/bmp", "image/x-portable-pixmap"};
+
+    constexpr std::size_t RGB_CHANNELS{3};
+
+    // An OP_RGB chunk is the longest encoding of a single pixel
+    constexpr std::size_t QOI_MAX_BYTES_PER_PIXEL{4};
+
+    using FileHandle = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+    // Ends the compressor on every path, including a failed write that throws
+    using DeflateHandle = std::unique_ptr<z_stream, decltype(&deflateEnd)>;
+
+    using Bytes = std::vector<std::uint8_t>;
+
+    // Every encoder writes from the calling thread, so a per thread count sees exactly the bytes of one image
+    thread_local std::size_t writtenBytes{0};
+
+    auto PutLE16(Bytes & bytes, std::uint16_t const value) -> void
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value));
+        bytes.push_back(static_cast<std::uint8_t>(value >> 8U));
+    }
+
+    auto PutLE32(Bytes & bytes, std::uint32_t const value) -> void
+    {
+        PutLE16(bytes, static_cast<std::uint16_t>(value));
+        PutLE16(bytes, static_cast<std::uint16_t>(value >> 16U));
+    }
+
+    auto PutBE32(Bytes & bytes, std::uint32_t const value) -> void
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value >> 24U));
+        bytes.push_back(static_cast<std::uint8_t>(value >> 16U));
+        bytes.push_back(static_cast<std::uint8_t>(value >> 8U));
+        bytes.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    auto Write(std::FILE * const file, void const * const data, std::size_t const size) -> void
+    {
+        if (std::fwrite(data, 1U, size, file) != size)
+        {
+            throw std::runtime_error("Could not write the image data.");
+        }
+
+        writtenBytes += size;
+    }
+
+    auto Write(std::FILE * const file, Bytes const & bytes) -> void
+    {
+        Write(file, bytes.data(), bytes.size());
+    }
+
+    auto Row(ImageView const & image, std::size_t const row) -> std::uint8_t const *
+    {
+        return image.data + row * image.stride;
+    }
+
+    auto ReadColor(ImageView const & image, std::uint8_t const * const row, std::size_t const column) -> Color
+    {
+        if (image.layout == PixelLayout::INDEXED)
+        {
+            return (*image.palette)[row[column]];
+        }
+
+        auto const order{GetChannelOrder(image.layout)};
+        auto const * const pixel{row + column * GetChannels(image.layout)};
+
+        return {pixel[order.red], pixel[order.green], pixel[order.blue]};
+    }
+
+    auto ConvertRow(ImageView const & image, std::size_t const row, PixelLayout const target, Bytes & buffer) -> std::uint8_t const *
+    {
+        auto const * const source{Row(image, row)};
+
+        if (image.layout == target)
+        {
+            return source;
+        }
+
+        auto const channels{GetChannels(target)};
+        auto const order{GetChannelOrder(target)};
+
+        buffer.resize(image.size.width * channels);
+
+        for (std::size_t x{0}; x < image.size.width; ++x)
+        {
+            auto const color{ReadColor(image, source, x)};
+            auto * const pixel{buffer.data() + x * channels};
+
+            pixel[order.red] = color.red;
+            pixel[order.green] = color.green;
+            pixel[order.blue] = color.blue;
+
+            if (channels == 4U)
+            {
+                pixel[3] = 255U;
+            }
+        }
+
+        return buffer.data();
+    }
+
+    auto WriteChunk(std::FILE * const file, char const (&type)[5], std::uint8_t const * const data, std::size_t const size) -> void
+    {
+        Bytes header;
+        PutBE32(header, static_cast<std::uint32_t>(size));
+        header.insert(header.end(), type, type + 4);
+
+        auto checksum{crc32(0UL, header.data() + 4, 4U)};
+
+        if (size > 0U)
+        {
+            checksum = crc32(checksum, data, static_cast<uInt>(size));
+        }
+
+        Bytes footer;
+        PutBE32(footer, static_cast<std::uint32_t>(checksum));
+
+        Write(file, header);
+        Write(file, data, size);
+        Write(file, footer);
+    }
+
+    auto PaletteBytes(Palette const & palette) -> Bytes
+    {
+        Bytes bytes;
+        bytes.reserve(palette.size() * RGB_CHANNELS);
+
+        for (auto const & color : palette)
+        {
+            bytes.insert(bytes.end(), {color.red, color.green, color.blue});
+        }
+
+        return bytes;
+    }
+
+    auto PaletteQuads(Palette const & palette) -> Bytes
+    {
+        Bytes bytes;
+        bytes.reserve(palette.size() * 4U);
+
+        for (auto const & color : palette)
+        {
+            bytes.insert(bytes.end(), {color.blue, color.green, color.red, 0U});
+        }
+
+        return bytes;
+    }
+
+    struct QOIPixel
+    {
+        std::uint8_t red;
+        std::uint8_t green;
+        std::uint8_t blue;
+        std::uint8_t alpha;
+
+        auto operator==(QOIPixel const &) const -> bool = default;
+    };
+
+    auto LoadQOIPixel(ImageView const & image, std::size_t const index) -> QOIPixel
+    {
+        auto const color{ReadColor(image, Row(image, index / image.size.width), index % image.size.width)};
+
+        return {color.red, color.green, color.blue, 255U};
+    }
+
+    // Every chunk starts with an empty index and flushes its run at the end, so the chunks concatenate into a valid stream.
+    // The output needs room for QOI_MAX_BYTES_PER_PIXEL bytes per pixel, and the number of bytes written is returned.
+    auto EncodeQOIChunk(ImageView const & image, std::size_t const begin, std::size_t const end, std::uint8_t * const output) -> std::size_t
+    {
+        TRACE_SCOPE("encode qoi chunk");
+
+        static constexpr std::uint8_t OP_INDEX{0x00};
+        static constexpr std::uint8_t OP_DIFF{0x40};
+        static constexpr std::uint8_t OP_LUMA{0x80};
+        static constexpr std::uint8_t OP_RUN{0xC0};
+        static constexpr std::uint8_t OP_RGB{0xFE};
+        static constexpr std::size_t MAX_RUN{62};
+
+        auto * bytes{output};
+
+        std::array<QOIPixel, 64> index{};
+        auto previous{begin == 0U ? QOIPixel{0U, 0U, 0U, 255U} : LoadQOIPixel(image, begin - 1U)};
+        std::size_t run{0};
+
+        for (auto position{begin}; position < end; ++position)
+        {
+            auto const pixel{LoadQOIPixel(image, position)};
+
+            if (pixel == previous)
+            {
+                if (++run == MAX_RUN)
+                {
+                    *bytes++ = static_cast<std::uint8_t>(OP_RUN | (run - 1U));
+                    run = 0U;
+                }
+
+                continue;
+            }
+
+            if (run > 0U)
+            {
+                *bytes++ = static_cast<std::uint8_t>(OP_RUN | (run - 1U));
+                run = 0U;
+            }
+
+            auto const hash{(pixel.red * 3U + pixel.green * 5U + pixel.blue * 7U + pixel.alpha * 11U) % index.size()};
+
+            if (index[hash] == pixel)
+            {
+                *bytes++ = static_cast<std::uint8_t>(OP_INDEX | hash);
+            }
+            else
+            {
+                index[hash] = pixel;
+
+                auto const deltaRed{static_cast<std::int8_t>(pixel.red - previous.red)};
+                auto const deltaGreen{static_cast<std::int8_t>(pixel.green - previous.green)};
+                auto const deltaBlue{static_cast<std::int8_t>(pixel.blue - previous.blue)};
+                auto const deltaRedGreen{deltaRed - deltaGreen};
+                auto const deltaBlueGreen{deltaBlue - deltaGreen};
+
+                if (deltaRed >= -2 && deltaRed <= 1 && deltaGreen >= -2 && deltaGreen <= 1 && deltaBlue >= -2 && deltaBlue <= 1)
+                {
+                    *bytes++ = static_cast<std::uint8_t>(OP_DIFF | (deltaRed + 2) << 4U | (deltaGreen + 2) << 2U | (deltaBlue + 2));
+                }
+                else if (deltaGreen >= -32 && deltaGreen <= 31 && deltaRedGreen >= -8 && deltaRedGreen <= 7 && deltaBlueGreen >= -8 && deltaBlueGreen <= 7)
+                {
+                    *bytes++ = static_cast<std::uint8_t>(OP_LUMA | (deltaGreen + 32));
+                    *bytes++ = static_cast<std::uint8_t>((deltaRedGreen + 8) << 4U | (deltaBlueGreen + 8));
+                }
+                else
+                {
+                    bytes = std::ranges::copy(std::array{OP_RGB, pixel.red, pixel.green, pixel.blue}, bytes).out;
+                }
+            }
+
+            previous = pixel;
+        }
+
+        if (run > 0U)
+        {
+            *bytes++ = static_cast<std::uint8_t>(OP_RUN | (run - 1U));
+        }
+
+        return static_cast<std::size_t>(bytes - output);
+    }
+
+    auto Extension(std::string_view const filename) -> std::string
+    {
+        auto extension{std::filesystem::path{filename}.extension().string()};
+        std::ranges::transform(extension, extension.begin(), [](unsigned char const character) { return static_cast<char>(std::tolower(character)); });
+
+        return extension;
+    }
+
+    auto OpenFile(std::string_view const filename, char const * const mode = "wb") -> FileHandle
+    {
+        FileHandle file{std::fopen(std::string{filename}.c_str(), mode), &std::fclose};
+
+        if (!file)
+        {
+            throw std::runtime_error(std::format("Could not open {}.", filename));
+        }
+
+        return file;
+    }
+
+    auto ReadAt(std::FILE * const file, long const offset, std::size_t const size) -> Bytes
+    {
+        Bytes bytes(size);
+
+        if (std::fseek(file, offset, SEEK_SET) != 0 || std::fread(bytes.data(), 1U, size, file) != size)
+        {
+            throw std::runtime_error("Could not read the image data.");
+        }
+
+        return bytes;
+    }
+
+    auto WriteAt(std::FILE * const file, long const offset, Bytes const & bytes) -> void
+    {
+        if (std::fseek(file, offset, SEEK_SET) != 0)
+        {
+            throw std::runtime_error("Could not write the image data.");
+        }
+
+        Write(file, bytes);
+    }
+
+    auto GetBE32(Bytes const & bytes, std::size_t const offset) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(bytes[offset]) << 24U | static_cast<std::uint32_t>(bytes[offset + 1]) << 16U | static_cast<std::uint32_t>(bytes[offset + 2]) << 8U | bytes[offset + 3];
+    }
+
+    auto GetLE32(Bytes const & bytes, std::size_t const offset) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(bytes[offset + 3]) << 24U | static_cast<std::uint32_t>(bytes[offset + 2]) << 16U | static_cast<std::uint32_t>(bytes[offset + 1]) << 8U | bytes[offset];
+    }
+
+    auto RewritePNGPalette(std::FILE * const file, Palette const & palette) -> void
+    {
+        static constexpr std::size_t SIGNATURE_SIZE{8};
+        static constexpr std::size_t CHUNK_HEADER_SIZE{8};
+        static constexpr std::size_t CHUNK_CRC_SIZE{4};
+
+        auto offset{SIGNATURE_SIZE};
+
+        while (true)
+        {
+            auto const header{ReadAt(file, static_cast<long>(offset), CHUNK_HEADER_SIZE)};
+            auto const length{GetBE32(header, 0U)};
+            std::string_view const type{reinterpret_cast<char const *>(header.data()) + 4, 4U};
+
+            if (type == "PLTE")
+            {
+                auto const data{PaletteBytes(palette)};
+
+                if (length != data.size())
+                {
+                    throw std::runtime_error("The PNG palette does not have 256 entries.");
+                }
+
+                Bytes checksum;
+                PutBE32(checksum, static_cast<std::uint32_t>(crc32(crc32(0UL, header.data() + 4, 4U), data.data(), static_cast<uInt>(data.size()))));
+
+                WriteAt(file, static_cast<long>(offset + CHUNK_HEADER_SIZE), data);
+                Write(file, checksum);
+
+                return;
+            }
+
+            if (type == "IDAT" || type == "IEND")
+            {
+                throw std::runtime_error("The PNG file is not indexed.");
+            }
+
+            offset += CHUNK_HEADER_SIZE + length + CHUNK_CRC_SIZE;
+        }
+    }
+
+    auto RewriteBMPPalette(std::FILE * const file, Palette const & palette) -> void
+    {
+        static constexpr std::size_t FILE_HEADER_SIZE{14};
+
+        auto const header{ReadAt(file, static_cast<long>(FILE_HEADER_SIZE), 16U)};
+        auto const infoHeaderSize{GetLE32(header, 0U)};
+        auto const bitsPerPixel{static_cast<std::uint32_t>(header[14] | header[15] << 8U)};
+
+        if (bitsPerPixel != 8U)
+        {
+            throw std::runtime_error("The BMP file is not indexed.");
+        }
+
+        WriteAt(file, static_cast<long>(FILE_HEADER_SIZE + infoHeaderSize), PaletteQuads(palette));
+    }
+
+#ifdef WITH_OPENCV
+    auto WriteOpenCV(ImageView const & image, std::string_view const filename) -> void
+    {
+        using namespace cv;
+
+        auto const type{GetChannels(image.layout) == 4U ? CV_8UC4 : CV_8UC3};
+        Mat const source{static_cast<int>(image.size.height), static_cast<int>(image.size.width), type, const_cast<std::uint8_t *>(image.data), image.stride};
+
+        switch (image.layout)
+        {
+            case PixelLayout::BGR:
+            case PixelLayout::BGRA:
+            {
+                TRACE_SCOPE("imwrite");
+                imwrite(std::string{filename}, source);
+                break;
+            }
+            case PixelLayout::RGB:
+            case PixelLayout::RGBA:
+            {
+                // cvtColor keeps a destination of the right size and type, so the conversion lands in pooled memory
+                auto const converted{BufferPool::GetDefault().Acquire(image.size.width * image.size.height * GetChannels(image.layout))};
+                Mat const imageBGR{source.size(), type, converted.GetData()};
+
+                {
+                    TRACE_SCOPE("cvtColor");
+                    cvtColor(source, imageBGR, image.layout == PixelLayout::RGB ? COLOR_RGB2BGR : COLOR_RGBA2BGRA);
+                }
+
+                TRACE_SCOPE("imwrite");
+                imwrite(std::string{filename}, imageBGR);
+                break;
+            }
+            case PixelLayout::INDEXED:
+            {
+                throw std::runtime_error("OpenCV cannot write indexed images.");
+            }
+        }
+    }
+#endif
+}
+
+
+auto GetChannels(PixelLayout const layout) -> std::size_t
+{
+    switch (layout)
+    {
+        case PixelLayout::RGBA:
+        case PixelLayout::BGRA:
+        {
+            return 4U;
+        }
+        case PixelLayout::INDEXED:
+        {
+            return 1U;
+        }
+        default:
+        {
+            return RGB_CHANNELS;
+        }
+    }
+}
+
+auto GetChannelOrder(PixelLayout const layout) -> ChannelOrder
+{
+    if (layout == PixelLayout::BGR || layout == PixelLayout::BGRA)
+    {
+        return {2U, 1U, 0U};
+    }
+
+    return {0U, 1U, 2U};
+}
+
+auto ParsePixelLayout(std::string_view const name) -> PixelLayout
+{
+    if (auto const found{std::ranges::find(LAYOUT_NAMES, name, &std::pair<std::string_view, PixelLayout>::first)}; found != LAYOUT_NAMES.end())
+    {
+        return found->second;
+    }
+
+    throw std::invalid_argument(std::format("Unknown pixel layout {}.", name));
+}
+
+auto GetPixelLayoutName(PixelLayout const layout) -> std::string_view
+{
+    return std::ranges::find(LAYOUT_NAMES, layout, &std::pair<std::string_view, PixelLayout>::second)->first;
+}
+
+auto ParseImageFormat(std::string_view const name) -> ImageFormat
+{
+    if (auto const found{std::ranges::find(FORMAT_NAMES, name)}; found != FORMAT_NAMES.end())
+    {
+        return static_cast<ImageFormat>(found - FORMAT_NAMES.begin());
+    }
+
+    throw std::invalid_argument(std::format("Unknown image format {}.", name));
+}
+
+auto GetImageFormatName(ImageFormat const format) -> std::string_view
+{
+    return FORMAT_NAMES[static_cast<std::size_t>(format)];
+}
+
+auto GetMimeType(ImageFormat const format) -> std::string_view
+{
+    return MIME_TYPES[static_cast<std::size_t>(format)];
+}
+
+auto WriteImage(ImageView const & image, std::string_view const filename) -> void
+{
+    auto const extension{Extension(filename)};
+
+    if (extension == ".qoi")
+    {
+        WriteQOI(image, OpenFile(filename).get());
+    }
+    else if (extension == ".bmp")
+    {
+        WriteBMP(image, OpenFile(filename).get());
+    }
+    else if (extension == ".ppm")
+    {
+        WritePPM(image, OpenFile(filename).get());
+    }
+    // OpenCV keeps writing colour PNGs, the built-in encoder covers indexed images and builds without OpenCV
+#ifdef WITH_OPENCV
+    else if (extension == ".png" && image.layout == PixelLayout::INDEXED)
+#else
+    else if (extension == ".png")
+#endif
+    {
+        WritePNG(image, OpenFile(filename).get());
+    }
+    else
+    {
+#ifdef WITH_OPENCV
+        WriteOpenCV(image, filename);
+#else
+        throw std::runtime_error(std::format("Unsupported image format {} (built without OpenCV).", extension));
+#endif
+    }
+}
+
+auto WriteImage(ImageView const & image, ImageFormat const format, std::FILE * const file) -> std::size_t
+{
+    auto const initialBytes{writtenBytes};
+
+    switch (format)
+    {
+        case ImageFormat::PNG:
+        {
+            WritePNG(image, file);
+            break;
+        }
+        case ImageFormat::QOI:
+        {
+            WriteQOI(image, file);
+            break;
+        }
+        case ImageFormat::BMP:
+        {
+            WriteBMP(image, file);
+            break;
+        }
+        case ImageFormat::PPM:
+        {
+            WritePPM(image, file);
+            break;
+        }
+    }
+
+    return writtenBytes - initialBytes;
+}
+
+auto WriteQOI(ImageView const & image, std::FILE * const file) -> void
+{
+    using namespace oneapi::tbb;
+
+    static constexpr std::size_t CHUNK_PIXELS{1UZ << 18U};
+
+    auto const pixels{image.size.width * image.size.height};
+    auto const chunkCount{std::max(1UZ, (pixels + CHUNK_PIXELS - 1U) / CHUNK_PIXELS)};
+
+    TRACE_SCOPE("write qoi");
+
+    std::vector<PooledBuffer> chunks(chunkCount);
+    std::vector<std::size_t> chunkSizes(chunkCount);
+
+    parallel_for(
+        blocked_range<std::size_t>{0U, chunkCount}, [&](auto const & range) -> void
+        {
+            for (auto chunk{range.begin()}; chunk < range.end(); ++chunk)
+            {
+                auto const begin{chunk * CHUNK_PIXELS};
+                auto const end{std::min(pixels, begin + CHUNK_PIXELS)};
+
+                chunks[chunk] = BufferPool::GetDefault().Acquire((end - begin) * QOI_MAX_BYTES_PER_PIXEL);
+                chunkSizes[chunk] = EncodeQOIChunk(image, begin, end, chunks[chunk].GetData());
+            }
+        }
+    );
+
+    Bytes header{'q', 'o', 'i', 'f'};
+    PutBE32(header, static_cast<std::uint32_t>(image.size.width));
+    PutBE32(header, static_cast<std::uint32_t>(image.size.height));
+    header.push_back(static_cast<std::uint8_t>(RGB_CHANNELS));
+    header.push_back(0U);
+
+    Write(file, header);
+
+    for (std::size_t chunk{0}; chunk < chunkCount; ++chunk)
+    {
+        Write(file, chunks[chunk].GetData(), chunkSizes[chunk]);
+    }
+
+    Write(file, Bytes{0U, 0U, 0U, 0U, 0U, 0U, 0U, 1U});
+}
+
+auto WriteBMP(ImageView const & image, std::FILE * const file) -> void
+{
+    TRACE_SCOPE("write bmp");
+
+    static constexpr std::uint32_t HEADERS_SIZE{14U + 40U};
+
+    auto const indexed{image.layout == PixelLayout::INDEXED};
+    auto const target{indexed ? PixelLayout::INDEXED : GetChannels(image.layout) == 4U ? PixelLayout::BGRA : PixelLayout::BGR};
+    auto const bytesPerPixel{GetChannels(target)};
+    auto const colorTable{indexed ? PaletteQuads(*image.palette) : Bytes{}};
+    auto const dataOffset{HEADERS_SIZE + static_cast<std::uint32_t>(colorTable.size())};
+
+    auto const pixelsSize{image.size.width * bytesPerPixel};
+    auto const rowSize{(pixelsSize + 3U) & ~3UZ};
+    auto const dataSize{static_cast<std::uint32_t>(rowSize * image.size.height)};
+
+    Bytes header{'B', 'M'};
+    PutLE32(header, dataOffset + dataSize);
+    PutLE32(header, 0U);
+    PutLE32(header, dataOffset);
+    PutLE32(header, 40U);
+    PutLE32(header, static_cast<std::uint32_t>(image.size.width));
+    // A negative height stores the rows top-down, in the same order as the render buffer
+    PutLE32(header, static_cast<std::uint32_t>(-static_cast<std::int32_t>(image.size.height)));
+    PutLE16(header, 1U);
+    PutLE16(header, static_cast<std::uint16_t>(bytesPerPixel * 8U));
+    PutLE32(header, 0U);
+    PutLE32(header, dataSize);
+    PutLE32(header, 2835U);
+    PutLE32(header, 2835U);
+    PutLE32(header, indexed ? static_cast<std::uint32_t>(image.palette->size()) : 0U);
+    PutLE32(header, 0U);
+
+    Write(file, header);
+    Write(file, colorTable);
+
+    Bytes buffer;
+    Bytes const padding(rowSize - pixelsSize, 0U);
+
+    for (std::size_t y{0}; y < image.size.height; ++y)
+    {
+        Write(file, ConvertRow(image, y, target, buffer), pixelsSize);
+        Write(file, padding);
+    }
+}
+
+auto WritePPM(ImageView const & image, std::FILE * const file) -> void
+{
+    TRACE_SCOPE("write ppm");
+
+    auto const header{std::format("P6\n{} {}\n255\n", image.size.width, image.size.height)};
+    Write(file, header.data(), header.size());
+
+    auto const rowSize{image.size.width * RGB_CHANNELS};
+
+    if (image.layout == PixelLayout::RGB && image.stride == rowSize)
+    {
+        Write(file, image.data, rowSize * image.size.height);
+        return;
+    }
+
+    Bytes buffer;
+
+    for (std::size_t y{0}; y < image.size.height; ++y)
+    {
+        Write(file, ConvertRow(image, y, PixelLayout::RGB, buffer), rowSize);
+    }
+}
+
+auto WritePNG(ImageView const & image, std::FILE * const file) -> void
+{
+    static constexpr std::size_t IDAT_SIZE{1UZ << 20U};
+
+    static constexpr std::uint8_t COLOR_TYPE_RGB{2};
+    static constexpr std::uint8_t COLOR_TYPE_INDEXED{3};
+    static constexpr std::uint8_t COLOR_TYPE_RGBA{6};
+
+    auto const indexed{image.layout == PixelLayout::INDEXED};
+    auto const target{indexed ? PixelLayout::INDEXED : GetChannels(image.layout) == 4U ? PixelLayout::RGBA : PixelLayout::RGB};
+    auto const colorType{indexed ? COLOR_TYPE_INDEXED : target == PixelLayout::RGBA ? COLOR_TYPE_RGBA : COLOR_TYPE_RGB};
+    auto const rowSize{image.size.width * GetChannels(target)};
+
+    Write(file, Bytes{137U, 'P', 'N', 'G', '\r', '\n', 26U, '\n'});
+
+    Bytes header;
+    PutBE32(header, static_cast<std::uint32_t>(image.size.width));
+    PutBE32(header, static_cast<std::uint32_t>(image.size.height));
+    header.insert(header.end(), {8U, colorType, 0U, 0U, 0U});
+    WriteChunk(file, "IHDR", header.data(), header.size());
+
+    if (indexed)
+    {
+        auto const palette{PaletteBytes(*image.palette)};
+        WriteChunk(file, "PLTE", palette.data(), palette.size());
+    }
+
+    TRACE_SCOPE("write png");
+
+    z_stream stream{};
+
+    if (deflateInit(&stream, Z_BEST_SPEED) != Z_OK)
+    {
+        throw std::runtime_error("Could not initialize the PNG compressor.");
+    }
+
+    DeflateHandle const compressor{&stream, &deflateEnd};
+
+    Bytes output(IDAT_SIZE);
+
+    auto const compress{
+        [&](std::uint8_t const * const data, std::size_t const size, int const flush) -> void
+        {
+            stream.next_in = const_cast<std::uint8_t *>(data);
+            stream.avail_in = static_cast<uInt>(size);
+
+            auto result{Z_OK};
+
+            do
+            {
+                if (stream.avail_out == 0U)
+                {
+                    WriteChunk(file, "IDAT", output.data(), IDAT_SIZE);
+                    stream.next_out = output.data();
+                    stream.avail_out = static_cast<uInt>(IDAT_SIZE);
+                }
+
+                result = deflate(&stream, flush);
+
+                // Z_BUF_ERROR only means no progress, which is an error unless the input is consumed
+                auto const stalled{result == Z_BUF_ERROR && (stream.avail_in > 0U || flush == Z_FINISH)};
+
+                if ((result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) || stalled)
+                {
+                    throw std::runtime_error(std::format("Could not compress the PNG image ({}).", result));
+                }
+            }
+            while (stream.avail_in > 0U || (flush == Z_FINISH && result != Z_STREAM_END));
+        }
+    };
+
+    stream.next_out = output.data();
+    stream.avail_out = static_cast<uInt>(IDAT_SIZE);
+
+    static constexpr std::uint8_t FILTER_NONE{0};
+
+    Bytes buffer;
+
+    for (std::size_t y{0}; y < image.size.height; ++y)
+    {
+        compress(&FILTER_NONE, 1U, Z_NO_FLUSH);
+        compress(ConvertRow(image, y, target, buffer), rowSize, Z_NO_FLUSH);
+    }
+
+    compress(nullptr, 0U, Z_FINISH);
+    WriteChunk(file, "IDAT", output.data(), IDAT_SIZE - stream.avail_out);
+
+    WriteChunk(file, "IEND", nullptr, 0U);
+}
+
+auto RewritePalette(std::string_view const filename, Palette const & palette) -> void
+{
+    auto const extension{Extension(filename)};
+    auto const file{OpenFile(filename, "r+b")};
+
+    if (extension == ".png")
+    {
+        RewritePNGPalette(file.get(), palette);
+    }
+    else if (extension == ".bmp")
+    {
+        RewriteBMPPalette(file.get(), palette);
+    }
+    else
+    {
+        throw std::runtime_error(std::format("Palettes can only be rewritten in PNG and BMP files, not {}.", extension));
+    }
+}
@@ -0,0 +1,119 @@
+// This file is compiled once per instruction set, each time into its own namespace, by the CPU dispatch setup in CMakeLists.txt
+#include "LaneKernels.hpp"
+
+
+#ifndef KERNEL_NAMESPACE
+    #define KERNEL_NAMESPACE baseline
+#endif
+
+
+namespace
+{
+    // The lanes are kept in plain arrays with branch-free selects so that the compiler can hold each of them in a single vector register.
+    // The templates must stay in this anonymous namespace, otherwise the linker could merge instantiations built for different instruction sets. For the same
+    // reason nothing here calls an inline function of the standard library, whose out-of-line copies in an unoptimized build are weak symbols that the linker
+    // may pick from this object for code that runs on any processor. A point is read as its real and imaginary floats, which std::complex guarantees.
+    template <std::size_t LANES, bool CONJUGATE>
+    auto IterateLanes(float const * const startPoints, std::size_t * const iterations, std::size_t const maxIterations, float const radius, float const * const juliaPoint)
+        -> void
+    {
+        float real[LANES]{};
+        float imag[LANES]{};
+        float addReal[LANES]{};
+        float addImag[LANES]{};
+        std::uint32_t count[LANES]{};
+        std::uint32_t active[LANES]{};
+
+        for (std::size_t lane{0}; lane < LANES; ++lane)
+        {
+            auto const * const start{startPoints + 2U * lane};
+            auto const * const constant{juliaPoint != nullptr ? juliaPoint : start};
+
+            real[lane] = juliaPoint != nullptr ? start[0] : 0.0F;
+            imag[lane] = juliaPoint != nullptr ? start[1] : 0.0F;
+            addReal[lane] = constant[0];
+            addImag[lane] = constant[1];
+            active[lane] = 1U;
+        }
+
+        auto const radiusSquared{radius * radius};
+
+        for (std::size_t iteration{0}; iteration < maxIterations; ++iteration)
+        {
+            std::uint32_t anyActive{0};
+
+            for (std::size_t lane{0}; lane < LANES; ++lane)
+            {
+                auto const realSquared{real[lane] * real[lane]};
+                auto const imagSquared{imag[lane] * imag[lane]};
+                auto const cross{(CONJUGATE ? -2.0F : 2.0F) * real[lane] * imag[lane]};
+
+                active[lane] &= static_cast<std::uint32_t>(realSquared + imagSquared <= radiusSquared);
+                count[lane] += active[lane];
+                anyActive |= active[lane];
+
+                // Escaped lanes are frozen so that they can never overflow while the others keep iterating
+                real[lane] = active[lane] != 0U ? realSquared - imagSquared + addReal[lane] : real[lane];
+                imag[lane] = active[lane] != 0U ? cross + addImag[lane] : imag[lane];
+            }
+
+            if (anyActive == 0U)
+            {
+                break;
+            }
+        }
+
+        for (std::size_t lane{0}; lane < LANES; ++lane)
+        {
+            iterations[lane] = count[lane];
+        }
+    }
+
+    template <bool CONJUGATE>
+    auto IterateBatch(float const * const startPoints, std::size_t * const iterations, std::size_t const count, std::size_t const maxIterations, float const radius,
+        float const * const juliaPoint) -> void
+    {
+        switch (count)
+        {
+            case 4U:
+            {
+                IterateLanes<4U, CONJUGATE>(startPoints, iterations, maxIterations, radius, juliaPoint);
+                break;
+            }
+            case 8U:
+            {
+                IterateLanes<8U, CONJUGATE>(startPoints, iterations, maxIterations, radius, juliaPoint);
+                break;
+            }
+            case MAX_SIMD_WIDTH:
+            {
+                IterateLanes<MAX_SIMD_WIDTH, CONJUGATE>(startPoints, iterations, maxIterations, radius, juliaPoint);
+                break;
+            }
+            default:
+            {
+                for (std::size_t lane{0}; lane < count; ++lane)
+                {
+                    IterateLanes<1U, CONJUGATE>(startPoints + 2U * lane, iterations + lane, maxIterations, radius, juliaPoint);
+                }
+            }
+        }
+    }
+}
+
+
+namespace KERNEL_NAMESPACE
+{
+    auto IterateQuadraticLanes(float const * const startPoints, std::size_t * const iterations, std::size_t const count, std::size_t const maxIterations, float const radius,
+        bool const conjugate, float const * const juliaPoint) -> void
+    {
+        if (conjugate)
+        {
+            IterateBatch<true>(startPoints, iterations, count, maxIterations, radius, juliaPoint);
+        }
+        else
+        {
+            IterateBatch<false>(startPoints, iterations, count, maxIterations, radius, juliaPoint);
+        }
+    }
+}
@@ -0,0 +1,259 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <memory>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "BufferPool.hpp"
+#include "Utils.hpp"
+
+
+namespace
+{
+    constexpr std::array<std::string_view, STAGE_COUNT> STAGE_NAMES{"queue", "render", "colorize", "encode"};
+    constexpr std::array<double, 3> QUANTILES{0.5, 0.95, 0.99};
+
+    constexpr double MIN_BUCKET_SECONDS{10.0e-6};
+    constexpr double BUCKETS_PER_OCTAVE{4.0};
+
+    constexpr std::string_view DEFAULT_DUMP_INTERVAL{"10"};
+    // Shorter intervals would only rewrite the file faster than anything scrapes it, and one that rounds to zero milliseconds would never sleep
+    constexpr double MIN_DUMP_SECONDS{1.0};
+}
+
+
+auto GetStageName(Stage const stage) -> std::string_view
+{
+    return STAGE_NAMES[static_cast<std::size_t>(stage)];
+}
+
+auto LatencyHistogram::Record(std::chrono::nanoseconds const duration) -> void
+{
+    auto const seconds{std::chrono::duration<double>(duration).count()};
+    auto const octaves{seconds > MIN_BUCKET_SECONDS ? std::ceil(BUCKETS_PER_OCTAVE * std::log2(seconds / MIN_BUCKET_SECONDS)) : 0.0};
+    auto const bucket{std::min(static_cast<std::size_t>(octaves), BUCKET_COUNT - 1U)};
+
+    buckets[bucket].fetch_add(1U, std::memory_order_relaxed);
+    nanoseconds.fetch_add(static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count())), std::memory_order_relaxed);
+    count.fetch_add(1U, std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::GetQuantile(double const quantile) const -> double
+{
+    auto const total{count.load(std::memory_order_relaxed)};
+
+    if (total == 0U)
+    {
+        return 0.0;
+    }
+
+    auto const rank{quantile * static_cast<double>(total)};
+    double seen{0.0};
+
+    for (std::size_t bucket{0}; bucket < BUCKET_COUNT; ++bucket)
+    {
+        auto const inBucket{static_cast<double>(buckets[bucket].load(std::memory_order_relaxed))};
+
+        if (inBucket > 0.0 && seen + inBucket >= rank)
+        {
+            auto const lower{bucket == 0U ? 0.0 : GetUpperBound(bucket - 1U)};
+
+            return lower + (GetUpperBound(bucket) - lower) * (rank - seen) / inBucket;
+        }
+
+        seen += inBucket;
+    }
+
+    return GetUpperBound(BUCKET_COUNT - 1U);
+}
+
+auto LatencyHistogram::GetCount() const -> std::uint64_t
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::GetSeconds() const -> double
+{
+    return static_cast<double>(nanoseconds.load(std::memory_order_relaxed)) * 1.0e-9;
+}
+
+auto LatencyHistogram::GetUpperBound(std::size_t const bucket) -> double
+{
+    return MIN_BUCKET_SECONDS * std::exp2(static_cast<double>(bucket) / BUCKETS_PER_OCTAVE);
+}
+
+Metrics::StageTimer::StageTimer(Metrics & metrics, Stage const stage) : metrics{metrics}, stage{stage}, start{std::chrono::steady_clock::now()}
+{
+    metrics.active[static_cast<std::size_t>(stage)].fetch_add(1, std::memory_order_relaxed);
+}
+
+Metrics::StageTimer::~StageTimer()
+{
+    metrics.active[static_cast<std::size_t>(stage)].fetch_sub(1, std::memory_order_relaxed);
+    metrics.RecordStage(stage, std::chrono::steady_clock::now() - start);
+}
+
+auto Metrics::RecordStage(Stage const stage, std::chrono::nanoseconds const duration) -> void
+{
+    histograms[static_cast<std::size_t>(stage)].Record(duration);
+}
+
+auto Metrics::AddIterations(std::uint64_t const count) -> void
+{
+    iterations.fetch_add(count, std::memory_order_relaxed);
+}
+
+auto Metrics::AddBytesWritten(std::uint64_t const count) -> void
+{
+    bytesWritten.fetch_add(count, std::memory_order_relaxed);
+}
+
+auto Metrics::AddRequest(bool const isFailed) -> void
+{
+    requests.fetch_add(1U, std::memory_order_relaxed);
+
+    if (isFailed)
+    {
+        failedRequests.fetch_add(1U, std::memory_order_relaxed);
+    }
+}
+
+auto Metrics::GetHistogram(Stage const stage) const -> LatencyHistogram const &
+{
+    return histograms[static_cast<std::size_t>(stage)];
+}
+
+auto Metrics::WritePrometheus(std::FILE * const stream) const -> void
+{
+    std::println(stream, "# HELP fractal_stage_seconds Time spent in each stage of a render.");
+    std::println(stream, "# TYPE fractal_stage_seconds summary");
+
+    for (std::size_t stage{0}; stage < STAGE_COUNT; ++stage)
+    {
+        auto const & histogram{histograms[stage]};
+
+        for (auto const quantile : QUANTILES)
+        {
+            std::println(stream, "fractal_stage_seconds{{stage=\"{}\",quantile=\"{}\"}} {:.6f}", STAGE_NAMES[stage], quantile, histogram.GetQuantile(quantile));
+        }
+
+        std::println(stream, "fractal_stage_seconds_sum{{stage=\"{}\"}} {:.6f}", STAGE_NAMES[stage], histogram.GetSeconds());
+        std::println(stream, "fractal_stage_seconds_count{{stage=\"{}\"}} {}", STAGE_NAMES[stage], histogram.GetCount());
+    }
+
+    std::println(stream, "# HELP fractal_stage_active Renders currently in each stage.");
+    std::println(stream, "# TYPE fractal_stage_active gauge");
+
+    for (std::size_t stage{0}; stage < STAGE_COUNT; ++stage)
+    {
+        std::println(stream, "fractal_stage_active{{stage=\"{}\"}} {}", STAGE_NAMES[stage], active[stage].load(std::memory_order_relaxed));
+    }
+
+    auto const totalIterations{iterations.load(std::memory_order_relaxed)};
+    auto const renderSeconds{histograms[static_cast<std::size_t>(Stage::RENDER)].GetSeconds()};
+
+    std::println(stream, "# HELP fractal_iterations_total Escape iterations computed.");
+    std::println(stream, "# TYPE fractal_iterations_total counter");
+    std::println(stream, "fractal_iterations_total {}", totalIterations);
+    std::println(stream, "# HELP fractal_iterations_per_second Escape iterations per second of render time.");
+    std::println(stream, "# TYPE fractal_iterations_per_second gauge");
+    std::println(stream, "fractal_iterations_per_second {:.0f}", renderSeconds > 0.0 ? static_cast<double>(totalIterations) / renderSeconds : 0.0);
+
+    std::println(stream, "# HELP fractal_written_bytes_total Encoded bytes written.");
+    std::println(stream, "# TYPE fractal_written_bytes_total counter");
+    std::println(stream, "fractal_written_bytes_total {}", bytesWritten.load(std::memory_order_relaxed));
+
+    std::println(stream, "# HELP fractal_requests_total Render requests, failed or not.");
+    std::println(stream, "# TYPE fractal_requests_total counter");
+    std::println(stream, "fractal_requests_total {}", requests.load(std::memory_order_relaxed));
+    std::println(stream, "# HELP fractal_failed_requests_total Render requests that failed.");
+    std::println(stream, "# TYPE fractal_failed_requests_total counter");
+    std::println(stream, "fractal_failed_requests_total {}", failedRequests.load(std::memory_order_relaxed));
+
+    auto const pool{BufferPool::GetDefault().GetStatistics()};
+    auto const poolRequests{pool.hits + pool.misses};
+
+    std::println(stream, "# HELP fractal_buffer_pool_requests_total Buffer pool requests by whether a buffer was recycled.");
+    std::println(stream, "# TYPE fractal_buffer_pool_requests_total counter");
+    std::println(stream, "fractal_buffer_pool_requests_total{{result=\"hit\"}} {}", pool.hits);
+    std::println(stream, "fractal_buffer_pool_requests_total{{result=\"miss\"}} {}", pool.misses);
+    std::println(stream, "# HELP fractal_buffer_pool_hit_ratio Share of buffer pool requests served by a recycled buffer.");
+    std::println(stream, "# TYPE fractal_buffer_pool_hit_ratio gauge");
+    std::println(stream, "fractal_buffer_pool_hit_ratio {:.4f}", poolRequests > 0U ? static_cast<double>(pool.hits) / static_cast<double>(poolRequests) : 0.0);
+    std::println(stream, "# HELP fractal_buffer_pool_resident_bytes Memory mapped by the buffer pool.");
+    std::println(stream, "# TYPE fractal_buffer_pool_resident_bytes gauge");
+    std::println(stream, "fractal_buffer_pool_resident_bytes {}", pool.residentBytes);
+}
+
+auto Metrics::GetDefault() -> Metrics &
+{
+    static Metrics metrics;
+
+    return metrics;
+}
+
+MetricsDump::MetricsDump(Metrics const & metrics, std::filesystem::path dumpPath, std::chrono::milliseconds const dumpInterval) : metrics{metrics},
+    path{std::move(dumpPath)}, interval{dumpInterval}, thread{
+        [this](std::stop_token const & stopToken) -> void
+        {
+            std::unique_lock lock{mutex};
+
+            while (!wakeUp.wait_for(lock, stopToken, interval, [&stopToken]() { return stopToken.stop_requested(); }))
+            {
+                Write();
+            }
+        }
+    } { }
+
+MetricsDump::~MetricsDump()
+{
+    thread.request_stop();
+    thread.join();
+
+    Write();
+}
+
+auto MetricsDump::Write() const -> void
+{
+    auto const temporary{path.string() + ".tmp"};
+
+    {
+        std::unique_ptr<std::FILE, decltype(&std::fclose)> file{std::fopen(temporary.c_str(), "w"), &std::fclose};
+
+        if (!file)
+        {
+            std::println(stderr, "Could not write the metrics to {}.", temporary);
+            return;
+        }
+
+        metrics.WritePrometheus(file.get());
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
+
+auto StartMetricsDump(int const argc, char const * const argv[]) -> std::unique_ptr<MetricsDump>
+{
+    auto const path{GetOption(argc, argv, "metrics-file", "")};
+
+    if (path.empty())
+    {
+        return nullptr;
+    }
+
+    auto const seconds{std::stod(std::string{GetOption(argc, argv, "metrics-interval", DEFAULT_DUMP_INTERVAL)})};
+
+    // Written so that NaN fails as well
+    if (!(seconds >= MIN_DUMP_SECONDS))
+    {
+        throw std::invalid_argument(std::format("The metrics interval must be at least {} s.", MIN_DUMP_SECONDS));
+    }
+
+    return std::make_unique<MetricsDump>(Metrics::GetDefault(), path, std::chrono::milliseconds{std::llround(seconds * 1000.0)});
+}
@@ -0,0 +1,175 @@
+#include "PageBuffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 3> HUGE_PAGES_NAMES{"none", "thp", "explicit"};
+    constexpr std::array<std::string_view, 2> ALLOCATION_NAMES{"zeroed", "first-touch"};
+
+    constexpr std::size_t HUGE_PAGE_SIZE{2U * 1024U * 1024U};
+    constexpr std::size_t FALLBACK_ALIGNMENT{4096};
+
+    auto RoundUp(std::size_t const value, std::size_t const multiple) -> std::size_t
+    {
+        return (value + multiple - 1U) / multiple * multiple;
+    }
+}
+
+
+auto ParseHugePages(std::string_view const name) -> HugePages
+{
+    if (auto const found{std::ranges::find(HUGE_PAGES_NAMES, name)}; found != HUGE_PAGES_NAMES.end())
+    {
+        return static_cast<HugePages>(found - HUGE_PAGES_NAMES.begin());
+    }
+
+    throw std::invalid_argument(std::format("Unknown huge page mode {}.", name));
+}
+
+auto GetHugePagesName(HugePages const hugePages) -> std::string_view
+{
+    return HUGE_PAGES_NAMES[static_cast<std::size_t>(hugePages)];
+}
+
+auto ParseAllocation(std::string_view const name) -> Allocation
+{
+    if (auto const found{std::ranges::find(ALLOCATION_NAMES, name)}; found != ALLOCATION_NAMES.end())
+    {
+        return static_cast<Allocation>(found - ALLOCATION_NAMES.begin());
+    }
+
+    throw std::invalid_argument(std::format("Unknown allocation mode {}.", name));
+}
+
+auto GetAllocationName(Allocation const allocation) -> std::string_view
+{
+    return ALLOCATION_NAMES[static_cast<std::size_t>(allocation)];
+}
+
+auto GetPageSize(HugePages const hugePages) -> std::size_t
+{
+    if (hugePages != HugePages::NONE)
+    {
+        return HUGE_PAGE_SIZE;
+    }
+
+#ifdef __linux__
+    static auto const pageSize{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+
+    return pageSize;
+#else
+    return FALLBACK_ALIGNMENT;
+#endif
+}
+
+PageBuffer::PageBuffer(std::size_t const size, HugePages const hugePages) : size{size}, hugePages{hugePages}
+{
+    if (size == 0U)
+    {
+        return;
+    }
+
+#ifdef __linux__
+    mappedSize = RoundUp(size, GetPageSize(hugePages));
+
+    auto const flags{MAP_PRIVATE | MAP_ANONYMOUS | (hugePages == HugePages::EXPLICIT ? MAP_HUGETLB : 0)};
+    auto * const mapping{mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, flags, -1, 0)};
+
+    if (mapping == MAP_FAILED)
+    {
+        if (hugePages == HugePages::EXPLICIT)
+        {
+            throw std::runtime_error(std::format("Could not map {} bytes of explicit huge pages ({}), check vm.nr_hugepages.", mappedSize, std::strerror(errno)));
+        }
+
+        throw std::bad_alloc{};
+    }
+
+    // Only a hint, the kernel may still fall back to small pages when THP is disabled
+    if (hugePages == HugePages::TRANSPARENT)
+    {
+        madvise(mapping, mappedSize, MADV_HUGEPAGE);
+    }
+
+    data = static_cast<std::uint8_t *>(mapping);
+#else
+    // Without mmap the huge page modes have no effect, but the memory is still left uninitialised
+    mappedSize = RoundUp(size, FALLBACK_ALIGNMENT);
+    data = static_cast<std::uint8_t *>(::operator new(mappedSize, std::align_val_t{FALLBACK_ALIGNMENT}));
+#endif
+}
+
+PageBuffer::~PageBuffer()
+{
+    Release();
+}
+
+PageBuffer::PageBuffer(PageBuffer && other) noexcept : data{std::exchange(other.data, nullptr)}, size{std::exchange(other.size, 0U)},
+    mappedSize{std::exchange(other.mappedSize, 0U)}, hugePages{other.hugePages} { }
+
+auto PageBuffer::operator=(PageBuffer && other) noexcept -> PageBuffer &
+{
+    if (this != &other)
+    {
+        Release();
+
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0U);
+        mappedSize = std::exchange(other.mappedSize, 0U);
+        hugePages = other.hugePages;
+    }
+
+    return *this;
+}
+
+auto PageBuffer::GetData() const -> std::uint8_t *
+{
+    return data;
+}
+
+auto PageBuffer::GetSize() const -> std::size_t
+{
+    return size;
+}
+
+auto PageBuffer::GetHugePages() const -> HugePages
+{
+    return hugePages;
+}
+
+auto PageBuffer::IsEmpty() const -> bool
+{
+    return data == nullptr;
+}
+
+auto PageBuffer::Release() -> void
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+
+#ifdef __linux__
+    munmap(data, mappedSize);
+#else
+    ::operator delete(data, std::align_val_t{FALLBACK_ALIGNMENT});
+#endif
+
+    data = nullptr;
+    size = 0U;
+    mappedSize = 0U;
+}
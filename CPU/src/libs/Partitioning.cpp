@@ -0,0 +1,330 @@
+#include "Partitioning.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <format>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+namespace
+{
+    auto MortonToPixel(std::size_t const index) -> Pixel
+    {
+        Pixel pixel{0U, 0U};
+
+        for (std::size_t bit{0}; (index >> (2U * bit)) != 0U; ++bit)
+        {
+            pixel.x |= ((index >> (2U * bit)) & 1U) << bit;
+            pixel.y |= ((index >> (2U * bit + 1U)) & 1U) << bit;
+        }
+
+        return pixel;
+    }
+
+    // Classic iterative Hilbert index to coordinate conversion for a side that is a power of two
+    auto HilbertToPixel(std::size_t const side, std::size_t index) -> Pixel
+    {
+        Pixel pixel{0U, 0U};
+
+        for (std::size_t scale{1}; scale < side; scale *= 2U)
+        {
+            auto const rotateX{(index / 2U) & 1U};
+            auto const rotateY{(index ^ rotateX) & 1U};
+
+            if (rotateY == 0U)
+            {
+                if (rotateX == 1U)
+                {
+                    pixel.x = scale - 1U - pixel.x;
+                    pixel.y = scale - 1U - pixel.y;
+                }
+
+                std::swap(pixel.x, pixel.y);
+            }
+
+            pixel.x += scale * rotateX;
+            pixel.y += scale * rotateY;
+            index /= 4U;
+        }
+
+        return pixel;
+    }
+
+    // Half-open rectangle of grid cells
+    struct CellRange
+    {
+        std::size_t rowBegin;
+        std::size_t rowEnd;
+        std::size_t colBegin;
+        std::size_t colEnd;
+    };
+
+    class SummedAreaTable
+    {
+    public:
+        explicit SummedAreaTable(CostGrid const & grid) : width{grid.cells.width + 1U}, sums((grid.cells.height + 1U) * (grid.cells.width + 1U), 0.0)
+        {
+            for (std::size_t row{0}; row < grid.cells.height; ++row)
+            {
+                for (std::size_t col{0}; col < grid.cells.width; ++col)
+                {
+                    At(row + 1U, col + 1U) = grid.costs[row * grid.cells.width + col] + At(row, col + 1U) + At(row + 1U, col) - At(row, col);
+                }
+            }
+        }
+
+        [[nodiscard]] auto Sum(CellRange const & range) const -> double
+        {
+            return At(range.rowEnd, range.colEnd) - At(range.rowBegin, range.colEnd) - At(range.rowEnd, range.colBegin) + At(range.rowBegin, range.colBegin);
+        }
+
+    private:
+        [[nodiscard]] auto At(std::size_t const row, std::size_t const col) const -> double
+        {
+            return sums[row * width + col];
+        }
+
+        auto At(std::size_t const row, std::size_t const col) -> double &
+        {
+            return sums[row * width + col];
+        }
+
+        std::size_t width;
+        std::vector<double> sums;
+    };
+
+    auto ToTile(CellRange const & range, CostGrid const & grid, Size const & imageSize) -> Tile
+    {
+        auto const step{grid.probeStep};
+
+        return {
+            range.rowBegin * step, std::min(range.rowEnd * step, imageSize.height), 1U,
+            range.colBegin * step, std::min(range.colEnd * step, imageSize.width), 1U,
+        };
+    }
+
+    // k-d split: every cut divides the cost in proportion to the number of tiles that will end up on each side
+    auto Split(CellRange const & range, std::size_t const parts, SummedAreaTable const & table, CostGrid const & grid, Size const & imageSize, std::vector<Tile> & tiles) -> void
+    {
+        auto const rows{range.rowEnd - range.rowBegin};
+        auto const cols{range.colEnd - range.colBegin};
+
+        if (parts == 1U || rows * cols == 1U)
+        {
+            tiles.push_back(ToTile(range, grid, imageSize));
+            return;
+        }
+
+        auto const firstParts{parts / 2U};
+        auto const target{table.Sum(range) * static_cast<double>(firstParts) / static_cast<double>(parts)};
+        auto const splitRows{rows >= cols};
+        auto const length{splitRows ? rows : cols};
+
+        auto const firstPart{
+            [&](std::size_t const cut) -> CellRange
+            {
+                return splitRows ? CellRange{range.rowBegin, range.rowBegin + cut, range.colBegin, range.colEnd} : CellRange{range.rowBegin, range.rowEnd, range.colBegin, range.colBegin + cut};
+            }
+        };
+
+        auto cut{1UZ};
+
+        while (cut + 1U < length && table.Sum(firstPart(cut)) < target)
+        {
+            ++cut;
+        }
+
+        auto const first{firstPart(cut)};
+        auto const second{splitRows ? CellRange{range.rowBegin + cut, range.rowEnd, range.colBegin, range.colEnd} : CellRange{range.rowBegin, range.rowEnd, range.colBegin + cut, range.colEnd}};
+
+        Split(first, firstParts, table, grid, imageSize, tiles);
+        Split(second, parts - firstParts, table, grid, imageSize, tiles);
+    }
+}
+
+
+auto ParsePartitioning(std::string_view const name) -> Partitioning
+{
+    std::string lower{name};
+    std::ranges::transform(lower, lower.begin(), [](unsigned char const character) { return static_cast<char>(std::tolower(character)); });
+
+    if (lower == "affinity")
+    {
+        return Partitioning::AFFINITY;
+    }
+
+    if (lower == "auto")
+    {
+        return Partitioning::AUTO;
+    }
+
+    if (lower == "static")
+    {
+        return Partitioning::STATIC;
+    }
+
+    if (lower == "balanced")
+    {
+        return Partitioning::BALANCED;
+    }
+
+    if (lower == "longest")
+    {
+        return Partitioning::LONGEST_FIRST;
+    }
+
+    if (lower == "morton")
+    {
+        return Partitioning::MORTON;
+    }
+
+    if (lower == "hilbert")
+    {
+        return Partitioning::HILBERT;
+    }
+
+    if (lower == "weighted")
+    {
+        return Partitioning::WEIGHTED;
+    }
+
+    throw std::invalid_argument(std::format("Unknown partitioning {}.", name));
+}
+
+auto GetPartitioningName(Partitioning const partitioning) -> std::string_view
+{
+    switch (partitioning)
+    {
+        case Partitioning::AFFINITY:
+        {
+            return "affinity";
+        }
+        case Partitioning::AUTO:
+        {
+            return "auto";
+        }
+        case Partitioning::STATIC:
+        {
+            return "static";
+        }
+        case Partitioning::BALANCED:
+        {
+            return "balanced";
+        }
+        case Partitioning::LONGEST_FIRST:
+        {
+            return "longest";
+        }
+        case Partitioning::MORTON:
+        {
+            return "morton";
+        }
+        case Partitioning::HILBERT:
+        {
+            return "hilbert";
+        }
+        case Partitioning::WEIGHTED:
+        {
+            return "weighted";
+        }
+    }
+
+    throw std::invalid_argument("Unknown partitioning.");
+}
+
+auto ParseMemoryLayout(std::string_view const name) -> MemoryLayout
+{
+    if (name == "row")
+    {
+        return MemoryLayout::ROW_MAJOR;
+    }
+
+    if (name == "tiled")
+    {
+        return MemoryLayout::TILED;
+    }
+
+    throw std::invalid_argument(std::format("Unknown memory layout {}.", name));
+}
+
+auto GetMemoryLayoutName(MemoryLayout const memoryLayout) -> std::string_view
+{
+    return memoryLayout == MemoryLayout::TILED ? "tiled" : "row";
+}
+
+auto SplitByCost(CostGrid const & grid, Size const & imageSize, std::size_t const tileCount) -> std::vector<Tile>
+{
+    SummedAreaTable const table{grid};
+
+    std::vector<Tile> tiles;
+    tiles.reserve(tileCount);
+
+    Split({0U, grid.cells.height, 0U, grid.cells.width}, std::max(1UZ, tileCount), table, grid, imageSize, tiles);
+
+    return tiles;
+}
+
+auto SortByCost(CostGrid const & grid, Size const & imageSize, std::size_t const tileCount) -> std::vector<Tile>
+{
+    SummedAreaTable const table{grid};
+
+    // Uniform tiles on a grid with roughly square cells, handed out most expensive first
+    auto const aspect{static_cast<double>(grid.cells.width) / static_cast<double>(grid.cells.height)};
+    auto const tileCols{std::clamp(static_cast<std::size_t>(std::lround(std::sqrt(static_cast<double>(tileCount) * aspect))), 1UZ, grid.cells.width)};
+    auto const tileRows{std::clamp((tileCount + tileCols - 1U) / tileCols, 1UZ, grid.cells.height)};
+
+    std::vector<std::pair<double, Tile>> weighted;
+    weighted.reserve(tileRows * tileCols);
+
+    for (std::size_t row{0}; row < tileRows; ++row)
+    {
+        for (std::size_t col{0}; col < tileCols; ++col)
+        {
+            CellRange const range{row * grid.cells.height / tileRows, (row + 1U) * grid.cells.height / tileRows, col * grid.cells.width / tileCols, (col + 1U) * grid.cells.width / tileCols};
+
+            weighted.emplace_back(table.Sum(range), ToTile(range, grid, imageSize));
+        }
+    }
+
+    std::ranges::stable_sort(weighted, std::ranges::greater{}, [](auto const & entry) { return entry.first; });
+
+    std::vector<Tile> tiles;
+    tiles.reserve(weighted.size());
+
+    for (auto const & tile : weighted | std::views::values)
+    {
+        tiles.push_back(tile);
+    }
+
+    return tiles;
+}
+
+auto MakeCurveTiles(Size const & imageSize, std::size_t const tileSize, Partitioning const curve) -> std::vector<Tile>
+{
+    Size const tiles{(imageSize.width + tileSize - 1U) / tileSize, (imageSize.height + tileSize - 1U) / tileSize};
+    auto const side{std::bit_ceil(std::max(tiles.width, tiles.height))};
+
+    std::vector<Tile> order;
+    order.reserve(tiles.width * tiles.height);
+
+    // The curve covers the enclosing power-of-two square, and the positions outside the image are skipped
+    for (std::size_t index{0}; index < side * side; ++index)
+    {
+        auto const tile{curve == Partitioning::HILBERT ? HilbertToPixel(side, index) : MortonToPixel(index)};
+
+        if (tile.x < tiles.width && tile.y < tiles.height)
+        {
+            order.emplace_back(
+                tile.y * tileSize, std::min((tile.y + 1U) * tileSize, imageSize.height), tileSize,
+                tile.x * tileSize, std::min((tile.x + 1U) * tileSize, imageSize.width), tileSize
+            );
+        }
+    }
+
+    return order;
+}
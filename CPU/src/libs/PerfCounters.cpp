@@ -0,0 +1,367 @@
+#include "PerfCounters.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <print>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+    constexpr int INVALID_DESCRIPTOR{-1};
+
+    constexpr std::array<std::string_view, COUNTER_COUNT> COUNTER_NAMES{
+        "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "scalar_fp_instructions", "vector_fp_instructions",
+    };
+
+#ifdef __linux__
+    struct EventConfig
+    {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    struct Reading
+    {
+        std::uint64_t value;
+        std::uint64_t timeEnabled;
+        std::uint64_t timeRunning;
+    };
+
+    auto IsIntel() -> bool
+    {
+        std::ifstream cpuInfo{"/proc/cpuinfo"};
+        std::string line;
+
+        while (std::getline(cpuInfo, line))
+        {
+            if (line.starts_with("vendor_id"))
+            {
+                return line.contains("GenuineIntel");
+            }
+        }
+
+        return false;
+    }
+
+    auto GetEventConfigs() -> std::array<std::optional<EventConfig>, COUNTER_COUNT>
+    {
+        static constexpr auto CACHE_READ_MISS{(PERF_COUNT_HW_CACHE_OP_READ << 8U) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U)};
+
+        // FP_ARITH_INST_RETIRED (event 0xC7): the low two umask bits are scalar, the remaining six are the 128, 256 and 512-bit packed forms
+        static constexpr std::uint64_t FP_ARITH_EVENT{0xC7};
+        static constexpr std::uint64_t FP_SCALAR_UMASK{0x03};
+        static constexpr std::uint64_t FP_VECTOR_UMASK{0xFC};
+
+        std::array<std::optional<EventConfig>, COUNTER_COUNT> configs{
+            EventConfig{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            EventConfig{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            EventConfig{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            EventConfig{PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | CACHE_READ_MISS},
+            EventConfig{PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | CACHE_READ_MISS},
+        };
+
+        // There is no portable floating point event, so the raw encoding is only used where it is known to mean the same thing
+        if (IsIntel())
+        {
+            configs[static_cast<std::size_t>(Counter::SCALAR_FP_INSTRUCTIONS)] = EventConfig{PERF_TYPE_RAW, (FP_SCALAR_UMASK << 8U) | FP_ARITH_EVENT};
+            configs[static_cast<std::size_t>(Counter::VECTOR_FP_INSTRUCTIONS)] = EventConfig{PERF_TYPE_RAW, (FP_VECTOR_UMASK << 8U) | FP_ARITH_EVENT};
+        }
+
+        return configs;
+    }
+
+    auto OpenEvent(EventConfig const & event) -> int
+    {
+        perf_event_attr attributes{};
+        attributes.size = sizeof(attributes);
+        attributes.type = event.type;
+        attributes.config = event.config;
+        attributes.disabled = 1U;
+        attributes.exclude_kernel = 1U;
+        attributes.exclude_hv = 1U;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+
+    // Counters that were multiplexed with others are scaled up by the fraction of the time they were actually scheduled
+    auto ReadEvent(int const descriptor) -> std::optional<double>
+    {
+        Reading reading{};
+
+        if (read(descriptor, &reading, sizeof(reading)) != sizeof(reading) || reading.timeRunning == 0U)
+        {
+            return std::nullopt;
+        }
+
+        return static_cast<double>(reading.value) * static_cast<double>(reading.timeEnabled) / static_cast<double>(reading.timeRunning);
+    }
+
+    auto Control(std::array<int, COUNTER_COUNT> const & descriptors, unsigned long const request) -> void
+    {
+        for (auto const descriptor : descriptors)
+        {
+            if (descriptor != INVALID_DESCRIPTOR)
+            {
+                ioctl(descriptor, request, 0);
+            }
+        }
+    }
+#endif
+}
+
+
+auto CounterSample::Get(Counter const counter) const -> std::optional<double>
+{
+    return values[static_cast<std::size_t>(counter)];
+}
+
+auto GetCounterName(Counter const counter) -> std::string_view
+{
+    return COUNTER_NAMES[static_cast<std::size_t>(counter)];
+}
+
+auto GetInstructionsPerCycle(CounterSample const & sample) -> std::optional<double>
+{
+    auto const cycles{sample.Get(Counter::CYCLES)};
+    auto const instructions{sample.Get(Counter::INSTRUCTIONS)};
+
+    if (!cycles || !instructions || *cycles == 0.0)
+    {
+        return std::nullopt;
+    }
+
+    return *instructions / *cycles;
+}
+
+auto GetVectorUtilisation(CounterSample const & sample) -> std::optional<double>
+{
+    auto const scalar{sample.Get(Counter::SCALAR_FP_INSTRUCTIONS)};
+    auto const vector{sample.Get(Counter::VECTOR_FP_INSTRUCTIONS)};
+
+    if (!scalar || !vector || *scalar + *vector == 0.0)
+    {
+        return std::nullopt;
+    }
+
+    return *vector / (*scalar + *vector);
+}
+
+PerfCounters::ArenaObserver::ArenaObserver(oneapi::tbb::task_arena & arena, PerfCounters & counters) : task_scheduler_observer{arena}, counters{counters}
+{
+    observe(true);
+}
+
+PerfCounters::ArenaObserver::~ArenaObserver()
+{
+    observe(false);
+}
+
+auto PerfCounters::ArenaObserver::on_scheduler_entry(bool const) -> void
+{
+    counters.RegisterCurrentThread();
+}
+
+PerfCounters::PerfCounters(oneapi::tbb::task_arena * const renderArena)
+{
+    RegisterCurrentThread();
+
+    isAvailable = !threads.empty() && threads.front().descriptors[static_cast<std::size_t>(Counter::CYCLES)] != INVALID_DESCRIPTOR;
+
+    if (isAvailable)
+    {
+        observe(true);
+
+        if (renderArena != nullptr)
+        {
+            arenaObserver.emplace(*renderArena, *this);
+        }
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    observe(false);
+    arenaObserver.reset();
+
+#ifdef __linux__
+    for (auto const & thread : threads)
+    {
+        for (auto const descriptor : thread.descriptors)
+        {
+            if (descriptor != INVALID_DESCRIPTOR)
+            {
+                close(descriptor);
+            }
+        }
+    }
+#endif
+}
+
+auto PerfCounters::RegisterCurrentThread() -> void
+{
+#ifdef __linux__
+    static auto const EVENT_CONFIGS{GetEventConfigs()};
+
+    auto const systemThread{static_cast<int>(gettid())};
+
+    std::scoped_lock const lock{mutex};
+
+    if (std::ranges::find(threads, systemThread, &ThreadCounters::systemThread) != threads.end())
+    {
+        return;
+    }
+
+    ThreadCounters counters{std::max(0, oneapi::tbb::this_task_arena::current_thread_index()), systemThread, {}};
+
+    for (std::size_t counter{0}; counter < COUNTER_COUNT; ++counter)
+    {
+        counters.descriptors[counter] = EVENT_CONFIGS[counter] ? OpenEvent(*EVENT_CONFIGS[counter]) : INVALID_DESCRIPTOR;
+    }
+
+    // A thread joining while the counters are running starts counting straight away
+    if (isRunning)
+    {
+        Control(counters.descriptors, PERF_EVENT_IOC_ENABLE);
+    }
+
+    threads.push_back(counters);
+#endif
+}
+
+auto PerfCounters::on_scheduler_entry(bool const) -> void
+{
+    RegisterCurrentThread();
+}
+
+auto PerfCounters::Start() -> void
+{
+#ifdef __linux__
+    RegisterCurrentThread();
+
+    std::scoped_lock const lock{mutex};
+
+    for (auto const & thread : threads)
+    {
+        Control(thread.descriptors, PERF_EVENT_IOC_RESET);
+        Control(thread.descriptors, PERF_EVENT_IOC_ENABLE);
+    }
+
+    isRunning = true;
+#endif
+}
+
+auto PerfCounters::Stop() -> void
+{
+#ifdef __linux__
+    std::scoped_lock const lock{mutex};
+
+    isRunning = false;
+    samples.clear();
+
+    for (auto const & thread : threads)
+    {
+        Control(thread.descriptors, PERF_EVENT_IOC_DISABLE);
+
+        CounterSample sample{thread.thread, {}};
+
+        for (std::size_t counter{0}; counter < COUNTER_COUNT; ++counter)
+        {
+            if (thread.descriptors[counter] != INVALID_DESCRIPTOR)
+            {
+                sample.values[counter] = ReadEvent(thread.descriptors[counter]);
+            }
+        }
+
+        samples.push_back(sample);
+    }
+
+    std::ranges::sort(samples, {}, &CounterSample::thread);
+#endif
+}
+
+auto PerfCounters::IsAvailable() const -> bool
+{
+    return isAvailable;
+}
+
+auto PerfCounters::GetThreadSamples() const -> std::vector<CounterSample> const &
+{
+    return samples;
+}
+
+auto PerfCounters::GetTotal() const -> CounterSample
+{
+    CounterSample total{-1, {}};
+
+    for (auto const & sample : samples)
+    {
+        for (std::size_t counter{0}; counter < COUNTER_COUNT; ++counter)
+        {
+            if (sample.values[counter])
+            {
+                total.values[counter] = total.values[counter].value_or(0.0) + *sample.values[counter];
+            }
+        }
+    }
+
+    return total;
+}
+
+auto PrintCounters(PerfCounters const & counters, std::FILE * const stream) -> void
+{
+    if (!counters.IsAvailable())
+    {
+        std::println(stream, "Hardware counters are not available (check /proc/sys/kernel/perf_event_paranoid).");
+        return;
+    }
+
+    auto const format{
+        [](std::optional<double> const value) -> std::string
+        {
+            return value ? std::format("{:.0f}", *value) : "n/a";
+        }
+    };
+
+    auto const printRow{
+        [&](std::string_view const label, CounterSample const & sample) -> void
+        {
+            auto const ipc{GetInstructionsPerCycle(sample)};
+            auto const vector{GetVectorUtilisation(sample)};
+
+            std::print(stream, "{:>8}", label);
+
+            for (auto const & value : sample.values)
+            {
+                std::print(stream, " {:>16}", format(value));
+            }
+
+            std::println(stream, " {:>6} {:>8}", ipc ? std::format("{:.2f}", *ipc) : "n/a", vector ? std::format("{:.1f}%", 100.0 * *vector) : "n/a");
+        }
+    };
+
+    std::print(stream, "{:>8}", "thread");
+
+    for (auto const name : COUNTER_NAMES)
+    {
+        std::print(stream, " {:>16}", name.substr(0U, 16U));
+    }
+
+    std::println(stream, " {:>6} {:>8}", "IPC", "vector");
+
+    for (auto const & sample : counters.GetThreadSamples())
+    {
+        printRow(std::to_string(sample.thread), sample);
+    }
+
+    printRow("total", counters.GetTotal());
+}
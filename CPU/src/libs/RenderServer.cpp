@@ -0,0 +1,463 @@
+#include "RenderServer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "Trace.hpp"
+#include "Tuning.hpp"
+
+
+namespace
+{
+    constexpr std::size_t MAX_DIMENSION{16384};
+    // Together with MAX_DIMENSION this bounds how long one request can keep every core busy
+    constexpr std::size_t MAX_ITERATIONS{100000};
+    constexpr std::size_t MAX_HEADER_SIZE{8192};
+    constexpr int BACKLOG{64};
+    constexpr long RECEIVE_TIMEOUT_SECONDS{10};
+    // A client that stops reading fails the write instead of holding a handler thread, and the render of a tile stream with it
+    constexpr long SEND_TIMEOUT_SECONDS{10};
+
+    auto ParseHexDigit(char const digit) -> int
+    {
+        if (digit >= '0' && digit <= '9')
+        {
+            return digit - '0';
+        }
+
+        if (digit >= 'a' && digit <= 'f')
+        {
+            return digit - 'a' + 10;
+        }
+
+        if (digit >= 'A' && digit <= 'F')
+        {
+            return digit - 'A' + 10;
+        }
+
+        throw std::invalid_argument(std::format("Invalid percent encoding {} in the query.", digit));
+    }
+
+    // Clients are free to percent-encode the commas of the coordinate lists
+    auto DecodeQueryValue(std::string_view const value) -> std::string
+    {
+        std::string decoded;
+
+        for (std::size_t index{0}; index < value.size(); ++index)
+        {
+            if (value[index] == '%' && index + 2U < value.size())
+            {
+                decoded.push_back(static_cast<char>(ParseHexDigit(value[index + 1U]) * 16 + ParseHexDigit(value[index + 2U])));
+                index += 2U;
+            }
+            else
+            {
+                decoded.push_back(value[index] == '+' ? ' ' : value[index]);
+            }
+        }
+
+        return decoded;
+    }
+
+    auto ParseCoordinates(std::string_view const name, std::string_view const value, std::size_t const count) -> std::vector<float>
+    {
+        auto const items{SplitList(value)};
+
+        if (items.size() != count)
+        {
+            throw std::invalid_argument(std::format("The {} parameter needs {} comma separated numbers.", name, count));
+        }
+
+        std::vector<float> coordinates;
+
+        for (auto const item : items)
+        {
+            coordinates.push_back(std::stof(std::string{item}));
+        }
+
+        return coordinates;
+    }
+
+    auto ReadHeader(int const connection) -> std::optional<std::string>
+    {
+        std::string header;
+        std::array<char, 1024> buffer{};
+
+        while (header.find("\r\n\r\n") == std::string::npos)
+        {
+            auto const received{recv(connection, buffer.data(), buffer.size(), 0)};
+
+            if (received <= 0 || header.size() + static_cast<std::size_t>(received) > MAX_HEADER_SIZE)
+            {
+                return std::nullopt;
+            }
+
+            header.append(buffer.data(), static_cast<std::size_t>(received));
+        }
+
+        return header;
+    }
+
+    auto WriteError(std::FILE * const output, std::string_view const status, std::string_view const message) -> void
+    {
+        std::print(output, "HTTP/1.1 {}\r\nContent-Type: text/plain\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}\n", status, message.size() + 1U, message);
+    }
+}
+
+
+auto ParseRenderRequest(std::string_view const query) -> RenderRequest
+{
+    RenderRequest request{};
+
+    for (auto const parameter : SplitList(query, '&'))
+    {
+        auto const separator{parameter.find('=')};
+        auto const name{parameter.substr(0U, separator)};
+        auto const value{separator == std::string_view::npos ? std::string{} : DecodeQueryValue(parameter.substr(separator + 1U))};
+
+        if (name == "fractal")
+        {
+            request.type = ParseFractalType(value);
+        }
+        else if (name == "size")
+        {
+            request.imageSize = ParseSize(value);
+        }
+        else if (name == "iterations")
+        {
+            request.maxIterations = std::stoul(value);
+        }
+        else if (name == "layout")
+        {
+            request.layout = ParsePixelLayout(value);
+        }
+        else if (name == "format")
+        {
+            request.format = ParseImageFormat(value);
+        }
+        else if (name == "viewport")
+        {
+            auto const corners{ParseCoordinates(name, value, 4U)};
+            request.viewport = Viewport{{corners[0], corners[1]}, {corners[2], corners[3]}};
+        }
+        else if (name == "c")
+        {
+            auto const point{ParseCoordinates(name, value, 2U)};
+            request.juliaPoint = {point[0], point[1]};
+        }
+        else if (name == "budget")
+        {
+            request.timeBudget = std::chrono::milliseconds{std::stol(value)};
+        }
+        else if (name == "fill")
+        {
+            if (value != "coarse" && value != "none")
+            {
+                throw std::invalid_argument(std::format("Unknown fill {}.", value));
+            }
+
+            request.isCoarseFilled = value == "coarse";
+        }
+        else
+        {
+            throw std::invalid_argument(std::format("Unknown parameter {}.", name));
+        }
+    }
+
+    if (request.imageSize.width == 0U || request.imageSize.height == 0U || request.imageSize.width > MAX_DIMENSION || request.imageSize.height > MAX_DIMENSION)
+    {
+        throw std::invalid_argument(std::format("Image sides must be between 1 and {} pixels.", MAX_DIMENSION));
+    }
+
+    if (request.maxIterations == 0U || request.maxIterations > MAX_ITERATIONS)
+    {
+        throw std::invalid_argument(std::format("Iterations must be between 1 and {}.", MAX_ITERATIONS));
+    }
+
+    return request;
+}
+
+auto GetServerOptions(int const argc, char const * const argv[]) -> ServerOptions
+{
+    auto const defaultSocket{(std::filesystem::temp_directory_path() / "fractal-render.sock").string()};
+
+    return {
+        std::string{GetOption(argc, argv, "socket", defaultSocket)},
+        std::stoi(std::string{GetOption(argc, argv, "port", "0")}),
+        std::stoul(std::string{GetOption(argc, argv, "max-requests", "0")}),
+        GetArenaOptions(argc, argv),
+    };
+}
+
+RenderServer::RenderServer(ServerOptions serverOptions) : options{std::move(serverOptions)}, listener{"127.0.0.1", options.port, options.socketPath}
+{
+    // The same arena setup as a single generator gets, only shared by every request
+    InitializeArena(arena, options.arenaOptions, arenaPinning);
+
+    connections.set_capacity(BACKLOG);
+}
+
+auto RenderServer::Run() -> void
+{
+    // A client that hangs up while its image streams must fail the write instead of killing the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // The first render starts the arena workers, reads the tuning cache and leaves an image in the buffer pool
+    static_cast<void>(Render(RenderRequest{}));
+
+    auto const handlerCount{options.maxRequests > 0U ? options.maxRequests : static_cast<std::size_t>(arena.max_concurrency())};
+    std::vector<std::jthread> handlers;
+
+    for (std::size_t handler{0}; handler < handlerCount; ++handler)
+    {
+        handlers.emplace_back(
+            [this]() -> void
+            {
+                for (Connection connection{}; ; )
+                {
+                    connections.pop(connection);
+
+                    if (connection.socket < 0)
+                    {
+                        return;
+                    }
+
+                    Serve(connection);
+                }
+            }
+        );
+    }
+
+    listener.Run([this](int const connection) -> void { connections.push({connection, std::chrono::steady_clock::now()}); });
+
+    // Connections that were already accepted are still answered before the handlers see the end marker
+    for (std::size_t handler{0}; handler < handlerCount; ++handler)
+    {
+        connections.push({-1, {}});
+    }
+}
+
+auto RenderServer::Stop() -> void
+{
+    listener.Stop();
+}
+
+auto RenderServer::MakeGenerator(RenderRequest const & request) const -> std::unique_ptr<FractalGenerator>
+{
+    auto generator{MakeFractalGenerator(
+        request.type, request.imageSize, GetGrainSize(request.imageSize, arena.max_concurrency()), request.viewport.value_or(GetDefaultViewport(request.type)),
+        request.maxIterations, request.layout, request.juliaPoint
+    )};
+
+    if (auto const config{LookupTuning(generator->GetTuningKey())})
+    {
+        generator->ApplyTuning(*config);
+    }
+
+    // A tuned thread count would fence the request off into an arena of its own
+    generator->SetThreads(0);
+    generator->SetTimeBudget(request.timeBudget, request.isCoarseFilled);
+
+    return generator;
+}
+
+auto RenderServer::Render(RenderRequest const & request) -> std::unique_ptr<FractalGenerator>
+{
+    TRACE_SCOPE("serve render");
+
+    auto generator{MakeGenerator(request)};
+
+    arena.execute(
+        [&generator]() -> void
+        {
+            generator->Render();
+            generator->Detile();
+        }
+    );
+
+    return generator;
+}
+
+// The first bytes leave after the first cell instead of the whole image. A client that hangs up cancels the render.
+auto RenderServer::StreamTiles(FractalGenerator & generator, std::FILE * const output) -> void
+{
+    auto & metrics{Metrics::GetDefault()};
+    Metrics::StageTimer const timer{metrics, Stage::RENDER};
+
+    auto render{generator.RenderAsync(&arena)};
+
+    std::print(output, "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nX-Render-Tiles: {}\r\nConnection: close\r\n\r\n", render.tiles->GetTileCount());
+
+    std::uint64_t written{0};
+
+    while (auto const tile{render.tiles->Next()})
+    {
+        auto const & view{tile->view};
+        auto const rowSize{view.size.width * GetChannels(view.layout)};
+        std::array<std::uint32_t, 4> const bounds{
+            static_cast<std::uint32_t>(tile->position.x), static_cast<std::uint32_t>(tile->position.y),
+            static_cast<std::uint32_t>(view.size.width), static_cast<std::uint32_t>(view.size.height),
+        };
+
+        // The header goes out in host order, which is little endian on every platform the server runs on
+        std::fwrite(bounds.data(), sizeof(std::uint32_t), bounds.size(), output);
+
+        for (std::size_t row{0}; row < view.size.height; ++row)
+        {
+            std::fwrite(view.data + row * view.stride, 1U, rowSize, output);
+        }
+
+        written += sizeof(bounds) + rowSize * view.size.height;
+
+        if (std::fflush(output) != 0)
+        {
+            generator.Cancel();
+        }
+    }
+
+    render.done.get();
+
+    metrics.AddIterations(generator.GetRenderedIterations());
+    metrics.AddBytesWritten(written);
+
+    if (generator.IsCancelled())
+    {
+        throw std::runtime_error("The client hung up.");
+    }
+}
+
+auto RenderServer::Serve(Connection const & connection) -> void
+{
+    auto & metrics{Metrics::GetDefault()};
+    auto const start{std::chrono::steady_clock::now()};
+
+    timeval const receiveTimeout{RECEIVE_TIMEOUT_SECONDS, 0};
+    timeval const sendTimeout{SEND_TIMEOUT_SECONDS, 0};
+    setsockopt(connection.socket, SOL_SOCKET, SO_RCVTIMEO, &receiveTimeout, sizeof(receiveTimeout));
+    setsockopt(connection.socket, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> output{fdopen(connection.socket, "wb"), &std::fclose};
+
+    if (!output)
+    {
+        close(connection.socket);
+        return;
+    }
+
+    auto const header{ReadHeader(connection.socket)};
+
+    if (!header)
+    {
+        return;
+    }
+
+    // Request line: <method> <target> <version>
+    auto const requestLine{std::string_view{*header}.substr(0U, header->find("\r\n"))};
+    auto const targetStart{requestLine.find(' ') + 1U};
+    auto const method{requestLine.substr(0U, targetStart - 1U)};
+    auto const target{requestLine.substr(targetStart, requestLine.find(' ', targetStart) - targetStart)};
+    auto const querySeparator{target.find('?')};
+    auto const path{target.substr(0U, querySeparator)};
+    auto const query{querySeparator == std::string_view::npos ? std::string_view{} : target.substr(querySeparator + 1U)};
+
+    std::string_view status{"200 OK"};
+    auto isStreaming{false};
+
+    try
+    {
+        if (method != "GET")
+        {
+            status = "405 Method Not Allowed";
+            WriteError(output.get(), status, "Only GET is supported.");
+        }
+        else if (path == "/metrics")
+        {
+            std::print(output.get(), "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n");
+            metrics.WritePrometheus(output.get());
+        }
+        else if (path == "/tiles")
+        {
+            metrics.RecordStage(Stage::QUEUE, start - connection.accepted);
+
+            auto const generator{MakeGenerator(ParseRenderRequest(query))};
+
+            isStreaming = true;
+            StreamTiles(*generator, output.get());
+        }
+        else if (path != "/render")
+        {
+            status = "404 Not Found";
+            WriteError(output.get(), status, "Renders are served at /render and /tiles.");
+        }
+        else
+        {
+            metrics.RecordStage(Stage::QUEUE, start - connection.accepted);
+
+            auto const request{ParseRenderRequest(query)};
+            std::unique_ptr<FractalGenerator> generator;
+
+            {
+                Metrics::StageTimer const timer{metrics, Stage::RENDER};
+                generator = Render(request);
+            }
+
+            metrics.AddIterations(generator->GetRenderedIterations());
+
+            Metrics::StageTimer const timer{metrics, Stage::ENCODE};
+
+            auto const completed{generator->GetCompletedTiles().completed};
+
+            isStreaming = true;
+            std::print(
+                output.get(), "HTTP/1.1 200 OK\r\nContent-Type: {}\r\nX-Render-Complete: {}\r\nX-Render-Tiles: {}/{}\r\nConnection: close\r\n\r\n",
+                GetMimeType(request.format), !generator->IsExpired(), std::ranges::count(completed, 1U), completed.size()
+            );
+            metrics.AddBytesWritten(WriteImage(generator->GetView(), request.format, output.get()));
+            std::fflush(output.get());
+        }
+    }
+    catch (std::exception const & exception)
+    {
+        // Once the image streams the status is out, so the connection is simply cut short
+        if (!isStreaming)
+        {
+            status = dynamic_cast<std::logic_error const *>(&exception) != nullptr ? "400 Bad Request" : "500 Internal Server Error";
+            WriteError(output.get(), status, exception.what());
+        }
+        else
+        {
+            status = "aborted";
+        }
+    }
+
+    if (path == "/render" || path == "/tiles")
+    {
+        metrics.AddRequest(status != "200 OK");
+    }
+
+    auto const elapsed{std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)};
+    std::println("{} {} {} in {} ms", method, target, status, elapsed.count());
+}
+
+auto RenderServer::GetAddress() const -> std::string
+{
+    return options.port > 0 ? std::format("http://{}", listener.GetAddress()) : listener.GetAddress();
+}
+
+auto RenderServer::GetConcurrency() const -> int
+{
+    return arena.max_concurrency();
+}
@@ -0,0 +1,341 @@
+#include "SharedFrame.hpp"
+
+#include <bit>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <format>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+
+namespace
+{
+    // The cells that FractalGenerator::RenderAsync publishes
+    constexpr std::size_t TILE_SIZE{64};
+    constexpr std::size_t BITMAP_ALIGNMENT{64};
+    constexpr std::size_t PIXEL_ALIGNMENT{4096};
+    constexpr std::size_t BITS_PER_WORD{64};
+
+#ifndef __linux__
+    constexpr std::chrono::milliseconds POLL_INTERVAL{1};
+#endif
+
+    auto RoundUp(std::size_t const value, std::size_t const multiple) -> std::size_t
+    {
+        return (value + multiple - 1U) / multiple * multiple;
+    }
+
+    [[noreturn]] auto ThrowSystemError(std::string_view const action, std::string_view const name) -> void
+    {
+        throw std::runtime_error(std::format("Could not {} the shared frame {} ({}).", action, name, std::strerror(errno)));
+    }
+
+    // Every field a reader indexes with is checked against the mapping, so that a stale or foreign segment cannot make it read past the end. The sizes are
+    // compared by division, since a header written by anyone else may hold values whose products overflow.
+    auto IsConsistent(SharedFrameHeader const & header, std::size_t const mappingSize) -> bool
+    {
+        if (header.width == 0U || header.height == 0U || header.tileSize == 0U || header.layout > static_cast<std::uint32_t>(PixelLayout::INDEXED))
+        {
+            return false;
+        }
+
+        auto const isTiled{
+            header.tilesWide == (header.width + std::uint64_t{header.tileSize} - 1U) / header.tileSize &&
+            header.tilesHigh == (header.height + std::uint64_t{header.tileSize} - 1U) / header.tileSize
+        };
+        auto const bitmapSize{(std::uint64_t{header.tilesWide} * header.tilesHigh + BITS_PER_WORD - 1U) / BITS_PER_WORD * sizeof(std::uint64_t)};
+
+        auto const isBitmapMapped{
+            header.bitmapOffset >= sizeof(SharedFrameHeader) && header.bitmapOffset % alignof(std::atomic<std::uint64_t>) == 0U &&
+            header.bitmapOffset <= mappingSize && bitmapSize <= mappingSize - header.bitmapOffset
+        };
+        auto const isPixelMapped{
+            header.stride >= std::uint64_t{header.width} * GetChannels(static_cast<PixelLayout>(header.layout)) && header.pixelOffset <= mappingSize &&
+            header.stride <= (mappingSize - header.pixelOffset) / header.height
+        };
+
+        return isTiled && isBitmapMapped && isPixelMapped;
+    }
+
+    auto Map(int const descriptor, std::size_t const size, int const protection) -> void *
+    {
+        auto * const mapping{mmap(nullptr, size, protection, MAP_SHARED, descriptor, 0)};
+        auto const error{errno};
+
+        close(descriptor);
+        errno = error;
+
+        return mapping == MAP_FAILED ? nullptr : mapping;
+    }
+}
+
+
+SharedFrame::SharedFrame(std::string name, void * const mapping, std::size_t const mappingSize, bool const isOwner) : name{std::move(name)}, mapping{mapping},
+    mappingSize{mappingSize}, isOwner{isOwner}, header{static_cast<SharedFrameHeader *>(mapping)} { }
+
+SharedFrame::SharedFrame(SharedFrame && other) noexcept : name{other.name}, mapping{std::exchange(other.mapping, nullptr)}, mappingSize{other.mappingSize},
+    isOwner{std::exchange(other.isOwner, false)}, header{other.header} { }
+
+SharedFrame::~SharedFrame()
+{
+    if (mapping != nullptr)
+    {
+        munmap(mapping, mappingSize);
+    }
+
+    if (isOwner)
+    {
+        shm_unlink(name.c_str());
+    }
+}
+
+auto SharedFrame::Create(std::string const & name, Size const & imageSize, PixelLayout const layout) -> SharedFrame
+{
+    if (imageSize.width == 0U || imageSize.height == 0U)
+    {
+        throw std::invalid_argument("The shared frame must not be empty.");
+    }
+
+    auto const tilesWide{(imageSize.width + TILE_SIZE - 1U) / TILE_SIZE};
+    auto const tilesHigh{(imageSize.height + TILE_SIZE - 1U) / TILE_SIZE};
+    auto const stride{imageSize.width * GetChannels(layout)};
+    auto const bitmapOffset{RoundUp(sizeof(SharedFrameHeader), BITMAP_ALIGNMENT)};
+    auto const pixelOffset{RoundUp(bitmapOffset + (tilesWide * tilesHigh + BITS_PER_WORD - 1U) / BITS_PER_WORD * sizeof(std::uint64_t), PIXEL_ALIGNMENT)};
+    auto const size{pixelOffset + stride * imageSize.height};
+
+    // A fresh segment instead of resizing the old one, whose readers keep their mapping of it
+    shm_unlink(name.c_str());
+
+    auto const descriptor{shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600)};
+
+    if (descriptor < 0)
+    {
+        ThrowSystemError("create", name);
+    }
+
+    void * mapping{nullptr};
+
+    if (ftruncate(descriptor, static_cast<off_t>(size)) == 0)
+    {
+        mapping = Map(descriptor, size, PROT_READ | PROT_WRITE);
+    }
+    else
+    {
+        close(descriptor);
+    }
+
+    if (mapping == nullptr)
+    {
+        auto const error{errno};
+        shm_unlink(name.c_str());
+        errno = error;
+
+        ThrowSystemError("map", name);
+    }
+
+    // The rest of the segment, bitmap included, starts out zeroed
+    new (mapping) SharedFrameHeader{
+        SHARED_FRAME_MAGIC, SHARED_FRAME_VERSION, static_cast<std::uint32_t>(imageSize.width), static_cast<std::uint32_t>(imageSize.height),
+        static_cast<std::uint32_t>(layout), static_cast<std::uint32_t>(TILE_SIZE), static_cast<std::uint32_t>(tilesWide), static_cast<std::uint32_t>(tilesHigh),
+        stride, bitmapOffset, pixelOffset, 0U, 0U, 0U, DEFAULT_PALETTE,
+    };
+
+    return {name, mapping, size, true};
+}
+
+auto SharedFrame::Open(std::string const & name) -> SharedFrame
+{
+    auto const descriptor{shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0)};
+
+    if (descriptor < 0)
+    {
+        ThrowSystemError("open", name);
+    }
+
+    struct stat status{};
+
+    if (fstat(descriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(SharedFrameHeader))
+    {
+        close(descriptor);
+        throw std::runtime_error(std::format("{} is not a shared frame.", name));
+    }
+
+    auto const size{static_cast<std::size_t>(status.st_size)};
+    auto * const mapping{Map(descriptor, size, PROT_READ)};
+
+    if (mapping == nullptr)
+    {
+        ThrowSystemError("map", name);
+    }
+
+    SharedFrame frame{name, mapping, size, false};
+    auto const & header{frame.GetHeader()};
+
+    if (header.magic != SHARED_FRAME_MAGIC || header.version != SHARED_FRAME_VERSION)
+    {
+        throw std::runtime_error(std::format("{} is not a shared frame of version {}.", name, SHARED_FRAME_VERSION));
+    }
+
+    if (!IsConsistent(header, size))
+    {
+        throw std::runtime_error(std::format("The header of the shared frame {} does not match its {} bytes.", name, size));
+    }
+
+    return frame;
+}
+
+auto SharedFrame::Render(FractalGenerator & generator, oneapi::tbb::task_arena * const arena) -> void
+{
+    if (!isOwner)
+    {
+        throw std::runtime_error("Only the process that created a shared frame renders into it.");
+    }
+
+    // Checked before the generator gets to point into the segment
+    auto const & imageSize{generator.GetImageSize()};
+
+    if (imageSize.width != header->width || imageSize.height != header->height || static_cast<std::uint32_t>(generator.GetPixelLayout()) != header->layout)
+    {
+        throw std::invalid_argument("The generator does not match the size and layout of the shared frame.");
+    }
+
+    // Odd from here on, so readers drop whatever they copied of the previous frame. The palette and the flags below are only written while it is odd.
+    header->sequence.fetch_add(1U, std::memory_order_acq_rel);
+
+    AsyncRender render;
+
+    try
+    {
+        generator.UseBuffer(static_cast<std::uint8_t *>(mapping) + header->pixelOffset, header->stride);
+
+        header->palette = *generator.GetView().palette;
+        header->complete.store(0U, std::memory_order_relaxed);
+
+        auto * const bitmap{GetBitmap()};
+
+        for (std::size_t word{0}; word < (GetTileCount() + BITS_PER_WORD - 1U) / BITS_PER_WORD; ++word)
+        {
+            bitmap[word].store(0U, std::memory_order_relaxed);
+        }
+
+        Notify();
+
+        render = generator.RenderAsync(arena);
+
+        while (auto const tile{render.tiles->Next()})
+        {
+            auto const index{tile->position.y / header->tileSize * header->tilesWide + tile->position.x / header->tileSize};
+
+            bitmap[index / BITS_PER_WORD].fetch_or(std::uint64_t{1} << (index % BITS_PER_WORD), std::memory_order_release);
+            Notify();
+        }
+    }
+    catch (...)
+    {
+        // Readers must never be left waiting on an odd sequence, and nothing of this frame is to be trusted
+        header->complete.store(0U, std::memory_order_relaxed);
+        header->sequence.fetch_add(1U, std::memory_order_release);
+        Notify();
+        throw;
+    }
+
+    // Even again when the render failed or stopped early as well, only the complete flag and the bitmap tell the readers what they got. Every cell is published
+    // once all of its pixels are written, so a full bitmap means a whole frame.
+    header->complete.store(CountReadyTiles() == GetTileCount() ? 1U : 0U, std::memory_order_relaxed);
+    header->sequence.fetch_add(1U, std::memory_order_release);
+    Notify();
+
+    render.done.get();
+}
+
+auto SharedFrame::WaitForEvents(std::uint32_t const seen, std::chrono::milliseconds const timeout) const -> std::uint32_t
+{
+#ifdef __linux__
+    auto const seconds{std::chrono::duration_cast<std::chrono::seconds>(timeout)};
+    timespec const relative{static_cast<time_t>(seconds.count()), static_cast<long>(std::chrono::nanoseconds{timeout - seconds}.count())};
+
+    // Not the private futex that std::atomic::wait uses, which only wakes threads of the same process. The call returns at once when the count already moved on.
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t const *>(&header->events), FUTEX_WAIT, seen, &relative, nullptr, 0);
+#else
+    auto const deadline{std::chrono::steady_clock::now() + timeout};
+
+    while (header->events.load(std::memory_order_acquire) == seen && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+#endif
+
+    return header->events.load(std::memory_order_acquire);
+}
+
+auto SharedFrame::IsTileReady(std::size_t const tile) const -> bool
+{
+    return ((GetBitmap()[tile / BITS_PER_WORD].load(std::memory_order_acquire) >> (tile % BITS_PER_WORD)) & 1U) != 0U;
+}
+
+auto SharedFrame::CountReadyTiles() const -> std::size_t
+{
+    std::size_t count{0};
+
+    for (std::size_t word{0}; word < (GetTileCount() + BITS_PER_WORD - 1U) / BITS_PER_WORD; ++word)
+    {
+        count += static_cast<std::size_t>(std::popcount(GetBitmap()[word].load(std::memory_order_acquire)));
+    }
+
+    return count;
+}
+
+auto SharedFrame::IsComplete() const -> bool
+{
+    return header->sequence.load(std::memory_order_acquire) % 2U == 0U && header->complete.load(std::memory_order_relaxed) != 0U;
+}
+
+auto SharedFrame::GetTileCount() const -> std::size_t
+{
+    return static_cast<std::size_t>(header->tilesWide) * header->tilesHigh;
+}
+
+auto SharedFrame::GetHeader() const -> SharedFrameHeader const &
+{
+    return *header;
+}
+
+auto SharedFrame::GetView() const -> ImageView
+{
+    return {
+        static_cast<std::uint8_t const *>(mapping) + header->pixelOffset, {header->width, header->height}, header->stride, static_cast<PixelLayout>(header->layout),
+        &header->palette,
+    };
+}
+
+auto SharedFrame::GetName() const -> std::string const &
+{
+    return name;
+}
+
+auto SharedFrame::GetBitmap() const -> std::atomic<std::uint64_t> *
+{
+    return reinterpret_cast<std::atomic<std::uint64_t> *>(static_cast<std::uint8_t *>(mapping) + header->bitmapOffset);
+}
+
+auto SharedFrame::Notify() -> void
+{
+    header->events.fetch_add(1U, std::memory_order_release);
+
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&header->events), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
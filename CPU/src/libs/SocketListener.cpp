@@ -0,0 +1,163 @@
+#include "SocketListener.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <print>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+namespace
+{
+    constexpr int BACKLOG{64};
+
+    [[noreturn]] auto ThrowSocketError(std::string_view const action, std::string_view const address) -> void
+    {
+        throw std::runtime_error(std::format("Could not {} {} ({}).", action, address, std::strerror(errno)));
+    }
+
+    // A socket file nobody accepts on refuses connections, while a live server must be left alone
+    auto IsStaleSocket(sockaddr_un const & address) -> bool
+    {
+        auto const probe{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+
+        if (probe < 0)
+        {
+            return false;
+        }
+
+        auto const isConnected{::connect(probe, reinterpret_cast<sockaddr const *>(&address), sizeof(sockaddr_un)) == 0};
+        auto const isRefused{!isConnected && errno == ECONNREFUSED};
+        close(probe);
+
+        return isRefused;
+    }
+}
+
+
+SocketListener::SocketListener(std::string listenHost, int const listenPort, std::string listenSocketPath) : host{std::move(listenHost)}, port{listenPort},
+    socketPath{std::move(listenSocketPath)}
+{
+    auto const address{GetAddress()};
+
+    sockaddr_storage local{};
+    socklen_t localSize{0};
+
+    if (port > 0)
+    {
+        auto & inet{reinterpret_cast<sockaddr_in &>(local)};
+        inet.sin_family = AF_INET;
+        inet.sin_port = htons(static_cast<std::uint16_t>(port));
+        localSize = sizeof(sockaddr_in);
+
+        if (inet_pton(AF_INET, host.c_str(), &inet.sin_addr) != 1)
+        {
+            throw std::invalid_argument(std::format("The bind address {} is not an IPv4 address.", host));
+        }
+    }
+    else
+    {
+        auto & domain{reinterpret_cast<sockaddr_un &>(local)};
+
+        if (socketPath.empty() || socketPath.size() >= sizeof(domain.sun_path))
+        {
+            throw std::invalid_argument(std::format("The socket path must have between 1 and {} characters.", sizeof(domain.sun_path) - 1U));
+        }
+
+        domain.sun_family = AF_UNIX;
+        std::ranges::copy(socketPath, domain.sun_path);
+        localSize = sizeof(sockaddr_un);
+
+        // Connecting to a path that is not a socket is refused as well, so only a socket file may ever be probed and removed
+        if (struct stat status{}; lstat(socketPath.c_str(), &status) == 0)
+        {
+            if (!S_ISSOCK(status.st_mode))
+            {
+                throw std::invalid_argument(std::format("The socket path {} already exists and is not a socket.", socketPath));
+            }
+
+            // A socket file left over by a server that did not shut down cleanly would make the bind fail
+            if (IsStaleSocket(domain))
+            {
+                unlink(socketPath.c_str());
+            }
+        }
+    }
+
+    auto const listening{::socket(local.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+
+    if (listening < 0)
+    {
+        ThrowSocketError("open a socket for", address);
+    }
+
+    int const reuse{1};
+    setsockopt(listening, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (::bind(listening, reinterpret_cast<sockaddr const *>(&local), localSize) != 0 || ::listen(listening, BACKLOG) != 0)
+    {
+        auto const error{errno};
+        close(listening);
+        errno = error;
+
+        ThrowSocketError("listen on", address);
+    }
+
+    listener = listening;
+}
+
+SocketListener::~SocketListener()
+{
+    if (auto const listening{listener.exchange(-1)}; listening >= 0)
+    {
+        close(listening);
+
+        if (port <= 0)
+        {
+            unlink(socketPath.c_str());
+        }
+    }
+}
+
+auto SocketListener::Run(std::function<void(int connection)> const & handler) -> void
+{
+    while (!isStopping)
+    {
+        auto const connection{::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC)};
+
+        if (connection >= 0)
+        {
+            handler(connection);
+        }
+        else if (!isStopping && errno != EINTR && errno != ECONNABORTED)
+        {
+            std::println(stderr, "Could not accept on {} ({}), stopping.", GetAddress(), std::strerror(errno));
+            Stop();
+        }
+    }
+}
+
+auto SocketListener::Stop() -> void
+{
+    isStopping = true;
+
+    // Shutting the socket down wakes the accept call
+    if (auto const listening{listener.load()}; listening >= 0)
+    {
+        shutdown(listening, SHUT_RDWR);
+    }
+}
+
+auto SocketListener::GetAddress() const -> std::string
+{
+    return port > 0 ? std::format("{}:{}", host, port) : std::format("unix:{}", socketPath);
+}
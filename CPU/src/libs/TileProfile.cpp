@@ -0,0 +1,146 @@
+#include "TileProfile.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <print>
+#include <ranges>
+#include <stdexcept>
+
+#include "ImageWriter.hpp"
+#include "Palette.hpp"
+
+
+namespace
+{
+    constexpr auto MakeHeatPalette() -> Palette
+    {
+        Palette heat{};
+
+        // Black to red, red to yellow, yellow to white, so the hottest tiles stand out on any background
+        for (std::size_t index{0}; index < heat.size(); ++index)
+        {
+            auto const red{std::min(index * 3U, 255UZ)};
+            auto const green{index < 85U ? 0U : std::min((index - 85U) * 3U, 255UZ)};
+            auto const blue{index < 170U ? 0U : std::min((index - 170U) * 3U, 255UZ)};
+
+            heat[index] = {static_cast<std::uint8_t>(red), static_cast<std::uint8_t>(green), static_cast<std::uint8_t>(blue)};
+        }
+
+        return heat;
+    }
+
+    constexpr Palette HEAT_PALETTE{MakeHeatPalette()};
+
+    auto GetCostPerPixel(TileRecord const & record) -> double
+    {
+        return (record.endMilliseconds - record.startMilliseconds) / static_cast<double>(record.size.width * record.size.height);
+    }
+}
+
+
+auto SummarizeThreadLoads(std::vector<TileRecord> const & records) -> std::vector<ThreadLoad>
+{
+    std::vector<ThreadLoad> loads;
+
+    for (auto const & record : records)
+    {
+        auto load{std::ranges::find(loads, record.thread, &ThreadLoad::thread)};
+
+        if (load == loads.end())
+        {
+            load = loads.insert(loads.end(), {record.thread, 0U, 0U, 0.0, 0.0});
+        }
+
+        ++load->tiles;
+        load->iterations += record.iterations;
+        load->busyMilliseconds += record.endMilliseconds - record.startMilliseconds;
+        load->lastEndMilliseconds = std::max(load->lastEndMilliseconds, record.endMilliseconds);
+    }
+
+    std::ranges::sort(loads, {}, &ThreadLoad::thread);
+
+    return loads;
+}
+
+auto WriteTileRecordsCSV(std::vector<TileRecord> const & records, std::filesystem::path const & path) -> void
+{
+    std::ofstream file{path};
+
+    if (!file)
+    {
+        throw std::runtime_error(std::format("Could not open {} for writing.", path.string()));
+    }
+
+    file << "x,y,width,height,thread,start_ms,end_ms,wall_ms,iterations\n";
+
+    for (auto const & record : records)
+    {
+        file << std::format(
+            "{},{},{},{},{},{:.4f},{:.4f},{:.4f},{}\n", record.origin.x, record.origin.y, record.size.width, record.size.height, record.thread, record.startMilliseconds,
+            record.endMilliseconds, record.endMilliseconds - record.startMilliseconds, record.iterations
+        );
+    }
+}
+
+auto WriteTileHeatmap(std::vector<TileRecord> const & records, Size const & imageSize, std::filesystem::path const & path) -> void
+{
+    if (records.empty())
+    {
+        throw std::runtime_error("There are no tile records to draw.");
+    }
+
+    auto const maximumCost{std::ranges::max(records | std::views::transform(GetCostPerPixel))};
+
+    std::vector<std::uint8_t> heatmap(imageSize.width * imageSize.height);
+
+    for (auto const & record : records)
+    {
+        auto const value{static_cast<std::uint8_t>(maximumCost > 0.0 ? 255.0 * GetCostPerPixel(record) / maximumCost : 0.0)};
+
+        for (auto row{record.origin.y}; row < record.origin.y + record.size.height; ++row)
+        {
+            std::ranges::fill_n(heatmap.begin() + static_cast<std::ptrdiff_t>(row * imageSize.width + record.origin.x), static_cast<std::ptrdiff_t>(record.size.width), value);
+        }
+    }
+
+    WriteImage({heatmap.data(), imageSize, imageSize.width, PixelLayout::INDEXED, &HEAT_PALETTE}, path.string());
+}
+
+auto PrintLoadImbalance(std::vector<TileRecord> const & records, std::FILE * const stream) -> void
+{
+    auto const loads{SummarizeThreadLoads(records)};
+
+    if (loads.empty())
+    {
+        return;
+    }
+
+    auto const renderEnd{std::ranges::max(loads | std::views::transform(&ThreadLoad::lastEndMilliseconds))};
+    auto const maximumBusy{std::ranges::max(loads | std::views::transform(&ThreadLoad::busyMilliseconds))};
+
+    auto totalBusy{0.0};
+
+    std::println(stream, "{:>6} {:>6} {:>14} {:>10} {:>10}", "thread", "tiles", "iterations", "busy ms", "idle tail");
+
+    for (auto const & load : loads)
+    {
+        totalBusy += load.busyMilliseconds;
+
+        std::println(stream, "{:>6} {:>6} {:>14} {:>10.3f} {:>10.3f}", load.thread, load.tiles, load.iterations, load.busyMilliseconds, renderEnd - load.lastEndMilliseconds);
+    }
+
+    auto const meanBusy{totalBusy / static_cast<double>(loads.size())};
+
+    std::println(
+        stream, "{} tiles on {} threads in {:.3f} ms, load imbalance (max/mean busy) {:.3f}, parallel efficiency {:.1f}%", records.size(), loads.size(), renderEnd, maximumBusy / meanBusy,
+        100.0 * totalBusy / (renderEnd * static_cast<double>(loads.size()))
+    );
+}
+
+auto WriteTileProfile(std::vector<TileRecord> const & records, Size const & imageSize, std::string_view const prefix) -> void
+{
+    WriteTileRecordsCSV(records, std::format("{}-tiles.csv", prefix));
+    WriteTileHeatmap(records, imageSize, std::format("{}-heatmap.png", prefix));
+    PrintLoadImbalance(records, stdout);
+}
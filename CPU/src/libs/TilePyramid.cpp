@@ -0,0 +1,250 @@
+#include "TilePyramid.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+namespace
+{
+    constexpr std::size_t DZI_TILE_LEVEL{std::bit_width(TilePyramid::TILE_SIZE) - 1U};
+
+    auto GetSquareWorld(Viewport const & viewport) -> Viewport
+    {
+        auto const center{(viewport.topLeft + viewport.bottomRight) / 2.0F};
+        auto const halfExtent{std::max(viewport.bottomRight.real() - viewport.topLeft.real(), viewport.topLeft.imag() - viewport.bottomRight.imag()) / 2.0F};
+
+        return {center + Point{-halfExtent, halfExtent}, center + Point{halfExtent, -halfExtent}};
+    }
+
+    auto AverageRows(std::uint8_t const * const top, std::uint8_t const * const bottom, std::uint8_t * const average, std::size_t const size) -> void
+    {
+        std::size_t index{0};
+
+#if defined(__SSE2__)
+        for (; index + sizeof(__m128i) <= size; index += sizeof(__m128i))
+        {
+            auto const upper{_mm_loadu_si128(reinterpret_cast<__m128i const *>(top + index))};
+            auto const lower{_mm_loadu_si128(reinterpret_cast<__m128i const *>(bottom + index))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(average + index), _mm_avg_epu8(upper, lower));
+        }
+#endif
+
+        for (; index < size; ++index)
+        {
+            average[index] = static_cast<std::uint8_t>((top[index] + bottom[index] + 1U) / 2U);
+        }
+    }
+
+    // 2×2 box filter: a SIMD average of each row pair, then an average of the neighboring pixels in the result
+    auto Downsample(std::uint8_t const * const source, std::size_t const sourceStride, std::uint8_t * const target, std::size_t const targetStride, Size const & targetSize,
+        std::size_t const channels) -> void
+    {
+        using namespace oneapi::tbb;
+
+        parallel_for(
+            blocked_range<std::size_t>{0U, targetSize.height}, [&](auto const & range) -> void
+            {
+                std::vector<std::uint8_t> average(targetSize.width * 2U * channels);
+
+                for (auto row{range.begin()}; row < range.end(); ++row)
+                {
+                    auto const * const top{source + 2U * row * sourceStride};
+                    AverageRows(top, top + sourceStride, average.data(), average.size());
+
+                    auto * const output{target + row * targetStride};
+
+                    for (std::size_t x{0}; x < targetSize.width; ++x)
+                    {
+                        for (std::size_t channel{0}; channel < channels; ++channel)
+                        {
+                            output[x * channels + channel] = static_cast<std::uint8_t>((average[2U * x * channels + channel] + average[(2U * x + 1U) * channels + channel] + 1U) / 2U);
+                        }
+                    }
+                }
+            }
+        );
+    }
+}
+
+
+auto ParsePyramidScheme(std::string_view const name) -> PyramidScheme
+{
+    if (name == "xyz")
+    {
+        return PyramidScheme::XYZ;
+    }
+
+    if (name == "dzi")
+    {
+        return PyramidScheme::DZI;
+    }
+
+    throw std::invalid_argument(std::format("Unknown tile pyramid scheme {}.", name));
+}
+
+TilePyramid::TilePyramid(FractalType const type, std::size_t const maxLevel, std::size_t const maxIterations, PixelLayout const layout) : type{type}, maxLevel{maxLevel},
+    maxIterations{maxIterations}, layout{layout}, channels{GetChannels(layout)}, world{GetSquareWorld(GetDefaultViewport(type))} { }
+
+auto TilePyramid::Generate(std::filesystem::path const & outputDirectory, PyramidScheme const outputScheme, std::string_view const outputFormat) -> void
+{
+    directory = outputDirectory;
+    scheme = outputScheme;
+    format = outputFormat;
+
+    CreateDirectories();
+
+    auto const root{BuildTile(0U, 0U, 0U)};
+
+    if (scheme == PyramidScheme::DZI)
+    {
+        WriteOverviewLevels(root);
+
+        auto const size{TILE_SIZE << maxLevel};
+        std::ofstream descriptor{directory / std::format("{}.dzi", GetFractalName(type))};
+        descriptor << std::format(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"{}\" Overlap=\"0\" TileSize=\"{}\">\n"
+            "    <Size Width=\"{}\" Height=\"{}\"/>\n"
+            "</Image>\n", format, TILE_SIZE, size, size
+        );
+    }
+}
+
+auto TilePyramid::BuildTile(std::size_t const level, std::size_t const x, std::size_t const y) const -> Tile
+{
+    if (level == maxLevel)
+    {
+        auto tile{RenderTile(level, x, y)};
+        WriteTile(tile, {TILE_SIZE, TILE_SIZE}, level, x, y);
+
+        return tile;
+    }
+
+    std::array<Tile, 4> children;
+
+    oneapi::tbb::parallel_for(
+        0UZ, children.size(), [&](std::size_t const child) -> void
+        {
+            children[child] = BuildTile(level + 1U, 2U * x + child % 2U, 2U * y + child / 2U);
+        }
+    );
+
+    // Averaging palette indices does not average the colors, so indexed tiles are rendered at every level
+    auto tile{layout == PixelLayout::INDEXED ? RenderTile(level, x, y) : AssembleTile(children)};
+    WriteTile(tile, {TILE_SIZE, TILE_SIZE}, level, x, y);
+
+    return tile;
+}
+
+auto TilePyramid::RenderTile(std::size_t const level, std::size_t const x, std::size_t const y) const -> Tile
+{
+    auto const tileExtent{(world.bottomRight.real() - world.topLeft.real()) / static_cast<float>(1UZ << level)};
+    auto const topLeft{world.topLeft + Point{tileExtent * static_cast<float>(x), -tileExtent * static_cast<float>(y)}};
+    Viewport const viewport{topLeft, topLeft + Point{tileExtent, -tileExtent}};
+
+    Size const tileSize{TILE_SIZE, TILE_SIZE};
+    auto const grainSize{GetGrainSize(tileSize, oneapi::tbb::info::default_concurrency())};
+
+    Tile tile(TILE_SIZE * TILE_SIZE * channels);
+
+    auto const generator{MakeFractalGenerator(type, tileSize, grainSize, viewport, maxIterations, layout)};
+    generator->UseBuffer(tile.data(), TILE_SIZE * channels);
+    generator->Render();
+
+    return tile;
+}
+
+auto TilePyramid::AssembleTile(std::array<Tile, 4> const & children) const -> Tile
+{
+    static constexpr std::size_t HALF_TILE{TILE_SIZE / 2U};
+
+    auto const stride{TILE_SIZE * channels};
+
+    Tile tile(TILE_SIZE * stride);
+
+    oneapi::tbb::parallel_for(
+        0UZ, children.size(), [&](std::size_t const child) -> void
+        {
+            auto * const quadrant{tile.data() + (child / 2U) * HALF_TILE * stride + (child % 2U) * HALF_TILE * channels};
+            Downsample(children[child].data(), stride, quadrant, stride, {HALF_TILE, HALF_TILE}, channels);
+        }
+    );
+
+    return tile;
+}
+
+auto TilePyramid::WriteTile(Tile const & tile, Size const & size, std::size_t const level, std::size_t const x, std::size_t const y) const -> void
+{
+    WriteImage({tile.data(), size, size.width * channels, layout, &DEFAULT_PALETTE}, GetTilePath(level, x, y).string());
+}
+
+auto TilePyramid::WriteOverviewLevels(Tile const & root) const -> void
+{
+    auto current{root};
+    Size size{TILE_SIZE, TILE_SIZE};
+
+    for (auto level{DZI_TILE_LEVEL}; level > 0U; --level)
+    {
+        Size const halfSize{size.width / 2U, size.height / 2U};
+        Tile half(halfSize.width * halfSize.height * channels);
+
+        if (layout == PixelLayout::INDEXED)
+        {
+            for (std::size_t row{0}; row < halfSize.height; ++row)
+            {
+                for (std::size_t col{0}; col < halfSize.width; ++col)
+                {
+                    half[row * halfSize.width + col] = current[2U * row * size.width + 2U * col];
+                }
+            }
+        }
+        else
+        {
+            Downsample(current.data(), size.width * channels, half.data(), halfSize.width * channels, halfSize, channels);
+        }
+
+        current = std::move(half);
+        size = halfSize;
+
+        WriteImage({current.data(), size, size.width * channels, layout, &DEFAULT_PALETTE}, (directory / std::format("{}_files", GetFractalName(type)) / std::to_string(level - 1U) /
+            std::format("0_0.{}", format)).string());
+    }
+}
+
+auto TilePyramid::CreateDirectories() const -> void
+{
+    if (scheme == PyramidScheme::XYZ)
+    {
+        for (std::size_t level{0}; level <= maxLevel; ++level)
+        {
+            for (std::size_t x{0}; x < (1UZ << level); ++x)
+            {
+                std::filesystem::create_directories(directory / std::to_string(level) / std::to_string(x));
+            }
+        }
+
+        return;
+    }
+
+    for (std::size_t level{0}; level <= maxLevel + DZI_TILE_LEVEL; ++level)
+    {
+        std::filesystem::create_directories(directory / std::format("{}_files", GetFractalName(type)) / std::to_string(level));
+    }
+}
+
+auto TilePyramid::GetTilePath(std::size_t const level, std::size_t const x, std::size_t const y) const -> std::filesystem::path
+{
+    if (scheme == PyramidScheme::XYZ)
+    {
+        return directory / std::to_string(level) / std::to_string(x) / std::format("{}.{}", y, format);
+    }
+
+    return directory / std::format("{}_files", GetFractalName(type)) / std::to_string(level + DZI_TILE_LEVEL) / std::format("{}_{}.{}", x, y, format);
+}
@@ -0,0 +1,48 @@
+#include "TileStream.hpp"
+
+
+TileStream::TileStream(std::size_t const tileCount) : tileCount{tileCount} { }
+
+auto TileStream::Publish(CompletedTile const & tile) -> void
+{
+    tiles.push(tile);
+
+    version.fetch_add(1U, std::memory_order_release);
+    version.notify_one();
+}
+
+auto TileStream::Close() -> void
+{
+    isClosed.store(true, std::memory_order_release);
+
+    version.fetch_add(1U, std::memory_order_release);
+    version.notify_all();
+}
+
+auto TileStream::Next() -> std::optional<CompletedTile>
+{
+    CompletedTile tile{};
+
+    while (true)
+    {
+        // Loaded before looking at the queue, so that a tile published in between changes the version and the wait returns at once
+        auto const seen{version.load(std::memory_order_acquire)};
+
+        if (tiles.try_pop(tile))
+        {
+            return tile;
+        }
+
+        if (isClosed.load(std::memory_order_acquire))
+        {
+            return tiles.try_pop(tile) ? std::optional{tile} : std::nullopt;
+        }
+
+        version.wait(seen, std::memory_order_acquire);
+    }
+}
+
+auto TileStream::GetTileCount() const -> std::size_t
+{
+    return tileCount;
+}
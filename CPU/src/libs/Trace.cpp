@@ -0,0 +1,152 @@
+#include "Trace.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    struct TraceEvent
+    {
+        char const * name;
+        std::int64_t startNanoseconds;
+        std::int64_t durationNanoseconds;
+    };
+
+    // A ring of the latest events, so that a long-running server or worker records in bounded memory
+    struct ThreadBuffer
+    {
+        std::size_t thread;
+        std::vector<TraceEvent> events;
+        std::size_t recorded{0};
+    };
+
+    class TraceRegistry
+    {
+    public:
+        TraceRegistry() = default;
+
+        // The trace is dumped when the process exits, after the worker threads have gone idle
+        ~TraceRegistry()
+        {
+            auto const * const path{std::getenv("FRACTAL_TRACE")};
+
+            try
+            {
+                Write(path != nullptr ? path : "trace.json");
+            }
+            catch (std::exception const & exception)
+            {
+                std::println(stderr, "{}", exception.what());
+            }
+        }
+
+        auto Register() -> ThreadBuffer *
+        {
+            std::scoped_lock const lock{mutex};
+
+            auto & buffer{buffers.emplace_back(std::make_unique<ThreadBuffer>(buffers.size()))};
+            buffer->events.reserve(INITIAL_CAPACITY);
+
+            return buffer.get();
+        }
+
+        auto Write(std::filesystem::path const & path) -> void
+        {
+            std::scoped_lock const lock{mutex};
+
+            std::ofstream file{path};
+
+            if (!file)
+            {
+                throw std::runtime_error(std::format("Could not open {} for writing.", path.string()));
+            }
+
+            file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+            auto separator{""};
+
+            for (auto const & buffer : buffers)
+            {
+                file << std::format(R"({}{{"name": "thread_name", "ph": "M", "pid": 1, "tid": {}, "args": {{"name": "thread {}"}}}})", separator, buffer->thread, buffer->thread);
+                separator = ",\n";
+
+                // Oldest first, which is where the next event would overwrite once the ring is full
+                auto const oldest{buffer->recorded > buffer->events.size() ? buffer->recorded % buffer->events.size() : 0U};
+
+                for (std::size_t index{0}; index < buffer->events.size(); ++index)
+                {
+                    auto const & event{buffer->events[(oldest + index) % buffer->events.size()]};
+
+                    file << std::format(
+                        R"({}{{"name": "{}", "ph": "X", "pid": 1, "tid": {}, "ts": {:.3f}, "dur": {:.3f}}})", separator, event.name, buffer->thread, event.startNanoseconds / 1000.0,
+                        event.durationNanoseconds / 1000.0
+                    );
+                }
+            }
+
+            file << "\n]}\n";
+        }
+
+        [[nodiscard]] auto Now() const -> std::int64_t
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+        }
+
+        static constexpr std::size_t INITIAL_CAPACITY{4096};
+        // 1.5 MB per thread
+        static constexpr std::size_t MAX_EVENTS{65536};
+
+    private:
+
+        std::chrono::steady_clock::time_point const epoch{std::chrono::steady_clock::now()};
+
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+
+    auto GetRegistry() -> TraceRegistry &
+    {
+        static TraceRegistry registry;
+
+        return registry;
+    }
+
+    // Each thread registers once and afterwards appends only to its own buffer, so recording never takes a lock
+    auto GetThreadBuffer() -> ThreadBuffer &
+    {
+        thread_local ThreadBuffer * const buffer{GetRegistry().Register()};
+
+        return *buffer;
+    }
+}
+
+
+TraceScope::TraceScope(char const * const name) : name{name}, start{GetRegistry().Now()} { }
+
+TraceScope::~TraceScope()
+{
+    auto const end{GetRegistry().Now()};
+
+    auto & buffer{GetThreadBuffer()};
+
+    if (buffer.events.size() < TraceRegistry::MAX_EVENTS)
+    {
+        buffer.events.push_back({name, start, end - start});
+    }
+    else
+    {
+        buffer.events[buffer.recorded % TraceRegistry::MAX_EVENTS] = {name, start, end - start};
+    }
+
+    ++buffer.recorded;
+}
@@ -0,0 +1,170 @@
+#include "Tuning.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <numbers>
+#include <sstream>
+#include <stdexcept>
+
+#include "LaneKernels.hpp"
+
+
+namespace
+{
+    // A configuration tuned for one workload is only reused for another one of roughly the same size and depth
+    constexpr double MAX_LOG_DISTANCE{2.0 * std::numbers::ln2};
+
+    auto FormatEntry(TuningEntry const & entry) -> std::string
+    {
+        auto const & [key, config, milliseconds]{entry};
+
+        return std::format(
+            "{} {} {} {} {} {} {} {} {} {} {} {:.3f}", key.fractal, key.imageSize.width, key.imageSize.height, key.maxIterations, GetPixelLayoutName(key.layout), key.concurrency,
+            config.grainSize.width, config.grainSize.height, GetPartitioningName(config.partitioning), config.simdWidth, config.threads, milliseconds
+        );
+    }
+
+    auto ParseEntry(std::string const & line) -> std::optional<TuningEntry>
+    {
+        std::istringstream stream{line};
+
+        TuningEntry entry{};
+        std::string layout;
+        std::string partitioning;
+
+        stream >> entry.key.fractal >> entry.key.imageSize.width >> entry.key.imageSize.height >> entry.key.maxIterations >> layout >> entry.key.concurrency;
+        stream >> entry.config.grainSize.width >> entry.config.grainSize.height >> partitioning >> entry.config.simdWidth >> entry.config.threads >> entry.milliseconds;
+
+        auto const isValid{
+            stream && std::ranges::find(SIMD_WIDTHS, entry.config.simdWidth) != SIMD_WIDTHS.end() && entry.config.grainSize.width > 0U &&
+            entry.config.grainSize.height > 0U && entry.config.threads >= 0
+        };
+
+        if (!isValid)
+        {
+            return std::nullopt;
+        }
+
+        // Names written by another version of the program are skipped like any other malformed line, since every render reads the cache
+        try
+        {
+            entry.key.layout = ParsePixelLayout(layout);
+            entry.config.partitioning = ParsePartitioning(partitioning);
+        }
+        catch (std::invalid_argument const &)
+        {
+            return std::nullopt;
+        }
+
+        return entry;
+    }
+
+    auto IsSameKey(TuningKey const & first, TuningKey const & second) -> bool
+    {
+        return first.fractal == second.fractal && first.imageSize.width == second.imageSize.width && first.imageSize.height == second.imageSize.height &&
+            first.maxIterations == second.maxIterations && first.layout == second.layout && first.concurrency == second.concurrency;
+    }
+
+    auto LogRatio(double const first, double const second) -> double
+    {
+        return std::abs(std::log(first / second));
+    }
+}
+
+
+auto GetTuningCachePath() -> std::filesystem::path
+{
+    auto const * const path{std::getenv("FRACTAL_TUNING_CACHE")};
+
+    return path != nullptr ? path : "fractal-tuning.cache";
+}
+
+auto LoadTuningCache(std::filesystem::path const & path) -> std::vector<TuningEntry>
+{
+    std::vector<TuningEntry> entries;
+    std::ifstream file{path};
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line.starts_with('#'))
+        {
+            continue;
+        }
+
+        if (auto entry{ParseEntry(line)})
+        {
+            entries.push_back(std::move(*entry));
+        }
+    }
+
+    return entries;
+}
+
+auto SaveTuningEntry(std::filesystem::path const & path, TuningEntry const & entry) -> void
+{
+    auto entries{LoadTuningCache(path)};
+    std::erase_if(entries, [&entry](TuningEntry const & existing) { return IsSameKey(existing.key, entry.key); });
+    entries.push_back(entry);
+
+    std::ofstream file{path};
+
+    if (!file)
+    {
+        throw std::runtime_error(std::format("Could not open {} for writing.", path.string()));
+    }
+
+    file << "# fractal width height max_iterations layout concurrency grain_width grain_height partitioning simd_width threads milliseconds\n";
+
+    for (auto const & existing : entries)
+    {
+        file << FormatEntry(existing) << '\n';
+    }
+}
+
+auto FindTuning(std::vector<TuningEntry> const & entries, TuningKey const & key) -> std::optional<TuningConfig>
+{
+    std::optional<TuningConfig> best;
+    auto bestDistance{std::numeric_limits<double>::infinity()};
+
+    for (auto const & entry : entries)
+    {
+        if (entry.key.fractal != key.fractal || entry.key.layout != key.layout || entry.key.concurrency != key.concurrency)
+        {
+            continue;
+        }
+
+        auto const pixelDistance{LogRatio(
+            static_cast<double>(entry.key.imageSize.width * entry.key.imageSize.height), static_cast<double>(key.imageSize.width * key.imageSize.height)
+        )};
+        auto const iterationDistance{LogRatio(static_cast<double>(entry.key.maxIterations), static_cast<double>(key.maxIterations))};
+
+        if (pixelDistance > MAX_LOG_DISTANCE || iterationDistance > MAX_LOG_DISTANCE || pixelDistance + iterationDistance >= bestDistance)
+        {
+            continue;
+        }
+
+        bestDistance = pixelDistance + iterationDistance;
+        best = entry.config;
+
+        // Grain sizes are stored for the tuned image and are rescaled to the requested one
+        best->grainSize = {
+            std::max(1UZ, entry.config.grainSize.width * key.imageSize.width / entry.key.imageSize.width),
+            std::max(1UZ, entry.config.grainSize.height * key.imageSize.height / entry.key.imageSize.height),
+        };
+    }
+
+    return best;
+}
+
+auto LookupTuning(TuningKey const & key) -> std::optional<TuningConfig>
+{
+    // The cache is read once per process, since many short-lived generators may ask for it
+    static auto const ENTRIES{LoadTuningCache(GetTuningCachePath())};
+
+    return FindTuning(ENTRIES, key);
+}
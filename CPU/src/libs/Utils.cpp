@@ -1,19 +1,100 @@
 #include "Utils.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <format>
 #include <print>
+#include <ranges>
+#include <stdexcept>
+#include <string>
 
 
-auto CheckParameters(int const argc, char const * const argv[]) -> void
+auto CheckParameters(int const argc, char const * const argv[], std::span<std::string_view const> const options, std::string_view const usage, std::size_t const argumentsCount) -> void
 {
-    if (argc != ARGS_COUNT)
+    auto const positionals{static_cast<int>(argumentsCount)};
+    auto const isInvalidOption{
+        [options](std::string_view const argument) -> bool
+        {
+            if (!argument.starts_with("--"))
+            {
+                return true;
+            }
+
+            auto const name{argument.substr(2U, argument.find('=') - 2U)};
+
+            return std::ranges::find(options, name) == options.end();
+        }
+    };
+
+    auto const invalidOption{std::ranges::find_if(argv + std::min(argc, positionals), argv + argc, isInvalidOption)};
+
+    if (argc < positionals || invalidOption != argv + argc)
     {
-        std::println(stderr, "Usage: {} <width> <height> <max_iterations>", argv[PARAM_NAME]);
+        if (invalidOption != argv + argc)
+        {
+            std::println(stderr, "Unknown argument {}.", *invalidOption);
+        }
+
+        std::println(stderr, "Usage: {} {}", argv[PARAM_NAME], usage);
 
         std::exit(EXIT_FAILURE);
     }
 }
 
+auto GetOption(int const argc, char const * const argv[], std::string_view const name, std::string_view const fallback) -> std::string_view
+{
+    for (auto index{1}; index < argc; ++index)
+    {
+        std::string_view argument{argv[index]};
+
+        if (!argument.starts_with("--"))
+        {
+            continue;
+        }
+
+        argument.remove_prefix(2U);
+
+        if (argument.starts_with(name) && argument.substr(name.size()).starts_with('='))
+        {
+            return argument.substr(name.size() + 1U);
+        }
+    }
+
+    return fallback;
+}
+
+auto HasFlag(int const argc, char const * const argv[], std::string_view const name) -> bool
+{
+    return std::ranges::any_of(argv + 1, argv + argc, [name](std::string_view const argument) { return argument.starts_with("--") && argument.substr(2U) == name; });
+}
+
+auto SplitList(std::string_view const list, char const separator) -> std::vector<std::string_view>
+{
+    std::vector<std::string_view> items;
+
+    for (auto const item : std::views::split(list, separator))
+    {
+        if (!item.empty())
+        {
+            items.emplace_back(item.begin(), item.end());
+        }
+    }
+
+    return items;
+}
+
+auto ParseSize(std::string_view const size) -> Size
+{
+    auto const separator{size.find('x')};
+
+    if (separator == std::string_view::npos)
+    {
+        throw std::invalid_argument(std::format("The size {} is not in the <width>x<height> format.", size));
+    }
+
+    return {std::stoul(std::string{size.substr(0U, separator)}), std::stoul(std::string{size.substr(separator + 1U)})};
+}
+
 auto GetGrainSize(Size const & imageSize, int const numberOfThreads) -> Size
 {
     auto const grainsizeRow = std::max(1UZ, imageSize.height / numberOfThreads);
@@ -26,12 +107,12 @@ auto TestSpeed(std::function<void()> const & function, std::string_view const me
 {
     using namespace std::chrono;
 
-    auto const start = high_resolution_clock::now();
+    auto const start = steady_clock::now();
     function();
-    auto const stop = high_resolution_clock::now();
+    auto const stop = steady_clock::now();
 
-    auto const differenceMs = duration_cast<milliseconds>(stop - start);
+    auto const differenceMs = duration<double, std::milli>(stop - start);
     auto const timeMs = differenceMs.count();
 
-    std::println("Time taken for {} : {} ms", message, timeMs);
+    std::println("Time taken for {} : {:.3f} ms", message, timeMs);
 }
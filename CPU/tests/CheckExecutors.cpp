@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <print>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Executor.hpp"
+
+
+namespace
+{
+    constexpr std::size_t OUTER_COUNT{64};
+    constexpr std::size_t INNER_COUNT{100};
+    constexpr std::size_t FAILING_INDEX{OUTER_COUNT / 2U};
+
+    // Every index of a nested loop over the same executor has to run exactly once
+    auto CheckNestedLoops(Executor & executor) -> bool
+    {
+        std::vector<std::atomic<int>> visits(OUTER_COUNT * INNER_COUNT);
+
+        executor.ParallelFor(
+            OUTER_COUNT, 4U, [&](std::size_t const outerBegin, std::size_t const outerEnd) -> void
+            {
+                for (auto outer{outerBegin}; outer < outerEnd; ++outer)
+                {
+                    executor.ParallelFor(
+                        INNER_COUNT, 7U, [&visits, outer](std::size_t const innerBegin, std::size_t const innerEnd) -> void
+                        {
+                            for (auto inner{innerBegin}; inner < innerEnd; ++inner)
+                            {
+                                visits[outer * INNER_COUNT + inner].fetch_add(1, std::memory_order_relaxed);
+                            }
+                        }
+                    );
+                }
+            }
+        );
+
+        return std::ranges::all_of(visits, [](auto const & count) { return count.load() == 1; });
+    }
+
+    // A chunk that throws, directly or from a nested loop, fails the whole loop and leaves the executor usable
+    auto CheckThrowingChunk(Executor & executor, bool const isNested) -> bool
+    {
+        auto const throwAt{
+            [](std::size_t const begin, std::size_t const end) -> void
+            {
+                if (begin <= FAILING_INDEX && FAILING_INDEX < end)
+                {
+                    throw std::runtime_error("Failing chunk");
+                }
+            }
+        };
+
+        try
+        {
+            executor.ParallelFor(
+                OUTER_COUNT, 4U, [&](std::size_t const begin, std::size_t const end) -> void
+                {
+                    if (isNested)
+                    {
+                        executor.ParallelFor(OUTER_COUNT, 4U, [&](std::size_t const, std::size_t const) -> void { throwAt(begin, end); });
+                    }
+                    else
+                    {
+                        throwAt(begin, end);
+                    }
+                }
+            );
+
+            return false;
+        }
+        catch (std::runtime_error const &)
+        {
+        }
+
+        std::atomic<std::size_t> covered{0};
+        executor.ParallelFor(OUTER_COUNT, 4U, [&covered](std::size_t const begin, std::size_t const end) -> void { covered += end - begin; });
+
+        return covered == OUTER_COUNT;
+    }
+}
+
+
+auto main() -> int
+{
+    auto isPassing{true};
+
+    for (auto const type : {ExecutorType::TBB, ExecutorType::OPENMP_DYNAMIC, ExecutorType::OPENMP_GUIDED, ExecutorType::STD_PARALLEL, ExecutorType::THREAD_POOL})
+    {
+        if (!IsExecutorAvailable(type))
+        {
+            std::println("SKIP: {} is not available in this build", GetExecutorName(type));
+            continue;
+        }
+
+        for (auto const threads : {1, 4})
+        {
+            auto const executor{MakeExecutor(type, threads)};
+
+            for (auto const & [name, isPassed] : {
+                     std::pair{"nested loops", CheckNestedLoops(*executor)},
+                     std::pair{"throwing chunk", CheckThrowingChunk(*executor, false)},
+                     std::pair{"throwing nested chunk", CheckThrowingChunk(*executor, true)},
+                 })
+            {
+                std::println("{}: {} with the {} executor on {} threads", isPassed ? "PASS" : "FAIL", name, GetExecutorName(type), threads);
+                isPassing = isPassing && isPassed;
+            }
+        }
+    }
+
+    return isPassing ? EXIT_SUCCESS : EXIT_FAILURE;
+}